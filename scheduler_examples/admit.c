@@ -0,0 +1,81 @@
+#include "admit.h"
+
+#include <string.h>
+
+static _Thread_local admit_config_t config;
+static _Thread_local admit_stats_t stats;
+
+void admit_init(const admit_config_t *cfg) {
+    config = *cfg;
+    memset(&stats, 0, sizeof(stats));
+}
+
+int admit_enabled(void) {
+    return config.max_runnable > 0 || config.client_rate > 0;
+}
+
+// Arredonda uma espera para cima, em ticks inteiros (pelo menos um)
+static uint32_t round_to_ticks(uint64_t wait_us) {
+    uint64_t tick_us = TICKS_MS * 1000u;
+    uint64_t ticks = (wait_us + tick_us - 1) / tick_us;
+    if (ticks == 0) ticks = 1;
+    return (uint32_t)(ticks * TICKS_MS);
+}
+
+uint32_t admit_request(admit_bucket_t *bucket, process_request_t request, uint32_t runnable, uint32_t now_ms) {
+    if (!admit_enabled()) return 0;
+
+    // Limite de prontos: só os RUN acrescentam trabalho à ready queue
+    int over_limit = 0;
+    if (request == PROCESS_REQUEST_RUN) {
+        if (runnable > stats.peak_runnable) stats.peak_runnable = runnable;
+        over_limit = config.max_runnable > 0 && runnable >= config.max_runnable;
+    }
+    uint64_t wait_us = over_limit ? (uint64_t)config.retry_ms * 1000u : 0;
+
+    // Token bucket (GCRA): cada pedido adianta tat_us um intervalo; o
+    // pedido é aceite enquanto tat_us não passar de now mais os
+    // client_burst - 1 intervalos que o balde deixa antecipar
+    if (config.client_rate > 0) {
+        uint64_t now_us = (uint64_t)now_ms * 1000u;
+        uint64_t interval_us = 1000000u / config.client_rate;
+        uint64_t tolerance_us = (uint64_t)(config.client_burst - 1) * interval_us;
+        uint64_t tat_us = bucket->tat_us > now_us ? bucket->tat_us : now_us;
+        if (tat_us - now_us > tolerance_us) {
+            if (over_limit) stats.rejected_runnable++;
+            else stats.rejected_rate++;
+            // Antes disto o balde voltaria a recusar
+            if (tat_us - now_us - tolerance_us > wait_us) wait_us = tat_us - now_us - tolerance_us;
+            return round_to_ticks(wait_us);
+        }
+        if (!over_limit) bucket->tat_us = tat_us + interval_us;
+    }
+
+    if (over_limit) {
+        stats.rejected_runnable++;
+        return round_to_ticks(wait_us);
+    }
+    stats.admitted++;
+    return 0;
+}
+
+const admit_stats_t *admit_get_stats(void) {
+    return &stats;
+}
+
+void admit_print_stats(FILE *out) {
+    if (!admit_enabled()) return;
+    fprintf(out, "Admission control (");
+    if (config.max_runnable > 0) fprintf(out, "at most %u runnable", config.max_runnable);
+    if (config.max_runnable > 0 && config.client_rate > 0) fprintf(out, ", ");
+    if (config.client_rate > 0) {
+        fprintf(out, "%u requests/s per client, burst %u", config.client_rate, config.client_burst);
+    }
+    uint64_t rejected = stats.rejected_runnable + stats.rejected_rate;
+    uint64_t total = stats.admitted + rejected;
+    fprintf(out, "): %llu admitted, %llu rejected (%llu runnable limit, %llu client rate), "
+                 "%.2f%% of requests, peak %u runnable\n",
+            (unsigned long long)stats.admitted, (unsigned long long)rejected,
+            (unsigned long long)stats.rejected_runnable, (unsigned long long)stats.rejected_rate,
+            total ? 100.0 * (double)rejected / (double)total : 0.0, stats.peak_runnable);
+}
@@ -0,0 +1,76 @@
+#ifndef ADMIT_H
+#define ADMIT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "msg.h"
+
+/*
+ * Controlo de admissão. Sem ele o scheduler aceita todos os pedidos e, com
+ * mais carga do que CPU, a ready queue e a latência crescem sem limite.
+ *
+ * Há dois limites, ambos opcionais:
+ *  - max_runnable: um RUN só é aceite se houver menos de max_runnable
+ *    processos prontos ou no CPU;
+ *  - client_rate/client_burst: cada ligação tem um token bucket de
+ *    client_burst pedidos, reposto a client_rate pedidos por segundo de
+ *    tempo simulado (RUN e BLOCK gastam um token cada).
+ *
+ * Um pedido recusado recebe REJECT em vez de ACK, com o tempo a esperar
+ * antes de o voltar a enviar no time_ms: o que falta para o balde ter um
+ * token, ou retry_ms quando o limite é o de prontos.
+ *
+ * O balde guarda só o instante teórico de chegada do próximo pedido
+ * (GCRA): um balde a zeros está cheio, pelo que as ligações novas, e as
+ * que vêm de um checkpoint ou de um hot upgrade, começam com o balde cheio.
+ *
+ * O estado é _Thread_local, como o dos outros módulos do simulador.
+ */
+
+typedef struct {
+    uint32_t max_runnable;      // 0 = sem limite
+    uint32_t client_rate;       // pedidos por segundo de cada ligação (0 = sem limite)
+    uint32_t client_burst;      // pedidos seguidos que uma ligação pode fazer
+    uint32_t retry_ms;          // espera sugerida quando o limite de prontos é atingido
+} admit_config_t;
+
+typedef struct {
+    uint64_t tat_us;            // instante teórico de chegada do próximo pedido
+} admit_bucket_t;
+
+typedef struct {
+    uint64_t admitted;          // pedidos aceites
+    uint64_t rejected_runnable; // RUN recusados por max_runnable
+    uint64_t rejected_rate;     // pedidos recusados pelo token bucket
+    uint32_t peak_runnable;     // maior número de processos prontos visto num pedido
+} admit_stats_t;
+
+/**
+ * @brief Configura a admissão na thread atual (apaga os contadores)
+ */
+void admit_init(const admit_config_t *cfg);
+
+/**
+ * @brief Indica se algum dos limites está ativo
+ */
+int admit_enabled(void);
+
+/**
+ * @brief Decide se um pedido é aceite
+ *
+ * @param bucket balde da ligação que fez o pedido
+ * @param runnable processos prontos ou no CPU neste momento
+ * @return 0 se o pedido for aceite, ou o tempo a esperar antes de o
+ *         repetir, em ms (múltiplo de TICKS_MS)
+ */
+uint32_t admit_request(admit_bucket_t *bucket, process_request_t request, uint32_t runnable, uint32_t now_ms);
+
+const admit_stats_t *admit_get_stats(void);
+
+/**
+ * @brief Escreve os limites e os pedidos recusados por cada um
+ */
+void admit_print_stats(FILE *out);
+
+#endif // ADMIT_H
@@ -1,9 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/socket.h>
-#include <sys/un.h>
-#include <fcntl.h>
-#include <limits.h>
+#include <string.h>
 #include <unistd.h>
 
 
@@ -11,6 +8,7 @@
 
 #include "msg.h"
 #include "burst_queue.h"
+#include "schedclient.h"
 
 /**
  * Extracts the basename of a file without its extension.
@@ -38,49 +36,18 @@ typedef enum {
     process_terminated
 } process_status_en;
 
-process_status_en handle_process_requests(int sockfd, const pid_t pid, const char *app_name, burst_t *burst, process_request_t request, uint32_t *sim_start_time_ms, uint32_t *sim_clock_ms) {
-    msg_t msg = {
-        .pid = pid,
-        .request = request,
-        .time_ms = (request == PROCESS_REQUEST_RUN)?burst->burst_time_ms:burst->block_time_ms
-    };
-    // Send request
-    if (write(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("write");
-        close(sockfd);
-        return process_error;
-    }
-    DBG("Application %s (PID %d) sent %s request for %u ms",
-           app_name, pid, PROCESS_REQUEST_STRINGS[request], msg.time_ms);
-    // Wait for ACK and the internal simulation time
-    if (read(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("read");
-        close(sockfd);
-        return process_error;
-    }
-    if (msg.request != PROCESS_REQUEST_ACK) {
-        printf("Received invalid request. Expected ACK, received %s\n", PROCESS_REQUEST_STRINGS[msg.request]);
-        return process_error;
-    }
-    *sim_clock_ms = msg.time_ms;
-    if (*sim_start_time_ms == 0) *sim_start_time_ms = *sim_clock_ms; // First burst, set the start time
-    DBG("Received %s from scheduler for application %s (PID %d) at time %u ms\n",
-           PROCESS_REQUEST_STRINGS[msg.request], app_name, pid, *sim_clock_ms);
-
-    // Wait for DONE and the internal simulation time
-    if (read(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("read");
-        close(sockfd);
-        return process_error;
-    }
+process_status_en handle_process_requests(int sockfd, const pid_t pid, uint32_t group, const char *app_name, burst_t *burst, process_request_t request, uint32_t *sim_start_time_ms, uint32_t *sim_clock_ms) {
+    uint32_t time_ms = (request == PROCESS_REQUEST_RUN)?burst->burst_time_ms:burst->block_time_ms;
+    DBG("Application %s (PID %d) sending %s request for %u ms",
+           app_name, pid, PROCESS_REQUEST_STRINGS[request], time_ms);
 
-    if (msg.request != PROCESS_REQUEST_DONE) {
-        printf("Received invalid request. Expected DONE, received %s\n", PROCESS_REQUEST_STRINGS[msg.request]);
+    // Send request, wait for the ACK and for the DONE (internal simulation times)
+    uint32_t ack_ms;
+    if (sc_request(sockfd, pid, group, request, time_ms, &burst->pages, &ack_ms, sim_clock_ms) < 0) {
         return process_error;
     }
-    *sim_clock_ms = msg.time_ms;
-    DBG("Received %s from scheduler for application %s (PID %d) at time %u ms\n",
-           PROCESS_REQUEST_STRINGS[msg.request], app_name, pid, *sim_clock_ms);
+    if (*sim_start_time_ms == 0) *sim_start_time_ms = ack_ms; // First burst, set the start time
+    DBG("Application %s (PID %d): ACK at %u ms, DONE at %u ms", app_name, pid, ack_ms, *sim_clock_ms);
 
     return process_success;
 }
@@ -97,28 +64,31 @@ int main(int argc, char *argv[]) {
     // Parse arguments
     const char *burstfile_name = argv[1];
     char *app_name = get_basename_no_ext(burstfile_name);
+    uint32_t group = msg_group_from_name(burstfile_name);  // A-5.csv and A-6.csv share group "A"
 
-    burst_queue_t bursts = {.head = NULL, .tail = NULL};
-
-    if (read_queue_from_file(&bursts, burstfile_name) <= 0) {
+    // Bursts are read on demand, so large plans start immediately and use constant memory
+    burst_reader_t bursts;
+    if (burst_reader_open(&bursts, burstfile_name) < 0) {
         fprintf(stderr, "Failed to read burst file %s\n", burstfile_name);
         return EXIT_FAILURE;
     }
 
-    // Setup socket for communication
-    int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sockfd < 0) {
-        perror("socket");
+    // The first burst is read before connecting, so an empty or corrupt file is rejected up front
+    burst_t burst;
+    burst_t *active_burst = &burst;
+    int more = burst_reader_next(&bursts, active_burst);
+    if (more <= 0) {
+        fprintf(stderr, "Failed to read burst file %s\n", burstfile_name);
+        burst_reader_close(&bursts);
+        free(app_name);
         return EXIT_FAILURE;
     }
 
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-
-    if (connect(sockfd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        perror("connect");
-        close(sockfd);
+    // Setup socket for communication
+    int sockfd = sc_connect(SOCKET_PATH);
+    if (sockfd < 0) {
+        burst_reader_close(&bursts);
+        free(app_name);
         return EXIT_FAILURE;
     }
 
@@ -129,20 +99,28 @@ int main(int argc, char *argv[]) {
     uint32_t cpu_duration_ms = 0;           // duration of the app (bursts and blocks)
     uint32_t block_duration_ms = 0;         // duration of the app in blocked state
 
-    burst_t *active_burst;
-
-    while ((active_burst = dequeue_burst(&bursts)) != NULL) {
-        if (handle_process_requests(sockfd, pid, app_name, active_burst, PROCESS_REQUEST_RUN, &start_time_ms, &sim_clock_ms) == process_error)
+    for (; more > 0; more = burst_reader_next(&bursts, active_burst)) {
+        if (handle_process_requests(sockfd, pid, group, app_name, active_burst, PROCESS_REQUEST_RUN, &start_time_ms, &sim_clock_ms) == process_error)
             break;
         cpu_duration_ms += active_burst->burst_time_ms;
 
         if (active_burst->block_time_ms > 0) {
-            if (handle_process_requests(sockfd, pid, app_name, active_burst, PROCESS_REQUEST_BLOCK, &start_time_ms, &sim_clock_ms) == process_error)
+            if (handle_process_requests(sockfd, pid, group, app_name, active_burst, PROCESS_REQUEST_BLOCK, &start_time_ms, &sim_clock_ms) == process_error)
                 break;
             block_duration_ms += active_burst->block_time_ms;
         }
     }
 
+    burst_reader_close(&bursts);
+    if (more < 0) {
+        // A truncated or malformed record: the run did not cover the whole file
+        fprintf(stderr, "Application %s (PID %d) stopped at time %u ms: %s is malformed\n",
+                app_name, pid, sim_clock_ms, burstfile_name);
+        close(sockfd);
+        free(app_name);
+        return EXIT_FAILURE;
+    }
+
     // Received EXIT, print stats
     double real = (sim_clock_ms - start_time_ms)/1000.0;
     double user = (double)cpu_duration_ms/1000.0;
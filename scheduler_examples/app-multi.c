@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "debug.h"
+
+#include "msg.h"
+#include "burst_queue.h"
+#include "schedclient.h"
+
+/*
+ * Simula muitas aplicações num único processo, com o event loop da
+ * libschedclient. Cada aplicação virtual segue os bursts de um dos ficheiros
+ * CSV (atribuídos em round robin), tem um pid próprio e pertence ao grupo
+ * do nome do ficheiro (A-5.csv → "A"); as aplicações são repartidas
+ * pelas ligações indicadas.
+ *
+ * Run like: ./app-multi <apps> <connections> <burst-file.csv>...
+ */
+
+typedef struct {
+    burst_t *bursts;
+    uint32_t count;
+    uint32_t group;                 // grupo das aplicações deste ficheiro (msg_group_from_name)
+} workload_t;
+
+typedef struct {
+    const workload_t *work;
+    uint32_t next;                  // índice do burst em curso
+    process_request_t pending;      // pedido à espera de DONE
+    uint32_t start_ms;              // ACK do primeiro pedido
+    uint32_t end_ms;                // DONE do último pedido
+    uint32_t cpu_ms;
+    uint32_t block_ms;
+} vapp_t;
+
+static int parse_count(const char *s, long min, long max, long *out) {
+    char *endptr;
+    long val = strtol(s, &endptr, 10);
+    if (*endptr != '\0' || val < min || val > max) {
+        fprintf(stderr, "Invalid number: %s\n", s);
+        return -1;
+    }
+    *out = val;
+    return 0;
+}
+
+// Lê um ficheiro de bursts para um array
+static int load_workload(const char *path, workload_t *w) {
+    burst_queue_t q = {.head = NULL, .tail = NULL};
+    int n = read_queue_from_file(&q, path);
+    if (n <= 0) {
+        fprintf(stderr, "Failed to read burst file %s\n", path);
+        return -1;
+    }
+
+    w->bursts = malloc((size_t)n * sizeof(burst_t));
+    if (!w->bursts) return -1;
+    w->count = 0;
+    w->group = msg_group_from_name(path);
+    burst_t *b;
+    while ((b = dequeue_burst(&q)) != NULL) {
+        w->bursts[w->count++] = *b;
+        free(b);
+    }
+    return 0;
+}
+
+// Envia o pedido RUN do burst em curso, ou termina a aplicação
+static void next_burst(sc_app_t *app, vapp_t *v) {
+    if (v->next >= v->work->count) {
+        sc_app_finish(app);
+        return;
+    }
+    const burst_t *b = &v->work->bursts[v->next];
+    v->pending = PROCESS_REQUEST_RUN;
+    sc_app_request(app, PROCESS_REQUEST_RUN, b->burst_time_ms, &b->pages);
+}
+
+static void on_reply(sc_app_t *app, const msg_t *reply, void *user) {
+    vapp_t *v = user;
+
+    if (reply->request == PROCESS_REQUEST_ACK) {
+        if (v->start_ms == 0) v->start_ms = reply->time_ms;
+        return;
+    }
+    if (reply->request != PROCESS_REQUEST_DONE) return;
+
+    v->end_ms = reply->time_ms;
+    const burst_t *b = &v->work->bursts[v->next];
+    if (v->pending == PROCESS_REQUEST_RUN) {
+        v->cpu_ms += b->burst_time_ms;
+        if (b->block_time_ms > 0) {
+            v->pending = PROCESS_REQUEST_BLOCK;
+            sc_app_request(app, PROCESS_REQUEST_BLOCK, b->block_time_ms, &b->pages);
+            return;
+        }
+    } else {
+        v->block_ms += b->block_time_ms;
+    }
+    v->next++;
+    next_burst(app, v);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        printf("Usage: %s <apps> <connections> <burst-file.csv>...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    long apps, connections;
+    if (parse_count(argv[1], 1, 1000000, &apps) < 0 || parse_count(argv[2], 1, 1024, &connections) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    int nfiles = argc - 3;
+    workload_t *work = calloc((size_t)nfiles, sizeof(workload_t));
+    vapp_t *vapps = calloc((size_t)apps, sizeof(vapp_t));
+    if (!work || !vapps) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < nfiles; i++) {
+        if (load_workload(argv[3 + i], &work[i]) < 0) return EXIT_FAILURE;
+    }
+
+    sc_loop_t *loop = sc_loop_create(SOCKET_PATH, (uint32_t)connections);
+    if (!loop) return EXIT_FAILURE;
+
+    // pids virtuais: únicos entre instâncias do app-multi e distintos dos pids reais
+    pid_t base = (pid_t)(getpid() % 2000 + 1) * 1000000;
+    for (long i = 0; i < apps; i++) {
+        vapp_t *v = &vapps[i];
+        v->work = &work[i % nfiles];
+        sc_app_t *app = sc_app_add(loop, base + (pid_t)i, on_reply, v);
+        if (!app) {
+            fprintf(stderr, "Failed to add application %ld\n", i);
+            sc_loop_destroy(loop);
+            return EXIT_FAILURE;
+        }
+        sc_app_set_group(app, v->work->group);
+        next_burst(app, v);
+    }
+
+    printf("Running %ld applications over %ld connections\n", apps, connections);
+    int result = sc_loop_run(loop);
+
+    // Estatísticas das aplicações que terminaram
+    uint32_t finished = 0, first_ms = UINT32_MAX, last_ms = 0;
+    double sum_elapsed = 0.0, max_elapsed = 0.0;
+    for (long i = 0; i < apps; i++) {
+        const vapp_t *v = &vapps[i];
+        if (v->next < v->work->count) continue;
+        double elapsed = (v->end_ms - v->start_ms) / 1000.0;
+        DBG("Application %ld (PID %d) finished at time %u ms, Elapsed: %.03f seconds, CPU: %.03f seconds, BLOCKED: %.03f seconds",
+            i, (int)(base + (pid_t)i), v->end_ms, elapsed, v->cpu_ms / 1000.0, v->block_ms / 1000.0);
+        finished++;
+        sum_elapsed += elapsed;
+        if (elapsed > max_elapsed) max_elapsed = elapsed;
+        if (v->start_ms < first_ms) first_ms = v->start_ms;
+        if (v->end_ms > last_ms) last_ms = v->end_ms;
+    }
+    if (finished > 0) {
+        printf("%u/%ld applications finished between %u and %u ms, Elapsed: mean %.03f seconds, max %.03f seconds\n",
+               finished, apps, first_ms, last_ms, sum_elapsed / finished, max_elapsed);
+    } else {
+        printf("No application finished\n");
+    }
+    if (sc_loop_rejections(loop) > 0) {
+        printf("%llu requests rejected by the scheduler and retried\n",
+               (unsigned long long)sc_loop_rejections(loop));
+    }
+
+    sc_loop_destroy(loop);
+    for (int i = 0; i < nfiles; i++) free(work[i].bursts);
+    free(work);
+    free(vapps);
+    return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,8 +1,5 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/socket.h>
-#include <sys/un.h>
-#include <fcntl.h>
 #include <limits.h>
 #include <unistd.h>
 #include <sys/errno.h>
@@ -10,6 +7,7 @@
 #include "debug.h"
 
 #include "msg.h"
+#include "schedclient.h"
 
 /*
  * Run like: ./app <name> <time_s>
@@ -40,71 +38,28 @@ int main(int argc, char *argv[]) {
     int32_t time_s = (int32_t) val;
 
     // Setup socket for communication
-    int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (sockfd < 0) {
-        perror("socket");
-        return EXIT_FAILURE;
-    }
-
-    struct sockaddr_un addr = {0};
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
-
-    if (connect(sockfd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        perror("connect");
-        close(sockfd);
-        return EXIT_FAILURE;
-    }
+    int sockfd = sc_connect(SOCKET_PATH);
+    if (sockfd < 0) return EXIT_FAILURE;
 
     // All in place to start simulating the app
     printf("Application %s started, will need the CPU for %d seconds\n", app_name, time_s);
 
-    // Send RUN request
+    // Send RUN request, wait for the ACK (start time) and for the DONE (end time)
     pid_t pid = getpid();
-    msg_t msg = {
-        .pid = pid,
-        .request = PROCESS_REQUEST_RUN,
-        .time_ms = time_s * 1000
-    };
-    if (write(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("write");
-        close(sockfd);
-        return EXIT_FAILURE;
-    }
-    DBG("Application %s (PID %d) sent RUN request for %d ms",
-           app_name, pid, msg.time_ms);
-    // Wait for ACK and the internal simulation time
-    if (read(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("read");
+    uint32_t start_time_ms, end_time_ms;
+    DBG("Application %s (PID %d) sending RUN request for %d ms", app_name, pid, time_s * 1000);
+    if (sc_request(sockfd, pid, msg_group_from_name(app_name), PROCESS_REQUEST_RUN, (uint32_t)time_s * 1000, NULL,
+                   &start_time_ms, &end_time_ms) < 0) {
         close(sockfd);
         return EXIT_FAILURE;
     }
-    if (msg.request != PROCESS_REQUEST_ACK) {
-        printf("Received invalid request. Expected ACK\n");
-        return EXIT_FAILURE;
-    }
-
-    // Received ACK
-    uint32_t start_time_ms = msg.time_ms;
-//    printf("Application %s (PID %d) started running at time %d ms\n", app_name, pid, start_time_ms);
-
-    // Wait for the EXIT message
-    if (read(sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-        perror("read");
-        close(sockfd);
-        return EXIT_FAILURE;
-    }
-    if (msg.request != PROCESS_REQUEST_DONE) {
-        printf("Received invalid request. Expected EXIT\n");
-    }
 
     // Received EXIT, print stats
-    double real = (msg.time_ms - start_time_ms)/1000.0;
+    double real = (end_time_ms - start_time_ms)/1000.0;
     double user = (double)time_s;
-    double sys = real - time_s;
 
     printf("Application %s (PID %d) finished at time %d ms, Elapsed: %.03f seconds, CPU: %.03f seconds\n",
-           app_name, pid, msg.time_ms, real, user);
+           app_name, pid, end_time_ms, real, user);
 
     close(sockfd);
     return EXIT_SUCCESS;
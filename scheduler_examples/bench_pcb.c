@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include "queue.h"
+#include "hist.h"
+
+/*
+ * Benchmark da disposição dos PCBs: a escolha do SJF (percorrer a ready
+ * queue à procura do menor time_ms) sobre uma fila com muitos processos,
+ * com os PCBs antigos (pcb_t com tudo lá dentro, alocado com malloc, e um
+ * queue_elem_t alocado à parte) e com os atuais (parte quente numa linha
+ * de cache com o elemento da fila, vinda do pool; parte fria à parte).
+ *
+ * Cada escolha tira o processo mais curto e acrescenta um novo, como no
+ * bench_readyset, para que a ordem da fila deixe de ser a da alocação.
+ * Quando o kernel o permite (perf_event_paranoid <= 2 e um PMU visível),
+ * são lidos os misses de L1D e do último nível de cache.
+ *
+ * Run like: ./bench_pcb [tasks] [picks]
+ */
+
+// O pcb_t antes da separação quente/fria (mesmos campos, mesma ordem)
+typedef struct legacy_pcb_st {
+    int32_t pid;
+    task_status_en status;
+    uint32_t time_ms;
+    uint32_t ellapsed_time_ms;
+    uint32_t slice_start_ms;
+    uint32_t sockfd;
+    uint32_t last_update_time_ms;
+    uint8_t priority_level;
+    page_info_t pages;
+} legacy_pcb_t;
+
+typedef struct legacy_elem_st {
+    legacy_pcb_t *pcb;
+    struct legacy_elem_st *next;
+} legacy_elem_t;
+
+typedef struct {
+    legacy_elem_t *head;
+    legacy_elem_t *tail;
+} legacy_queue_t;
+
+enum { CNT_L1D, CNT_LLC, CNT_COUNT };
+
+static int counters[CNT_COUNT];     // fds dos contadores (-1 se indisponível)
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void counters_open(void) {
+    uint64_t read_miss = ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    counters[CNT_L1D] = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | read_miss);
+    counters[CNT_LLC] = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_miss);
+}
+
+static void counters_start(void) {
+    for (int i = 0; i < CNT_COUNT; i++) {
+        if (counters[i] < 0) continue;
+        ioctl(counters[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+// Misses desde counters_start, ou -1 se o contador não existir
+static void counters_stop(int64_t out[CNT_COUNT]) {
+    for (int i = 0; i < CNT_COUNT; i++) {
+        uint64_t v;
+        out[i] = -1;
+        if (counters[i] < 0) continue;
+        ioctl(counters[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counters[i], &v, sizeof(v)) == (ssize_t)sizeof(v)) out[i] = (int64_t)v;
+    }
+}
+
+static uint64_t rng_state;
+
+static uint32_t next_time_ms(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state % 5000) + 10;
+}
+
+// --- PCBs antigos ---
+
+static legacy_pcb_t *legacy_new(int32_t pid) {
+    legacy_pcb_t *p = malloc(sizeof(legacy_pcb_t));
+    if (!p) exit(EXIT_FAILURE);
+    memset(p, 0, sizeof(*p));
+    p->pid = pid;
+    p->time_ms = next_time_ms();
+    return p;
+}
+
+static void legacy_enqueue(legacy_queue_t *q, legacy_pcb_t *p) {
+    legacy_elem_t *e = malloc(sizeof(legacy_elem_t));
+    if (!e) exit(EXIT_FAILURE);
+    e->pcb = p;
+    e->next = NULL;
+    if (q->tail) {
+        q->tail->next = e;
+    } else {
+        q->head = e;
+    }
+    q->tail = e;
+}
+
+static legacy_pcb_t *legacy_pop_min(legacy_queue_t *q) {
+    legacy_elem_t *min = q->head, *min_prev = NULL, *prev = NULL;
+    for (legacy_elem_t *it = q->head; it; prev = it, it = it->next) {
+        if (it->pcb->time_ms < min->pcb->time_ms) {
+            min = it;
+            min_prev = prev;
+        }
+    }
+    if (min_prev) {
+        min_prev->next = min->next;
+    } else {
+        q->head = min->next;
+    }
+    if (q->tail == min) q->tail = min_prev;
+    legacy_pcb_t *p = min->pcb;
+    free(min);
+    return p;
+}
+
+static uint64_t bench_legacy(uint32_t n, uint32_t picks, int64_t misses[CNT_COUNT], double *ns) {
+    rng_state = 0x9e3779b97f4a7c15ull;
+    legacy_queue_t q = {NULL, NULL};
+    int32_t pid = 0;
+    for (uint32_t i = 0; i < n; i++) legacy_enqueue(&q, legacy_new(pid++));
+
+    uint64_t sum = 0;
+    counters_start();
+    uint64_t t0 = clock_now_ticks();
+    for (uint32_t i = 0; i < picks; i++) {
+        legacy_pcb_t *p = legacy_pop_min(&q);
+        sum = sum * 31 + (uint64_t)p->pid;
+        free(p);
+        legacy_enqueue(&q, legacy_new(pid++));
+    }
+    uint64_t t1 = clock_now_ticks();
+    counters_stop(misses);
+
+    while (q.head) {
+        legacy_elem_t *e = q.head;
+        q.head = e->next;
+        free(e->pcb);
+        free(e);
+    }
+    *ns = (double)clock_ticks_to_ns(t1 - t0);
+    return sum;
+}
+
+// --- PCBs atuais (o mesmo percurso do sjf_scheduler) ---
+
+static pcb_t *pooled_new(int32_t pid) {
+    pcb_t *p = new_pcb(pid, 0, next_time_ms());
+    if (!p) exit(EXIT_FAILURE);
+    return p;
+}
+
+static pcb_t *pooled_pop_min(queue_t *q) {
+    queue_elem_t *min_elem = q->head;
+    for (queue_elem_t *it = q->head; it; it = it->next) {
+        if (it->pcb->time_ms < min_elem->pcb->time_ms) min_elem = it;
+    }
+    return remove_queue_elem(q, min_elem)->pcb;
+}
+
+static uint64_t bench_pooled(uint32_t n, uint32_t picks, int64_t misses[CNT_COUNT], double *ns) {
+    rng_state = 0x9e3779b97f4a7c15ull;
+    queue_t q = {.head = NULL, .tail = NULL};
+    int32_t pid = 0;
+    for (uint32_t i = 0; i < n; i++) enqueue_pcb(&q, pooled_new(pid++));
+
+    uint64_t sum = 0;
+    counters_start();
+    uint64_t t0 = clock_now_ticks();
+    for (uint32_t i = 0; i < picks; i++) {
+        pcb_t *p = pooled_pop_min(&q);
+        sum = sum * 31 + (uint64_t)p->pid;
+        free_pcb(p);
+        enqueue_pcb(&q, pooled_new(pid++));
+    }
+    uint64_t t1 = clock_now_ticks();
+    counters_stop(misses);
+
+    while (q.head) free_pcb(dequeue_pcb(&q));
+    *ns = (double)clock_ticks_to_ns(t1 - t0);
+    return sum;
+}
+
+static void print_row(const char *name, size_t bytes, uint64_t candidates, double ns, const int64_t misses[CNT_COUNT]) {
+    printf("%-8s %8zu %14.2f", name, bytes, ns / (double)candidates);
+    for (int i = 0; i < CNT_COUNT; i++) {
+        if (misses[i] < 0) {
+            printf(" %14s", "n/a");
+        } else {
+            printf(" %14.3f", (double)misses[i] / (double)candidates);
+        }
+    }
+    printf("\n");
+}
+
+static int parse_arg(const char *s, uint32_t *out) {
+    char *endptr;
+    unsigned long v = strtoul(s, &endptr, 10);
+    if (*endptr != '\0' || v < 1 || v > (1ul << 24)) return -1;
+    *out = (uint32_t)v;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t n = 100000, picks = 200;
+    if ((argc > 1 && parse_arg(argv[1], &n) < 0) || (argc > 2 && parse_arg(argv[2], &picks) < 0)) {
+        fprintf(stderr, "Usage: %s [tasks] [picks]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    clock_calibrate();
+    counters_open();
+
+    int64_t legacy_misses[CNT_COUNT], pooled_misses[CNT_COUNT];
+    double legacy_ns, pooled_ns;
+    uint64_t legacy_sum = bench_legacy(n, picks, legacy_misses, &legacy_ns);
+    uint64_t pooled_sum = bench_pooled(n, picks, pooled_misses, &pooled_ns);
+
+    uint64_t candidates = (uint64_t)n * picks;
+    printf("SJF pick over %u ready tasks, %u picks (per candidate visited, clock: %s)\n",
+           n, picks, clock_source_name());
+    printf("%-8s %8s %14s %14s %14s\n", "layout", "bytes", "ns", "L1D misses", "LLC misses");
+    print_row("legacy", sizeof(legacy_pcb_t) + sizeof(legacy_elem_t), candidates, legacy_ns, legacy_misses);
+    print_row("hot/cold", sizeof(pcb_t), candidates, pooled_ns, pooled_misses);
+    if (counters[CNT_L1D] < 0) {
+        printf("(cache counters unavailable: no PMU or perf_event_paranoid too high)\n");
+    }
+
+    if (legacy_sum != pooled_sum) {
+        fprintf(stderr, "The two layouts picked different tasks\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "queue.h"
+#include "readyset.h"
+#include "hist.h"
+
+/*
+ * Benchmark da escolha do SJF: procura do menor time_ms na ready queue
+ * (lista ligada, como o sjf_scheduler) contra o conjunto de prontos em SoA
+ * (readyset.h) com cada min-scan suportado pelo CPU.
+ *
+ * Cada operação tira o processo mais curto e acrescenta um novo, pelo que
+ * o número de prontos fica constante. Todas as variantes recebem a mesma
+ * sequência de tempos e têm de escolher os mesmos processos pela mesma
+ * ordem (a soma de verificação é comparada com a da lista).
+ *
+ * Run like: ./bench_readyset [max-ready]
+ */
+
+#define WORK_PER_SIZE 20000000ull  // ~ candidatos visitados por tamanho
+
+static uint64_t rng_state;
+
+static uint32_t next_time_ms(void) {
+    // xorshift64: basta para gerar chaves, e é igual em todas as variantes
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state % 5000) + 10;
+}
+
+static pcb_t *make_pcb(int32_t pid) {
+    pcb_t *p = new_pcb(pid, 0, next_time_ms());
+    if (!p) {
+        perror("new_pcb");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// A escolha do sjf_scheduler: percorre a lista e remove o primeiro mínimo
+static pcb_t *list_pop_min(queue_t *q) {
+    queue_elem_t *min_elem = q->head;
+    for (queue_elem_t *it = q->head; it; it = it->next) {
+        if (it->pcb->time_ms < min_elem->pcb->time_ms) min_elem = it;
+    }
+    queue_elem_t *removed = remove_queue_elem(q, min_elem);
+    return removed->pcb;
+}
+
+static double bench_list(uint32_t n, uint64_t ops, uint64_t *checksum) {
+    rng_state = 0x9e3779b97f4a7c15ull;
+    queue_t q = {.head = NULL, .tail = NULL};
+    int32_t pid = 0;
+    for (uint32_t i = 0; i < n; i++) enqueue_pcb(&q, make_pcb(pid++));
+
+    uint64_t sum = 0;
+    uint64_t t0 = clock_now_ticks();
+    for (uint64_t i = 0; i < ops; i++) {
+        pcb_t *p = list_pop_min(&q);
+        sum = sum * 31 + (uint64_t)p->pid;
+        free_pcb(p);
+        enqueue_pcb(&q, make_pcb(pid++));
+    }
+    uint64_t t1 = clock_now_ticks();
+
+    while (q.head) free_pcb(dequeue_pcb(&q));
+    *checksum = sum;
+    return (double)clock_ticks_to_ns(t1 - t0) / (double)ops;
+}
+
+static double bench_soa(uint32_t n, uint64_t ops, uint64_t *checksum) {
+    rng_state = 0x9e3779b97f4a7c15ull;
+    ready_set_t rs;
+    if (ready_set_init(&rs, n) < 0) {
+        perror("ready_set_init");
+        exit(EXIT_FAILURE);
+    }
+    int32_t pid = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        pcb_t *p = make_pcb(pid++);
+        ready_set_add(&rs, p, p->time_ms);
+    }
+
+    uint64_t sum = 0;
+    uint64_t t0 = clock_now_ticks();
+    for (uint64_t i = 0; i < ops; i++) {
+        pcb_t *p = ready_set_pop_min(&rs);
+        sum = sum * 31 + (uint64_t)p->pid;
+        free_pcb(p);
+        p = make_pcb(pid++);
+        ready_set_add(&rs, p, p->time_ms);
+    }
+    uint64_t t1 = clock_now_ticks();
+
+    ready_set_free(&rs);
+    *checksum = sum;
+    return (double)clock_ticks_to_ns(t1 - t0) / (double)ops;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t max_n = 65536;
+    if (argc > 1) {
+        char *endptr;
+        unsigned long v = strtoul(argv[1], &endptr, 10);
+        if (*endptr != '\0' || v < 1 || v > (1ul << 24)) {
+            fprintf(stderr, "Usage: %s [max-ready]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        max_n = (uint32_t)v;
+    }
+
+    clock_calibrate();
+    ready_set_isa_en best = ready_set_best_isa();
+    printf("ns per pick (pop shortest + enqueue one), clock: %s\n", clock_source_name());
+    printf("%8s %10s", "ready", "list");
+    for (int isa = READY_SET_SCALAR; isa <= (int)best; isa++) {
+        printf(" %10s", ready_set_isa_name((ready_set_isa_en)isa));
+    }
+    printf(" %9s\n", "speedup");
+
+    int mismatch = 0;
+    for (uint32_t n = 16; n <= max_n; n *= 4) {
+        uint64_t ops = WORK_PER_SIZE / n;
+        if (ops < 1000) ops = 1000;
+
+        uint64_t list_sum;
+        double list_ns = bench_list(n, ops, &list_sum);
+        printf("%8u %10.1f", n, list_ns);
+
+        double best_ns = list_ns;
+        for (int isa = READY_SET_SCALAR; isa <= (int)best; isa++) {
+            uint64_t sum;
+            ready_set_use_isa((ready_set_isa_en)isa);
+            double ns = bench_soa(n, ops, &sum);
+            if (sum != list_sum) mismatch = 1;
+            if (ns < best_ns) best_ns = ns;
+            printf(" %10.1f", ns);
+        }
+        printf(" %8.1fx\n", list_ns / best_ns);
+    }
+
+    if (mismatch) {
+        fprintf(stderr, "The ready set picked a different task than the list scan\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdint.h>
 
 #include "burst_queue.h"
@@ -16,6 +17,15 @@ int parse_burst_line(const char* line, burst_t* burst) {
     char* line_copy = strdup(line);
     if (!line_copy) return -1;
 
+    // The pages list is enclosed in brackets and contains commas itself,
+    // so it is split off before tokenizing the other columns
+    char* pages_list = strchr(line_copy, '[');
+    if (pages_list) {
+        *pages_list++ = '\0';
+        char* close = strchr(pages_list, ']');
+        if (close) *close = '\0';
+    }
+
     char* endptr;
     char* token = strtok(line_copy, ",");
 
@@ -61,10 +71,8 @@ int parse_burst_line(const char* line, burst_t* burst) {
 
     // Optional: parse pages list
     burst->pages.count = 0;
-    token = strtok(NULL, "[");
-    if (token) token = strtok(NULL, "]");
-    if (token) {
-        char* page_token = strtok(token, ",");
+    if (pages_list) {
+        char* page_token = strtok(pages_list, ", ");
         while (page_token &&  burst->pages.count< MAX_PAGES) {
             long page = strtol(page_token, &endptr, 10);
             if (*endptr != '\0' || page < 0 || page > INT_MAX) {
@@ -73,7 +81,7 @@ int parse_burst_line(const char* line, burst_t* burst) {
                 return -1;
             }
             burst->pages.ids[burst->pages.count++] = (int)page;
-            page_token = strtok(NULL, ",");
+            page_token = strtok(NULL, ", ");
         }
     }
 
@@ -82,39 +90,141 @@ int parse_burst_line(const char* line, burst_t* burst) {
 }
 
 
-int read_queue_from_file(burst_queue_t* queue, const char* filename) {
-    if (!queue || !filename) return -1;
+int write_burst_header(FILE* out) {
+    burst_file_header_t header = {.magic = BURST_FILE_MAGIC, .version = BURST_FILE_VERSION};
+    return fwrite(&header, sizeof(header), 1, out) == 1 ? 0 : -1;
+}
 
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+int write_burst_record(FILE* out, const burst_t* burst) {
+    burst_record_t record = {
+        .burst_time_ms = burst->burst_time_ms,
+        .block_time_ms = burst->block_time_ms,
+        .nice = burst->nice,
+        .page_count = burst->pages.count
+    };
+    if (fwrite(&record, sizeof(record), 1, out) != 1) return -1;
+    if (record.page_count > 0 &&
+        fwrite(burst->pages.ids, sizeof(uint32_t), record.page_count, out) != record.page_count) return -1;
+    return 0;
+}
+
+int read_burst_record(FILE* in, burst_t* burst) {
+    burst_record_t record;
+    size_t n = fread(&record, 1, sizeof(record), in);
+    if (n == 0) return 0;
+    if (n != sizeof(record) || record.page_count > MAX_PAGES) return -1;
+
+    burst->burst_time_ms = record.burst_time_ms;
+    burst->block_time_ms = record.block_time_ms;
+    burst->nice = record.nice;
+    burst->pages.count = record.page_count;
+    if (record.page_count > 0 &&
+        fread(burst->pages.ids, sizeof(uint32_t), record.page_count, in) != record.page_count) return -1;
+    return 1;
+}
+
+int burst_reader_open(burst_reader_t* r, const char* filename) {
+    if (!r || !filename) return -1;
+    memset(r, 0, sizeof(*r));
+
+    r->file = fopen(filename, "r");
+    if (!r->file) {
         perror("fopen");
         return -1;
     }
+    // The file is read once from start to end
+    posix_fadvise(fileno(r->file), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Binary files are recognized by their header, anything else is read as CSV
+    burst_file_header_t header;
+    if (fread(&header, sizeof(header), 1, r->file) == 1 &&
+        header.magic == BURST_FILE_MAGIC && header.version == BURST_FILE_VERSION) {
+        r->binary = 1;
+    } else {
+        rewind(r->file);
+    }
+    return 0;
+}
+
+// Parses up to BURST_READER_AHEAD bursts into the (empty) read-ahead buffer
+static void burst_reader_fill(burst_reader_t* r) {
+    r->head = 0;
+    r->count = 0;
+
+    if (r->binary) {
+        while (r->count < BURST_READER_AHEAD) {
+            int res = read_burst_record(r->file, &r->ahead[r->count]);
+            if (res <= 0) {
+                if (res < 0) {
+                    fprintf(stderr, "Truncated or malformed burst record after %llu bursts\n",
+                            (unsigned long long)(r->read + r->count));
+                    r->error = 1;
+                }
+                r->eof = 1;
+                break;
+            }
+            r->count++;
+        }
+        r->read += r->count;
+        return;
+    }
 
     char line[MAX_LINE_LEN];
-    int success_count = 0;
+    while (r->count < BURST_READER_AHEAD) {
+        if (!fgets(line, sizeof(line), r->file)) {
+            r->eof = 1;
+            break;
+        }
 
-    while (fgets(line, sizeof(line), file)) {
         // Trim leading whitespace
         char* trimmed = line;
         while (isspace(*trimmed)) ++trimmed;
 
         if (*trimmed == '#' || *trimmed == '\0') continue;
 
-        burst_t burst = {0}; // Initialize burst structure
-        if (parse_burst_line(trimmed, &burst) == 0) {
-            if (enqueue_burst(queue, &burst)) {
-                success_count++;
-            } else {
-                fprintf(stderr, "Queue full or allocation failed\n");
-                break;
-            }
+        burst_t* burst = &r->ahead[r->count];
+        memset(burst, 0, sizeof(*burst));
+        if (parse_burst_line(trimmed, burst) == 0) {
+            r->count++;
         } else {
             fprintf(stderr, "Skipping malformed line: %s", line);
         }
     }
+    r->read += r->count;
+}
+
+int burst_reader_next(burst_reader_t* r, burst_t* burst) {
+    if (r->head == r->count) {
+        if (r->eof) return r->error ? -1 : 0;
+        burst_reader_fill(r);
+        if (r->count == 0) return r->error ? -1 : 0;
+    }
+    *burst = r->ahead[r->head++];
+    return 1;
+}
+
+void burst_reader_close(burst_reader_t* r) {
+    if (r->file) fclose(r->file);
+    r->file = NULL;
+}
+
+int read_queue_from_file(burst_queue_t* queue, const char* filename) {
+    if (!queue) return -1;
+
+    burst_reader_t reader;
+    if (burst_reader_open(&reader, filename) < 0) return -1;
+
+    int success_count = 0;
+    burst_t burst;
+    while (burst_reader_next(&reader, &burst) > 0) {
+        if (!enqueue_burst(queue, &burst)) {
+            fprintf(stderr, "Queue full or allocation failed\n");
+            break;
+        }
+        success_count++;
+    }
 
-    fclose(file);
+    burst_reader_close(&reader);
     return success_count;
 }
 
@@ -1,6 +1,8 @@
 #ifndef BURST_QUEUE_H
 #define BURST_QUEUE_H
 
+#include <stdio.h>
+
 #include "msg.h"
 
 typedef struct {
@@ -21,6 +23,65 @@ typedef struct burst_queue_st  {
     burst_node_t* tail;
 } burst_queue_t;
 
+/*
+ * Binary burst files (written by wlgen --format=bin) start with a header,
+ * followed by one record per burst: the fixed fields and then page_count
+ * page ids. All fields are uint32/int32 in the byte order of the host.
+ */
+#define BURST_FILE_MAGIC   0x54535242u      // "BRST"
+#define BURST_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} burst_file_header_t;
+
+typedef struct {
+    uint32_t burst_time_ms;
+    uint32_t block_time_ms;
+    int32_t nice;
+    uint32_t page_count;            // Followed by page_count uint32 page ids
+} burst_record_t;
+
+int parse_burst_line(const char* line, burst_t* burst);
+int write_burst_header(FILE* out);
+int write_burst_record(FILE* out, const burst_t* burst);
+/**
+ * Reads the next record of a binary burst file.
+ *
+ * @return 1 if a burst was read, 0 at end of file, -1 on a malformed record
+ */
+int read_burst_record(FILE* in, burst_t* burst);
+
+/*
+ * Streaming reader: bursts are parsed on demand, BURST_READER_AHEAD at a
+ * time, so memory use does not depend on the size of the file and the
+ * first burst is available as soon as the first lines are read.
+ */
+#define BURST_READER_AHEAD 64
+
+typedef struct {
+    FILE* file;
+    int binary;                     // Binary burst file (see above) instead of CSV
+    int eof;
+    int error;                      // Malformed binary record
+    uint64_t read;                  // Bursts parsed so far
+    uint32_t head;                  // Next burst to return from ahead[]
+    uint32_t count;                 // Bursts in ahead[]
+    burst_t ahead[BURST_READER_AHEAD];
+} burst_reader_t;
+
+int burst_reader_open(burst_reader_t* r, const char* filename);
+/**
+ * Returns the next burst of the file.
+ *
+ * Malformed CSV lines are reported and skipped.
+ *
+ * @return 1 if a burst was returned, 0 at end of file, -1 on a malformed binary record
+ */
+int burst_reader_next(burst_reader_t* r, burst_t* burst);
+void burst_reader_close(burst_reader_t* r);
+
 int read_queue_from_file(burst_queue_t* queue, const char* filename);
 int enqueue_burst(burst_queue_t* q, const burst_t* burst);
 burst_t* dequeue_burst(burst_queue_t* q);
@@ -0,0 +1,207 @@
+#include "ckpt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// PCB no checkpoint: os campos quentes e frios seguidos das páginas usadas
+typedef struct {
+    int32_t pid;
+    uint32_t time_ms;
+    uint32_t ellapsed_time_ms;
+    uint32_t slice_start_ms;
+    uint32_t estimate_ms;
+    uint32_t sockfd;
+    uint32_t last_update_time_ms;
+    uint32_t group;
+    int32_t status;
+    uint8_t priority_level;
+    uint8_t reserved[3];
+    uint32_t page_count;
+} ckpt_pcb_t;
+
+static int write_header(ckpt_t *c) {
+    ckpt_header_t header = {.magic = CKPT_MAGIC, .version = CKPT_VERSION, .pcb_size = sizeof(ckpt_pcb_t)};
+    ckpt_put(c, &header, sizeof(header));
+    return c->error ? -1 : 0;
+}
+
+int ckpt_open_write(ckpt_t *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    c->path = path;
+    int n = snprintf(c->tmp_path, sizeof(c->tmp_path), "%s.tmp", path);
+    if (n < 0 || (size_t)n >= sizeof(c->tmp_path)) return -1;
+
+    c->file = fopen(c->tmp_path, "wb");
+    if (!c->file) {
+        perror("fopen(checkpoint)");
+        return -1;
+    }
+    return write_header(c);
+}
+
+// O FILE fica com uma cópia do fd, para o fclose não fechar o do chamador
+static FILE *open_fd_stream(int fd, const char *mode) {
+    int copy = dup(fd);
+    if (copy < 0) return NULL;
+    FILE *f = fdopen(copy, mode);
+    if (!f) close(copy);
+    return f;
+}
+
+int ckpt_open_fd_write(ckpt_t *c, int fd) {
+    memset(c, 0, sizeof(*c));
+    c->file = open_fd_stream(fd, "wb");
+    if (!c->file) {
+        perror("fdopen(checkpoint)");
+        return -1;
+    }
+    return write_header(c);
+}
+
+int ckpt_close_write(ckpt_t *c) {
+    if (fflush(c->file) != 0 || (c->path && fsync(fileno(c->file)) != 0)) c->error = 1;
+    if (fclose(c->file) != 0) c->error = 1;
+    c->file = NULL;
+    if (!c->path) return c->error ? -1 : 0;
+
+    if (c->error || rename(c->tmp_path, c->path) != 0) {
+        perror("checkpoint");
+        unlink(c->tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+static int read_header(ckpt_t *c, const char *name) {
+    ckpt_header_t header;
+    ckpt_get(c, &header, sizeof(header));
+    if (c->error || header.magic != CKPT_MAGIC || header.version != CKPT_VERSION ||
+        header.pcb_size != sizeof(ckpt_pcb_t)) {
+        fprintf(stderr, "%s is not a checkpoint of this simulator version\n", name);
+        fclose(c->file);
+        c->file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int ckpt_open_read(ckpt_t *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    c->path = path;
+    c->file = fopen(path, "rb");
+    if (!c->file) {
+        perror("fopen(checkpoint)");
+        return -1;
+    }
+    return read_header(c, path);
+}
+
+int ckpt_open_fd_read(ckpt_t *c, int fd) {
+    memset(c, 0, sizeof(*c));
+    if (lseek(fd, 0, SEEK_SET) < 0 || !(c->file = open_fd_stream(fd, "rb"))) {
+        perror("checkpoint");
+        return -1;
+    }
+    return read_header(c, "The upgrade state");
+}
+
+int ckpt_close_read(ckpt_t *c) {
+    // Um checkpoint lido até ao fim não tem bytes a mais
+    if (!c->error && fgetc(c->file) != EOF) c->error = 1;
+    fclose(c->file);
+    c->file = NULL;
+    return c->error ? -1 : 0;
+}
+
+void ckpt_put(ckpt_t *c, const void *data, size_t len) {
+    if (c->error || len == 0) return;
+    if (fwrite(data, 1, len, c->file) != len) c->error = 1;
+}
+
+void ckpt_get(ckpt_t *c, void *data, size_t len) {
+    if (c->error) {
+        memset(data, 0, len);
+        return;
+    }
+    if (len > 0 && fread(data, 1, len, c->file) != len) {
+        memset(data, 0, len);
+        c->error = 1;
+    }
+}
+
+void ckpt_put_pcb(ckpt_t *c, const pcb_t *p) {
+    uint8_t present = p != NULL;
+    ckpt_put(c, &present, sizeof(present));
+    if (!p) return;
+
+    const pcb_cold_t *cold = p->cold;
+    ckpt_pcb_t rec = {
+        .pid = p->pid,
+        .time_ms = p->time_ms,
+        .ellapsed_time_ms = p->ellapsed_time_ms,
+        .slice_start_ms = p->slice_start_ms,
+        .estimate_ms = p->estimate_ms,
+        .sockfd = cold->sockfd,
+        .last_update_time_ms = cold->last_update_time_ms,
+        .group = cold->group,
+        .status = (int32_t)cold->status,
+        .priority_level = p->priority_level,
+        .page_count = cold->pages.count < MAX_PAGES ? cold->pages.count : MAX_PAGES,
+    };
+    ckpt_put(c, &rec, sizeof(rec));
+    ckpt_put(c, cold->pages.ids, (size_t)rec.page_count * sizeof(uint32_t));
+}
+
+pcb_t *ckpt_get_pcb(ckpt_t *c) {
+    uint8_t present;
+    ckpt_get(c, &present, sizeof(present));
+    if (!present || c->error) return NULL;
+
+    ckpt_pcb_t rec;
+    ckpt_get(c, &rec, sizeof(rec));
+    if (c->error || rec.page_count > MAX_PAGES) {
+        c->error = 1;
+        return NULL;
+    }
+    // O sockfd é traduzido depois de o PCB ser lido
+    pcb_t *p = new_pcb(rec.pid, rec.sockfd, rec.time_ms);
+    if (!p) {
+        c->error = 1;
+        return NULL;
+    }
+    p->ellapsed_time_ms = rec.ellapsed_time_ms;
+    p->slice_start_ms = rec.slice_start_ms;
+    p->estimate_ms = rec.estimate_ms;
+    p->priority_level = rec.priority_level;
+    pcb_cold_t *cold = p->cold;
+    cold->last_update_time_ms = rec.last_update_time_ms;
+    cold->group = rec.group;
+    cold->status = (task_status_en)rec.status;
+    cold->pages.count = rec.page_count;
+    ckpt_get(c, cold->pages.ids, (size_t)rec.page_count * sizeof(uint32_t));
+    cold->sockfd = (c->fd_map && cold->sockfd < c->fd_map_len) ? c->fd_map[cold->sockfd] : CKPT_ORPHAN_FD;
+    if (c->error) {
+        free_pcb(p);
+        return NULL;
+    }
+    return p;
+}
+
+void ckpt_put_queue(ckpt_t *c, const queue_t *q) {
+    ckpt_put(c, &q->count, sizeof(q->count));
+    for (const queue_elem_t *it = q->head; it; it = it->next) ckpt_put_pcb(c, it->pcb);
+}
+
+void ckpt_get_queue(ckpt_t *c, queue_t *q) {
+    uint32_t count;
+    ckpt_get(c, &count, sizeof(count));
+    for (uint32_t i = 0; i < count && !c->error; i++) {
+        pcb_t *p = ckpt_get_pcb(c);
+        if (!p) {
+            c->error = 1;
+        } else {
+            enqueue_pcb(q, p);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef CKPT_H
+#define CKPT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "queue.h"
+
+/*
+ * Checkpoint binário do estado do simulador.
+ *
+ * O ficheiro começa com um cabeçalho e segue com as secções escritas pelo
+ * ossim e por cada módulo (mem_checkpoint, vm_checkpoint, ...), sempre pela
+ * mesma ordem; o restauro lê-as pela mesma ordem. Os campos são escritos na
+ * ordem de bytes da máquina, pelo que o checkpoint só é lido no mesmo tipo
+ * de máquina e com o mesmo binário.
+ *
+ * A escrita é feita para FICHEIRO.tmp e só no fim é renomeada, pelo que um
+ * checkpoint interrompido nunca substitui o anterior. O mesmo formato é
+ * usado no hot upgrade (upgrade.h), escrito num fd (memfd) em vez de num
+ * ficheiro.
+ */
+
+#define CKPT_MAGIC   0x4b43534fu    // "OSCK"
+#define CKPT_VERSION 10
+
+// Os PCBs restaurados pertenciam a clientes do processo anterior: sem fd_map
+// ficam com este sockfd, que não corresponde a nenhuma ligação (os DONE são
+// descartados)
+#define CKPT_ORPHAN_FD UINT32_MAX
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pcb_size;              // tamanho de um PCB no ficheiro, deteta binários incompatíveis
+} ckpt_header_t;
+
+typedef struct {
+    FILE *file;
+    int error;                      // primeira falha de leitura/escrita (as seguintes são ignoradas)
+    char tmp_path[4096];
+    const char *path;               // NULL quando o checkpoint está num fd
+
+    // Restauro: sockfd antigo -> novo, para as ligações que passaram para
+    // este processo (hot upgrade); os restantes PCBs ficam órfãos
+    const uint32_t *fd_map;
+    uint32_t fd_map_len;
+} ckpt_t;
+
+/**
+ * @brief Cria FICHEIRO.tmp e escreve o cabeçalho
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int ckpt_open_write(ckpt_t *c, const char *path);
+
+/**
+ * @brief Fecha o checkpoint e, se não houve erros, substitui FICHEIRO
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int ckpt_close_write(ckpt_t *c);
+
+/**
+ * @brief Escreve o checkpoint num fd já aberto (o fd não é fechado)
+ */
+int ckpt_open_fd_write(ckpt_t *c, int fd);
+
+/**
+ * @brief Abre um checkpoint e valida o cabeçalho
+ *
+ * @return 0 em caso de sucesso, -1 se não for um checkpoint compatível
+ */
+int ckpt_open_read(ckpt_t *c, const char *path);
+
+/**
+ * @brief Lê um checkpoint desde o início de um fd (o fd não é fechado)
+ */
+int ckpt_open_fd_read(ckpt_t *c, int fd);
+
+/**
+ * @brief Fecha o checkpoint lido
+ *
+ * @return 0 se todas as secções foram lidas sem erros, -1 caso contrário
+ */
+int ckpt_close_read(ckpt_t *c);
+
+void ckpt_put(ckpt_t *c, const void *data, size_t len);
+void ckpt_get(ckpt_t *c, void *data, size_t len);
+
+/**
+ * @brief Escreve um PCB (ou a sua ausência, se p == NULL)
+ *
+ * Os campos quentes e frios vão num registo de tamanho fixo, seguido só
+ * das páginas usadas pelo burst.
+ */
+void ckpt_put_pcb(ckpt_t *c, const pcb_t *p);
+
+/**
+ * @brief Lê um PCB escrito por ckpt_put_pcb (NULL se estava ausente)
+ *
+ * O sockfd é traduzido pelo fd_map (CKPT_ORPHAN_FD se não estiver lá).
+ */
+pcb_t *ckpt_get_pcb(ckpt_t *c);
+
+/**
+ * @brief Escreve os PCBs de uma fila, por ordem
+ */
+void ckpt_put_queue(ckpt_t *c, const queue_t *q);
+
+/**
+ * @brief Acrescenta a q os PCBs escritos por ckpt_put_queue
+ */
+void ckpt_get_queue(ckpt_t *c, queue_t *q);
+
+#endif //CKPT_H
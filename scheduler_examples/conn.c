@@ -0,0 +1,851 @@
+#include "conn.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "stats.h"
+#include "uring.h"
+
+#define URING_SQ_ENTRIES   256
+#define URING_CQ_ENTRIES   4096
+#define URING_BUF_GROUP    0
+#define URING_BUF_COUNT    512                  // potência de 2
+#define URING_BUF_SIZE     (16 * sizeof(msg_t))
+
+// Tipo de operação, guardado nos bits baixos do user_data (o resto é o conn_t)
+#define URING_OP_ACCEPT 1u
+#define URING_OP_RECV   2u
+#define URING_OP_SEND   3u
+#define URING_OP_CANCEL 4u
+#define URING_OP_MASK   0xfu
+
+static conn_backend_en backend = CONN_BACKEND_EPOLL;
+static int epoll_fd = -1;
+static int listen_fd = -1;
+
+static uring_t ring;
+static uring_bufs_t bufs;
+static int32_t *buf_next = NULL;    // listas de buffers recebidos por ligação
+static uint32_t *buf_len = NULL;
+static conn_t *zombies = NULL;      // ligações fechadas com operações em curso
+static uint64_t closed_enters = 0;  // io_uring_enter feitos por rings já fechados
+static int *resumed = NULL;         // ligações que voltaram a ler com dados já recebidos
+static uint32_t resumed_count = 0;
+static uint32_t resumed_cap = 0;
+
+static conn_t **table = NULL;       // indexada pelo fd
+static uint32_t table_cap = 0;
+
+static int *active = NULL;          // fds das ligações ativas
+static uint32_t active_count = 0;
+
+static int *dirty = NULL;           // fds com mensagens novas por enviar
+static uint32_t dirty_count = 0;
+static uint32_t dirty_cap = 0;
+
+// ---------------------------------------------------------
+// Backend io_uring
+// ---------------------------------------------------------
+static void uring_teardown(void) {
+    closed_enters += ring.enters;
+    uring_bufs_unregister(&ring, &bufs);
+    uring_destroy(&ring);
+    free(buf_next);
+    free(buf_len);
+    buf_next = NULL;
+    buf_len = NULL;
+}
+
+static void recycle_cqe_buffer(const struct io_uring_cqe *cqe) {
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uring_bufs_recycle(&bufs, (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+}
+
+/*
+ * Confirma que o kernel suporta recv multishot com buffers fornecidos
+ * (Linux >= 6.0) recebendo um byte num socketpair. O accept multishot é
+ * anterior, pelo que fica coberto pelo mesmo teste.
+ */
+static int uring_probe(void) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return -1;
+
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = sv[0];
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+
+    int ok = 0, more = 0;
+    if (write(sv[1], "x", 1) == 1 && uring_submit_and_wait(&ring) >= 0) {
+        struct io_uring_cqe *cqe = uring_peek_cqe(&ring);
+        if (cqe) {
+            ok = cqe->res == 1 && (cqe->flags & IORING_CQE_F_BUFFER);
+            more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+            recycle_cqe_buffer(cqe);
+            uring_cqe_seen(&ring);
+        }
+    }
+
+    // O shutdown termina o recv multishot (CQE final com res = 0)
+    shutdown(sv[0], SHUT_RDWR);
+    while (more && uring_submit_and_wait(&ring) >= 0) {
+        struct io_uring_cqe *cqe;
+        while ((cqe = uring_peek_cqe(&ring)) != NULL) {
+            more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+            recycle_cqe_buffer(cqe);
+            uring_cqe_seen(&ring);
+        }
+    }
+    close(sv[1]);
+    close(sv[0]);
+    return ok ? 0 : -1;
+}
+
+static int uring_init(void) {
+    int err = uring_setup(&ring, URING_SQ_ENTRIES, URING_CQ_ENTRIES);
+    if (err < 0) {
+        fprintf(stderr, "io_uring unavailable (%s), using epoll\n", strerror(-err));
+        return -1;
+    }
+    err = uring_bufs_register(&ring, &bufs, URING_BUF_GROUP, URING_BUF_COUNT, URING_BUF_SIZE);
+    buf_next = malloc(URING_BUF_COUNT * sizeof(int32_t));
+    buf_len = malloc(URING_BUF_COUNT * sizeof(uint32_t));
+    if (err < 0 || !buf_next || !buf_len) {
+        fprintf(stderr, "io_uring provided buffers unavailable (%s), using epoll\n",
+                strerror(err < 0 ? -err : ENOMEM));
+        uring_teardown();
+        return -1;
+    }
+    if (uring_probe() < 0) {
+        fprintf(stderr, "io_uring multishot recv unavailable, using epoll\n");
+        uring_teardown();
+        closed_enters = 0;
+        return -1;
+    }
+    ring.enters = 0;    // conta só os do ciclo principal
+    return 0;
+}
+
+static void arm_accept(void) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = URING_OP_ACCEPT;
+}
+
+static void arm_recv(conn_t *c) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = c->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    sqe->user_data = (uint64_t)(uintptr_t)c | URING_OP_RECV;
+    c->recv_armed = 1;
+}
+
+// Cancela o recv multishot de uma ligação em pausa; os dados que o
+// cliente continuar a enviar ficam no socket até a leitura retomar
+static void cancel_recv(conn_t *c) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    if (!sqe) return;   // tentado de novo no próximo flush da ligação
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)c | URING_OP_RECV;
+    sqe->user_data = (uint64_t)(uintptr_t)c | URING_OP_CANCEL;
+    c->recv_cancel = 1;
+}
+
+// Devolve ao kernel os buffers recebidos que ainda não foram copiados
+static void release_rx_bufs(conn_t *c) {
+    while (c->rx_bufs_head >= 0) {
+        int32_t bid = c->rx_bufs_head;
+        c->rx_bufs_head = buf_next[bid];
+        uring_bufs_recycle(&bufs, (uint16_t)bid);
+    }
+    c->rx_bufs_tail = -1;
+    c->rx_buf_offset = 0;
+}
+
+static void free_retired(conn_t *c) {
+    for (uint8_t i = 0; i < c->tx_retired_count; i++) free(c->tx_retired[i]);
+    c->tx_retired_count = 0;
+}
+
+static void conn_free(conn_t *c) {
+    free_retired(c);
+    free(c->tx);
+    free(c);
+}
+
+// Liberta uma ligação fechada quando já não há operações do kernel sobre ela
+static void reap_zombie(conn_t *c) {
+    if (c->recv_armed || c->send_inflight || c->recv_cancel) return;
+    for (conn_t **z = &zombies; *z; z = &(*z)->next_zombie) {
+        if (*z == c) {
+            *z = c->next_zombie;
+            break;
+        }
+    }
+    conn_free(c);
+}
+
+// ---------------------------------------------------------
+// Tabela de ligações
+// ---------------------------------------------------------
+int conn_init(conn_backend_en wanted) {
+    if (wanted == CONN_BACKEND_URING && uring_init() == 0) {
+        backend = CONN_BACKEND_URING;
+        return 0;
+    }
+
+    backend = CONN_BACKEND_EPOLL;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+    return 0;
+}
+
+conn_backend_en conn_backend(void) {
+    return backend;
+}
+
+const char *conn_backend_name(conn_backend_en b) {
+    return b == CONN_BACKEND_URING ? "io_uring" : "epoll";
+}
+
+uint64_t conn_uring_enters(void) {
+    return backend == CONN_BACKEND_URING ? closed_enters + ring.enters : 0;
+}
+
+int conn_watch_listener(int fd) {
+    listen_fd = fd;
+    if (backend == CONN_BACKEND_URING) {
+        arm_accept();
+        return 0;
+    }
+
+    struct epoll_event ev = {.events = EPOLLIN, .data.fd = fd};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl(listener)");
+        return -1;
+    }
+    return 0;
+}
+
+static void mark_dirty(conn_t *c);
+
+// Atualiza os eventos pedidos ao epoll: EPOLLIN só enquanto a leitura não
+// está suspensa e EPOLLOUT só enquanto há mensagens retidas pelo kernel.
+// Com o io_uring, a pausa cancela o recv e o fim dela volta a armá-lo, no
+// conn_flush_all
+static void update_events(conn_t *c, int want_out, int paused) {
+    if (c->want_out == want_out && c->paused == paused) return;
+    if (backend == CONN_BACKEND_URING && c->paused != paused) {
+        mark_dirty(c);
+    } else if (backend == CONN_BACKEND_EPOLL) {
+        struct epoll_event ev = {
+            .events = (paused ? 0 : EPOLLIN) | (want_out ? EPOLLOUT : 0),
+            .data.fd = c->fd
+        };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->fd, &ev) < 0) {
+            perror("epoll_ctl(MOD)");
+            return;
+        }
+    }
+    c->want_out = (uint8_t)want_out;
+    c->paused = (uint8_t)paused;
+}
+
+// Garante que a tabela tem posição para o fd indicado
+static int ensure_capacity(int fd) {
+    if ((uint32_t)fd < table_cap) return 0;
+
+    uint32_t cap = table_cap ? table_cap : 64;
+    while (cap <= (uint32_t)fd) cap *= 2;
+
+    conn_t **bigger = realloc(table, cap * sizeof(conn_t *));
+    if (!bigger) return -1;
+    table = bigger;
+    int *bigger_active = realloc(active, cap * sizeof(int));
+    if (!bigger_active) return -1;
+    active = bigger_active;
+
+    for (uint32_t i = table_cap; i < cap; i++) table[i] = NULL;
+    table_cap = cap;
+    return 0;
+}
+
+conn_t *conn_open(int fd, uint32_t now_ms) {
+    if (fd < 0 || ensure_capacity(fd) < 0) return NULL;
+
+    conn_t *c = calloc(1, sizeof(conn_t));
+    if (!c) return NULL;
+    c->tx = malloc(CONN_TX_MIN_MSGS * sizeof(msg_t));
+    if (!c->tx) {
+        free(c);
+        return NULL;
+    }
+    c->fd = fd;
+    c->active_idx = active_count;
+    c->connected_ms = now_ms;
+    c->tx_cap = CONN_TX_MIN_MSGS;
+    c->rx_bufs_head = c->rx_bufs_tail = -1;
+
+    if (backend == CONN_BACKEND_URING) {
+        arm_recv(c);
+    } else {
+        struct epoll_event ev = {.events = EPOLLIN, .data.fd = fd};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl(ADD)");
+            conn_free(c);
+            return NULL;
+        }
+    }
+
+    table[fd] = c;
+    active[active_count++] = fd;
+    return c;
+}
+
+conn_t *conn_get(int fd) {
+    if (fd < 0 || (uint32_t)fd >= table_cap) return NULL;
+    return table[fd];
+}
+
+void conn_close(conn_t *c) {
+    if (!c) return;
+
+    // Troca com a última ligação ativa para remover em O(1)
+    int last = active[--active_count];
+    active[c->active_idx] = last;
+    table[last]->active_idx = c->active_idx;
+
+    // Mensagens que ficaram por enviar perdem-se com a ligação
+    g_stats.tx_dropped += c->tx_tail - c->tx_head;
+
+    // O close retira o fd do epoll; entradas antigas na lista dirty
+    // são ignoradas porque conn_get deixa de encontrar esta ligação
+    table[c->fd] = NULL;
+
+    if (backend == CONN_BACKEND_URING) {
+        // As operações em curso têm uma referência para o socket: o shutdown
+        // termina-as, e o conn_t só é libertado depois das últimas CQEs
+        release_rx_bufs(c);
+        shutdown(c->fd, SHUT_RDWR);
+        close(c->fd);
+        c->closing = 1;
+        c->next_zombie = zombies;
+        zombies = c;
+        reap_zombie(c);
+        return;
+    }
+
+    close(c->fd);
+    conn_free(c);
+}
+
+uint32_t conn_count(void) {
+    return active_count;
+}
+
+conn_t *conn_at(uint32_t i) {
+    return i < active_count ? table[active[i]] : NULL;
+}
+
+void conn_close_all(void) {
+    while (active_count > 0) conn_close(table[active[active_count - 1]]);
+    if (backend == CONN_BACKEND_URING) {
+        // Fechar o ring cancela o que ainda estiver em curso
+        uring_teardown();
+        while (zombies) {
+            conn_t *next = zombies->next_zombie;
+            conn_free(zombies);
+            zombies = next;
+        }
+    }
+    free(table);
+    free(active);
+    free(dirty);
+    free(resumed);
+    resumed = NULL;
+    resumed_count = resumed_cap = 0;
+    table = NULL;
+    active = NULL;
+    dirty = NULL;
+    table_cap = dirty_cap = dirty_count = 0;
+    if (epoll_fd >= 0) close(epoll_fd);
+    epoll_fd = -1;
+}
+
+// ---------------------------------------------------------
+// Eventos
+// ---------------------------------------------------------
+
+// Aceita todas as ligações pendentes no socket de escuta
+static void accept_clients(uint32_t now_ms) {
+    while (1) {
+        int client = accept(listen_fd, NULL, NULL);
+        if (client < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+            break;
+        }
+        int flags = fcntl(client, F_GETFL, 0);
+        if (flags >= 0) fcntl(client, F_SETFL, flags | O_NONBLOCK);
+
+        if (!conn_open(client, now_ms)) {
+            close(client);
+            continue;
+        }
+        g_stats.clients_accepted++;
+        g_stats.clients_connected++;
+    }
+}
+
+static int epoll_poll(conn_event_t *events, int max_events, uint32_t now_ms) {
+    struct epoll_event ev[64];
+    if (max_events > 64) max_events = 64;
+
+    int n = epoll_wait(epoll_fd, ev, max_events, 0);
+    if (n < 0) {
+        if (errno != EINTR) perror("epoll_wait");
+        return 0;
+    }
+
+    // O socket de escuta ocupa a sua posição com fd = -1, para que n
+    // continue a indicar se o epoll devolveu o máximo de eventos
+    for (int i = 0; i < n; i++) {
+        if (ev[i].data.fd == listen_fd) {
+            accept_clients(now_ms);
+            events[i].fd = -1;
+            events[i].events = 0;
+            continue;
+        }
+        events[i].fd = ev[i].data.fd;
+        events[i].events = ((ev[i].events & EPOLLIN) ? CONN_EV_IN : 0) |
+                           ((ev[i].events & EPOLLOUT) ? CONN_EV_OUT : 0) |
+                           ((ev[i].events & (EPOLLHUP | EPOLLERR)) ? CONN_EV_HUP : 0);
+    }
+    return n;
+}
+
+static void complete_send(conn_t *c, int32_t res);
+
+// Trata uma CQE; devolve a ligação se houver dados novos (ou o fim da ligação)
+static conn_t *handle_cqe(const struct io_uring_cqe *cqe, uint32_t now_ms) {
+    uint32_t op = (uint32_t)(cqe->user_data & URING_OP_MASK);
+    conn_t *c = (conn_t *)(uintptr_t)(cqe->user_data & ~(uint64_t)URING_OP_MASK);
+    int more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+
+    if (op == URING_OP_ACCEPT) {
+        if (cqe->res >= 0) {
+            if (conn_open(cqe->res, now_ms)) {
+                g_stats.clients_accepted++;
+                g_stats.clients_connected++;
+            } else {
+                close(cqe->res);
+            }
+        } else if (cqe->res != -EAGAIN && cqe->res != -EINTR) {
+            fprintf(stderr, "accept: %s\n", strerror(-cqe->res));
+        }
+        if (!more) arm_accept();
+        return NULL;
+    }
+
+    if (op == URING_OP_CANCEL) {
+        // O recv cancelado termina com a sua própria CQE (-ECANCELED)
+        c->recv_cancel = 0;
+        if (c->closing) reap_zombie(c);
+        return NULL;
+    }
+
+    if (op == URING_OP_SEND) {
+        if (c->closing) {
+            complete_send(c, cqe->res);
+            return NULL;
+        }
+        complete_send(c, cqe->res);
+        return c->eof ? c : NULL;
+    }
+
+    // URING_OP_RECV
+    if (!more) c->recv_armed = 0;
+    if (c->closing) {
+        recycle_cqe_buffer(cqe);
+        reap_zombie(c);
+        return NULL;
+    }
+
+    if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+        int32_t bid = (int32_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        buf_len[bid] = (uint32_t)cqe->res;
+        buf_next[bid] = -1;
+        if (c->rx_bufs_tail >= 0) buf_next[c->rx_bufs_tail] = bid;
+        else c->rx_bufs_head = bid;
+        c->rx_bufs_tail = bid;
+    } else if (cqe->res == 0) {
+        c->eof = 1;
+    } else if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED) {
+        c->eof = 2;
+    }
+
+    // Sem EOF (p.ex. ENOBUFS, todos os buffers ocupados) volta a ser armado
+    // no flush, se a leitura não estiver suspensa
+    if (!c->recv_armed && !c->eof) mark_dirty(c);
+    return (cqe->res != -ENOBUFS && cqe->res != -ECANCELED) ? c : NULL;
+}
+
+static int uring_poll(conn_event_t *events, int max_events, uint32_t now_ms) {
+    int count = 0;
+    while (resumed_count > 0 && count < max_events) {
+        conn_t *c = conn_get(resumed[--resumed_count]);
+        if (!c || c->ready) continue;
+        c->ready = 1;
+        events[count].fd = c->fd;
+        events[count].events = CONN_EV_IN | (c->eof ? CONN_EV_HUP : 0);
+        count++;
+    }
+
+    struct io_uring_cqe *cqe;
+    while (count < max_events && (cqe = uring_peek_cqe(&ring)) != NULL) {
+        struct io_uring_cqe copy = *cqe;
+        uring_cqe_seen(&ring);
+
+        conn_t *c = handle_cqe(&copy, now_ms);
+        if (!c || c->ready) continue;
+        c->ready = 1;
+        events[count].fd = c->fd;
+        events[count].events = CONN_EV_IN | (c->eof ? CONN_EV_HUP : 0);
+        count++;
+    }
+    return count;
+}
+
+int conn_poll(conn_event_t *events, int max_events, uint32_t now_ms) {
+    if (backend == CONN_BACKEND_URING) return uring_poll(events, max_events, now_ms);
+    return epoll_poll(events, max_events, now_ms);
+}
+
+// ---------------------------------------------------------
+// Receção
+// ---------------------------------------------------------
+
+// Copia para rx os buffers já preenchidos pelo recv multishot
+static conn_recv_en uring_recv(conn_t *c) {
+    c->ready = 0;
+    while (c->rx_bufs_head >= 0) {
+        int32_t bid = c->rx_bufs_head;
+        uint32_t avail = buf_len[bid] - c->rx_buf_offset;
+        uint32_t room = CONN_RX_BYTES - c->rx_len;
+        if (room == 0) return CONN_RECV_FULL;
+
+        uint32_t n = avail < room ? avail : room;
+        memcpy(c->rx + c->rx_len, uring_buf_addr(&bufs, (uint16_t)bid) + c->rx_buf_offset, n);
+        c->rx_len += n;
+        c->rx_buf_offset += n;
+        if (c->rx_buf_offset == buf_len[bid]) {
+            c->rx_bufs_head = buf_next[bid];
+            if (c->rx_bufs_head < 0) c->rx_bufs_tail = -1;
+            c->rx_buf_offset = 0;
+            uring_bufs_recycle(&bufs, (uint16_t)bid);
+        }
+    }
+    if (c->eof) return c->eof == 1 ? CONN_RECV_EOF : CONN_RECV_ERROR;
+    return CONN_RECV_AGAIN;
+}
+
+conn_recv_en conn_recv(conn_t *c) {
+    // Move a mensagem parcial que sobrou para o início do buffer
+    if (c->rx_start > 0) {
+        memmove(c->rx, c->rx + c->rx_start, c->rx_len - c->rx_start);
+        c->rx_len -= c->rx_start;
+        c->rx_start = 0;
+    }
+
+    if (backend == CONN_BACKEND_URING) return uring_recv(c);
+
+    while (c->rx_len < CONN_RX_BYTES) {
+        ssize_t n = recv(c->fd, c->rx + c->rx_len, CONN_RX_BYTES - c->rx_len, MSG_DONTWAIT);
+        if (n == 0) return CONN_RECV_EOF;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return CONN_RECV_AGAIN;
+            return CONN_RECV_ERROR;
+        }
+        c->rx_len += (uint32_t)n;
+    }
+    return CONN_RECV_FULL;
+}
+
+int conn_pop_msg(conn_t *c, msg_t *out) {
+    if (c->rx_len - c->rx_start < sizeof(msg_t)) return 0;
+    memcpy(out, c->rx + c->rx_start, sizeof(msg_t));
+    c->rx_start += sizeof(msg_t);
+    return 1;
+}
+
+// ---------------------------------------------------------
+// Envio
+// ---------------------------------------------------------
+
+// Duplica a capacidade do ring, mantendo a ordem das mensagens
+static int grow_tx(conn_t *c) {
+    if (c->tx_cap >= CONN_TX_MAX_MSGS) return -1;
+    msg_t *bigger = malloc(2 * c->tx_cap * sizeof(msg_t));
+    if (!bigger) return -1;
+
+    uint32_t pending = c->tx_tail - c->tx_head;
+    for (uint32_t i = 0; i < pending; i++) {
+        bigger[i] = c->tx[(c->tx_head + i) & (c->tx_cap - 1)];
+    }
+    // Um sendmsg em curso ainda lê do ring antigo
+    if (c->send_inflight) c->tx_retired[c->tx_retired_count++] = c->tx;
+    else free(c->tx);
+    c->tx = bigger;
+    c->tx_cap *= 2;
+    c->tx_head = 0;
+    c->tx_tail = pending;
+    return 0;
+}
+
+static void mark_dirty(conn_t *c) {
+    if (c->dirty || c->want_out) return;   // com EPOLLOUT ativo o envio é feito pelo epoll
+    if (dirty_count == dirty_cap) {
+        uint32_t cap = dirty_cap ? dirty_cap * 2 : 64;
+        int *bigger = realloc(dirty, cap * sizeof(int));
+        if (!bigger) return;
+        dirty = bigger;
+        dirty_cap = cap;
+    }
+    dirty[dirty_count++] = c->fd;
+    c->dirty = 1;
+}
+
+int conn_send(conn_t *c, const msg_t *msg) {
+    uint32_t pending = c->tx_tail - c->tx_head;
+    if (pending == c->tx_cap && grow_tx(c) < 0) {
+        g_stats.tx_dropped++;
+        return 0;
+    }
+    c->tx[c->tx_tail & (c->tx_cap - 1)] = *msg;
+    c->tx_tail++;
+
+    pending++;
+    if (pending > g_stats.tx_peak_backlog) g_stats.tx_peak_backlog = pending;
+    if (!c->paused && pending > CONN_TX_HIGH_MSGS) {
+        update_events(c, c->want_out, 1);
+        g_stats.backpressure_pauses++;
+    }
+    mark_dirty(c);
+    return 1;
+}
+
+void conn_notify(uint32_t sockfd, const msg_t *msg) {
+    conn_t *c = conn_get((int)sockfd);
+    if (!c) {
+        g_stats.tx_dropped++;
+        return;
+    }
+    conn_send(c, msg);
+}
+
+int conn_paused(const conn_t *c) {
+    return c->paused;
+}
+
+// Descreve o conteúdo do ring, que ocupa no máximo dois blocos contíguos
+static int tx_iov(const conn_t *c, struct iovec iov[2]) {
+    uint32_t first = c->tx_head & (c->tx_cap - 1);
+    uint32_t pending = c->tx_tail - c->tx_head;
+    uint32_t run = c->tx_cap - first < pending ? c->tx_cap - first : pending;
+
+    iov[0].iov_base = (uint8_t *)&c->tx[first] + c->tx_offset;
+    iov[0].iov_len = run * sizeof(msg_t) - c->tx_offset;
+    if (run == pending) return 1;
+    iov[1].iov_base = &c->tx[0];
+    iov[1].iov_len = (pending - run) * sizeof(msg_t);
+    return 2;
+}
+
+// Avança sobre as mensagens enviadas (e a parte enviada da seguinte)
+static void tx_advance(conn_t *c, size_t bytes) {
+    size_t sent = bytes + c->tx_offset;
+    c->tx_head += (uint32_t)(sent / sizeof(msg_t));
+    c->tx_offset = (uint32_t)(sent % sizeof(msg_t));
+}
+
+static void complete_send(conn_t *c, int32_t res) {
+    c->send_inflight = 0;
+    free_retired(c);
+    if (c->closing) {
+        reap_zombie(c);
+        return;
+    }
+    if (res < 0) {
+        // Tratado como o fim da ligação no próximo conn_recv
+        c->eof = 2;
+        return;
+    }
+
+    size_t wanted = c->send_iov[0].iov_len;
+    if (c->send_hdr.msg_iovlen > 1) wanted += c->send_iov[1].iov_len;
+    if ((size_t)res < wanted) g_stats.tx_stalls++;     // o socket encheu
+
+    tx_advance(c, (size_t)res);
+    uint32_t pending = c->tx_tail - c->tx_head;
+    if (pending > 0) mark_dirty(c);     // o resto segue no próximo flush
+
+    // Ao sair da pausa, os pedidos que ficaram nos buffers não geram CQEs
+    // novas: a ligação é devolvida pelo próximo conn_poll
+    int was_paused = c->paused;
+    update_events(c, 0, c->paused && pending >= CONN_TX_LOW_MSGS);
+    if (was_paused && !c->paused && c->rx_bufs_head >= 0) {
+        if (resumed_count == resumed_cap) {
+            uint32_t cap = resumed_cap ? resumed_cap * 2 : 64;
+            int *bigger = realloc(resumed, cap * sizeof(int));
+            if (!bigger) return;
+            resumed = bigger;
+            resumed_cap = cap;
+        }
+        resumed[resumed_count++] = c->fd;
+    }
+}
+
+// Prepara um sendmsg com tudo o que está no ring (um por ligação de cada vez)
+static void uring_flush(conn_t *c) {
+    if (c->send_inflight || c->tx_head == c->tx_tail) return;
+
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    if (!sqe) {
+        mark_dirty(c);
+        return;
+    }
+    memset(&c->send_hdr, 0, sizeof(c->send_hdr));
+    c->send_hdr.msg_iov = c->send_iov;
+    c->send_hdr.msg_iovlen = (size_t)tx_iov(c, c->send_iov);
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = c->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&c->send_hdr;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (uint64_t)(uintptr_t)c | URING_OP_SEND;
+    c->send_inflight = 1;
+}
+
+int conn_flush(conn_t *c) {
+    if (backend == CONN_BACKEND_URING) {
+        uring_flush(c);
+        return 0;
+    }
+
+    while (c->tx_head != c->tx_tail) {
+        struct iovec iov[2];
+        int iovcnt = tx_iov(c, iov);
+
+        ssize_t n = writev(c->fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // O cliente não está a ler: o resto segue quando houver EPOLLOUT
+                if (!c->want_out) g_stats.tx_stalls++;
+                update_events(c, 1, c->paused);
+                break;
+            }
+            return -1;
+        }
+        tx_advance(c, (size_t)n);
+    }
+
+    uint32_t pending = c->tx_tail - c->tx_head;
+    update_events(c, pending > 0 && c->want_out, c->paused && pending >= CONN_TX_LOW_MSGS);
+    return 0;
+}
+
+void conn_flush_all(void) {
+    for (uint32_t i = 0; i < dirty_count; i++) {
+        conn_t *c = conn_get(dirty[i]);
+        if (!c || !c->dirty) continue;
+        c->dirty = 0;
+        // Os erros de escrita são detetados na próxima leitura (EOF), que fecha a ligação
+        conn_flush(c);
+        if (backend == CONN_BACKEND_URING && !c->eof) {
+            if (!c->paused && !c->recv_armed) arm_recv(c);
+            else if (c->paused && c->recv_armed && !c->recv_cancel) cancel_recv(c);
+        }
+    }
+    dirty_count = 0;
+
+    // Com o io_uring, os sendmsg e recvs de todas as ligações seguem num único enter
+    if (backend == CONN_BACKEND_URING) {
+        int err = uring_submit(&ring);
+        if (err < 0) fprintf(stderr, "io_uring_enter: %s\n", strerror(-err));
+    }
+}
+
+// ---------------------------------------------------------
+// Hot upgrade
+// ---------------------------------------------------------
+void conn_checkpoint(const conn_t *c, ckpt_t *ck) {
+    uint32_t rx_pending = c->rx_len - c->rx_start;
+    uint32_t tx_pending = c->tx_tail - c->tx_head;
+    ckpt_put(ck, &c->connected_ms, sizeof(c->connected_ms));
+    ckpt_put(ck, &c->requests, sizeof(c->requests));
+    ckpt_put(ck, &rx_pending, sizeof(rx_pending));
+    ckpt_put(ck, c->rx + c->rx_start, rx_pending);
+    ckpt_put(ck, &tx_pending, sizeof(tx_pending));
+    ckpt_put(ck, &c->tx_offset, sizeof(c->tx_offset));
+    for (uint32_t i = 0; i < tx_pending; i++) {
+        ckpt_put(ck, &c->tx[(c->tx_head + i) & (c->tx_cap - 1)], sizeof(msg_t));
+    }
+}
+
+conn_t *conn_restore(ckpt_t *ck, int fd) {
+    uint32_t connected_ms, rx_pending, tx_pending, tx_offset;
+    uint64_t requests;
+    ckpt_get(ck, &connected_ms, sizeof(connected_ms));
+    ckpt_get(ck, &requests, sizeof(requests));
+    ckpt_get(ck, &rx_pending, sizeof(rx_pending));
+    if (ck->error || rx_pending > CONN_RX_BYTES) return NULL;
+
+    conn_t *c = conn_open(fd, connected_ms);
+    if (!c) return NULL;
+    c->requests = requests;
+    ckpt_get(ck, c->rx, rx_pending);
+    c->rx_len = rx_pending;
+
+    ckpt_get(ck, &tx_pending, sizeof(tx_pending));
+    ckpt_get(ck, &tx_offset, sizeof(tx_offset));
+    if (ck->error || tx_pending > CONN_TX_MAX_MSGS || tx_offset >= sizeof(msg_t)) {
+        ck->error = 1;
+        return c;       // fechada por quem restaura, com as restantes
+    }
+    while (c->tx_cap < tx_pending) {
+        if (grow_tx(c) < 0) {
+            ck->error = 1;
+            return c;
+        }
+    }
+    ckpt_get(ck, c->tx, tx_pending * sizeof(msg_t));
+    c->tx_tail = tx_pending;
+    c->tx_offset = tx_pending > 0 ? tx_offset : 0;
+    if (tx_pending > 0) {
+        if (tx_pending > CONN_TX_HIGH_MSGS) update_events(c, c->want_out, 1);
+        mark_dirty(c);
+    }
+    return c;
+}
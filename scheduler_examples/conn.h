@@ -0,0 +1,245 @@
+#ifndef CONN_H
+#define CONN_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "msg.h"
+#include "ckpt.h"
+#include "admit.h"
+
+#define CONN_RX_BYTES     (32 * sizeof(msg_t))  // buffer de receção (mensagens completas ou parciais)
+#define CONN_TX_MIN_MSGS  16                    // capacidade inicial do ring de envio (potência de 2)
+#define CONN_TX_MAX_MSGS  4096                  // acima disto as mensagens são descartadas
+#define CONN_TX_HIGH_MSGS 256                   // acima disto deixamos de ler pedidos do cliente
+#define CONN_TX_LOW_MSGS  64                    // abaixo disto voltamos a ler
+
+// Mecanismo de I/O usado para os sockets das aplicações
+typedef enum {
+    CONN_BACKEND_EPOLL = 0,     // readiness (epoll) + recv/writev por ligação
+    CONN_BACKEND_URING,         // io_uring: um io_uring_enter por tick
+} conn_backend_en;
+
+// Eventos devolvidos por conn_poll
+#define CONN_EV_IN  (1u << 0)   // há dados para ler (conn_recv)
+#define CONN_EV_OUT (1u << 1)   // o socket voltou a aceitar dados (conn_flush)
+#define CONN_EV_HUP (1u << 2)   // a ligação terminou ou tem um erro
+
+typedef struct {
+    int fd;
+    uint32_t events;            // CONN_EV_*
+} conn_event_t;
+
+// Resultado de conn_recv
+typedef enum {
+    CONN_RECV_AGAIN = 0,    // tudo o que havia foi lido
+    CONN_RECV_FULL,         // o buffer encheu, pode haver mais dados no socket
+    CONN_RECV_EOF,          // o cliente fechou a ligação
+    CONN_RECV_ERROR         // erro no socket
+} conn_recv_en;
+
+/*
+ * Ligações das aplicações ao scheduler.
+ *
+ * As ligações são guardadas numa tabela indexada pelo próprio fd (acesso
+ * em O(1) a partir do sockfd de um PCB) e, ao mesmo tempo, num vetor denso
+ * com as ligações ativas, para que percorrê-las custe O(ligações ativas) e
+ * removê-las custe O(1) (troca com a última).
+ *
+ * Cada ligação tem um buffer de receção, onde ficam guardadas as mensagens
+ * incompletas até ao tick seguinte, e um ring de mensagens por enviar.
+ * Ninguém escreve diretamente no socket: ACKs e DONEs são colocados no ring
+ * (conn_send/conn_notify) e enviados no fim da fase com um writev. Se o
+ * cliente não estiver a ler, o resto fica no ring e o envio passa a ser
+ * feito quando o epoll indicar EPOLLOUT.
+ *
+ * Com o backend io_uring os sockets nunca são lidos nem escritos
+ * diretamente: cada ligação tem um recv multishot com buffers fornecidos
+ * ao kernel, e os envios do tick seguem todos como sendmsg num único
+ * io_uring_enter, no conn_flush_all. Enquanto a leitura de uma ligação
+ * está suspensa (backpressure) o seu recv é cancelado, para que um
+ * cliente que não lê as respostas não esgote os buffers partilhados por
+ * todas as ligações; volta a ser armado quando a leitura retoma.
+ */
+typedef struct conn_st {
+    int fd;
+    uint32_t active_idx;        // posição no vetor de ligações ativas
+    uint32_t connected_ms;      // tempo de simulação em que a ligação foi aceite
+    uint64_t requests;          // pedidos recebidos nesta ligação
+    admit_bucket_t bucket;      // token bucket do controlo de admissão (não vai no checkpoint)
+
+    uint8_t rx[CONN_RX_BYTES];
+    uint32_t rx_start;          // início da próxima mensagem por processar
+    uint32_t rx_len;            // fim dos dados recebidos
+
+    msg_t *tx;                  // ring de envio (cresce até CONN_TX_MAX_MSGS)
+    uint32_t tx_cap;
+    uint32_t tx_head;           // próxima mensagem a enviar
+    uint32_t tx_tail;           // próxima posição livre
+    uint32_t tx_offset;         // bytes da mensagem tx_head já enviados
+    uint8_t dirty;              // está na lista de ligações com envios pendentes
+    uint8_t want_out;           // EPOLLOUT ativo
+    uint8_t paused;             // leitura suspensa por backpressure
+
+    // Backend io_uring
+    uint8_t recv_armed;         // recv multishot em curso
+    uint8_t recv_cancel;        // cancelamento do recv submetido (leitura suspensa)
+    uint8_t send_inflight;      // sendmsg submetido, à espera da CQE
+    uint8_t eof;                // 1 = o cliente fechou, 2 = erro no socket
+    uint8_t closing;            // fechada, à espera das CQEs em curso
+    uint8_t ready;              // já devolvida pelo conn_poll atual
+    int32_t rx_bufs_head;       // buffers recebidos por copiar para rx (-1 = nenhum)
+    int32_t rx_bufs_tail;
+    uint32_t rx_buf_offset;     // bytes já copiados do primeiro buffer
+    struct msghdr send_hdr;     // têm de existir até à CQE do sendmsg
+    struct iovec send_iov[2];
+    msg_t *tx_retired[8];       // rings substituídos durante um sendmsg
+    uint8_t tx_retired_count;
+    struct conn_st *next_zombie;
+} conn_t;
+
+/**
+ * @brief Prepara o backend de I/O pedido
+ *
+ * Se o io_uring não estiver disponível (kernel antigo, seccomp, falta de
+ * recv multishot ou de buffers fornecidos), usa o epoll.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int conn_init(conn_backend_en backend);
+
+/**
+ * @brief Backend efetivamente em uso
+ */
+conn_backend_en conn_backend(void);
+
+const char *conn_backend_name(conn_backend_en backend);
+
+/**
+ * @brief Começa a aceitar ligações no socket de escuta (não bloqueante)
+ */
+int conn_watch_listener(int fd);
+
+/**
+ * @brief Aceita as ligações pendentes e devolve os eventos prontos, sem bloquear
+ *
+ * As novas ligações são registadas aqui (conn_open) e não geram eventos.
+ * Com o io_uring não faz syscalls: só consome as CQEs já publicadas.
+ *
+ * @return O número de eventos em events (0 se nenhum)
+ */
+int conn_poll(conn_event_t *events, int max_events, uint32_t now_ms);
+
+/**
+ * @brief Regista uma nova ligação
+ *
+ * @return A ligação criada, ou NULL em caso de falha de alocação
+ */
+conn_t *conn_open(int fd, uint32_t now_ms);
+
+/**
+ * @brief Devolve a ligação associada ao fd, ou NULL se não existir
+ */
+conn_t *conn_get(int fd);
+
+/**
+ * @brief Fecha o socket e liberta a ligação em O(1)
+ */
+void conn_close(conn_t *c);
+
+/**
+ * @brief Número de ligações ativas
+ */
+uint32_t conn_count(void);
+
+/**
+ * @brief i-ésima ligação ativa (0 <= i < conn_count())
+ *
+ * Fechar a ligação i move a última para a posição i, pelo que quem fecha
+ * ligações durante a iteração deve percorrer o vetor do fim para o início.
+ */
+conn_t *conn_at(uint32_t i);
+
+/**
+ * @brief Fecha todas as ligações e liberta a tabela
+ */
+void conn_close_all(void);
+
+/**
+ * @brief Lê do socket tudo o que estiver disponível (até encher o buffer)
+ */
+conn_recv_en conn_recv(conn_t *c);
+
+/**
+ * @brief Retira do buffer de receção a próxima mensagem completa
+ *
+ * @return 1 se out foi preenchida, 0 se não há nenhuma mensagem completa
+ */
+int conn_pop_msg(conn_t *c, msg_t *out);
+
+/**
+ * @brief Coloca uma mensagem no ring de envio (sem syscalls)
+ *
+ * @return 1 em caso de sucesso, 0 se o ring chegou ao limite e a mensagem foi descartada
+ */
+int conn_send(conn_t *c, const msg_t *msg);
+
+/**
+ * @brief Coloca uma mensagem no ring de envio da ligação do socket indicado
+ *
+ * Usada pelos escalonadores para os DONE; se o cliente já se desligou a
+ * mensagem é descartada.
+ */
+void conn_notify(uint32_t sockfd, const msg_t *msg);
+
+/**
+ * @brief Indica se a leitura de pedidos desta ligação está suspensa
+ *
+ * A leitura é suspensa quando há mais de CONN_TX_HIGH_MSGS mensagens por
+ * enviar, e retomada quando baixam de CONN_TX_LOW_MSGS.
+ */
+int conn_paused(const conn_t *c);
+
+/**
+ * @brief Envia as mensagens pendentes com um único writev
+ *
+ * O que não couber no socket fica no ring e o EPOLLOUT é ativado. Com o
+ * io_uring apenas prepara o sendmsg, que segue no próximo conn_flush_all.
+ *
+ * @return 0 em caso de sucesso (mesmo que parcial), -1 em caso de erro no socket
+ */
+int conn_flush(conn_t *c);
+
+/**
+ * @brief Envia as mensagens pendentes de todas as ligações com envios novos
+ *
+ * Com o io_uring é aqui que é feito o único io_uring_enter do tick.
+ */
+void conn_flush_all(void);
+
+/**
+ * @brief Número de chamadas a io_uring_enter (0 com o epoll)
+ */
+uint64_t conn_uring_enters(void);
+
+/**
+ * @brief Escreve o estado de uma ligação para o hot upgrade
+ *
+ * Guarda os bytes recebidos por processar (uma mensagem parcial) e as
+ * mensagens por enviar. Só é suportado com o backend epoll: com o io_uring
+ * parte do estado está em operações em curso no kernel.
+ */
+void conn_checkpoint(const conn_t *c, ckpt_t *ck);
+
+/**
+ * @brief Regista uma ligação herdada de outro processo (hot upgrade)
+ *
+ * Repõe o estado escrito por conn_checkpoint; as mensagens por enviar
+ * seguem no próximo conn_flush_all.
+ *
+ * @return A ligação criada, ou NULL em caso de erro
+ */
+conn_t *conn_restore(ckpt_t *ck, int fd);
+
+#endif //CONN_H
@@ -0,0 +1,234 @@
+#include "dev.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "msg.h"
+
+static dev_config_t config;
+static io_dev_t *devices = NULL;
+
+static const char *DEV_SCHED_NAMES[] = {"FIFO", "SSTF", "SCAN"};
+
+int dev_sched_from_name(const char *name, dev_sched_en *out) {
+    for (int i = 0; i <= DEV_SCAN; i++) {
+        if (!strcasecmp(name, DEV_SCHED_NAMES[i])) {
+            *out = (dev_sched_en)i;
+            return 0;
+        }
+    }
+    // Nome alternativo usado nos livros
+    if (!strcasecmp(name, "ELEVATOR")) {
+        *out = DEV_SCAN;
+        return 0;
+    }
+    return -1;
+}
+
+const char *dev_sched_name(dev_sched_en sched) {
+    return DEV_SCHED_NAMES[sched];
+}
+
+int dev_init(const dev_config_t *cfg) {
+    config = *cfg;
+    if (config.count == 0) return 0;
+
+    devices = calloc(config.count, sizeof(io_dev_t));
+    if (!devices) return -1;
+    for (uint32_t i = 0; i < config.count; i++) devices[i].direction = 1;
+    return 0;
+}
+
+void dev_shutdown(void) {
+    for (uint32_t i = 0; devices && i < config.count; i++) {
+        while (devices[i].queue.head) free_pcb(dequeue_pcb(&devices[i].queue));
+        free_pcb(devices[i].current);
+    }
+    free(devices);
+    devices = NULL;
+    config.count = 0;
+}
+
+uint32_t dev_count(void) {
+    return config.count;
+}
+
+const io_dev_t *dev_get(uint32_t i) {
+    return i < config.count ? &devices[i] : NULL;
+}
+
+// Endereço do bloco de um pedido (sem páginas não há deslocação da cabeça)
+static uint32_t block_address(const pcb_t *p, const io_dev_t *d) {
+    return p->cold->pages.count > 0 ? p->cold->pages.ids[0] : d->head;
+}
+
+static uint32_t distance(uint32_t a, uint32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+void dev_submit(pcb_t *p, uint32_t now_ms) {
+    (void)now_ms;
+
+    // Dispositivo com menos pedidos (em fila ou em serviço)
+    io_dev_t *best = &devices[0];
+    uint32_t best_load = UINT32_MAX;
+    for (uint32_t i = 0; i < config.count; i++) {
+        uint32_t load = devices[i].queue.count + (devices[i].current ? 1 : 0);
+        if (load < best_load) {
+            best = &devices[i];
+            best_load = load;
+        }
+    }
+    enqueue_pcb(&best->queue, p);
+    if (best->queue.count > best->peak_queue) best->peak_queue = best->queue.count;
+}
+
+// Escolhe o próximo pedido da fila segundo a disciplina configurada
+static queue_elem_t *pick_next(io_dev_t *d) {
+    queue_elem_t *best = d->queue.head;
+    if (config.sched == DEV_FIFO || !best) return best;
+
+    if (config.sched == DEV_SSTF) {
+        uint32_t best_dist = UINT32_MAX;
+        for (queue_elem_t *it = d->queue.head; it; it = it->next) {
+            uint32_t dist = distance(block_address(it->pcb, d), d->head);
+            if (dist < best_dist) {
+                best = it;
+                best_dist = dist;
+            }
+        }
+        return best;
+    }
+
+    // SCAN: o pedido mais próximo no sentido atual; se não houver, inverte
+    for (int pass = 0; pass < 2; pass++) {
+        best = NULL;
+        uint32_t best_dist = UINT32_MAX;
+        for (queue_elem_t *it = d->queue.head; it; it = it->next) {
+            uint32_t addr = block_address(it->pcb, d);
+            int ahead = d->direction > 0 ? addr >= d->head : addr <= d->head;
+            uint32_t dist = distance(addr, d->head);
+            if (ahead && dist < best_dist) {
+                best = it;
+                best_dist = dist;
+            }
+        }
+        if (best) return best;
+        d->direction = (int8_t)-d->direction;
+    }
+    return d->queue.head;
+}
+
+// Começa a servir o próximo pedido; devolve 0 se a fila estiver vazia
+static int start_next(io_dev_t *d, uint32_t now_ms) {
+    queue_elem_t *elem = pick_next(d);
+    if (!elem) return 0;
+    remove_queue_elem(&d->queue, elem);
+    pcb_t *p = elem->pcb;
+
+    uint32_t wait = now_ms - p->cold->last_update_time_ms;
+    d->wait_ms += wait;
+    if (wait > d->max_wait_ms) d->max_wait_ms = wait;
+
+    uint32_t addr = block_address(p, d);
+    uint32_t seek = distance(addr, d->head);
+    d->seek_blocks += seek;
+    d->head = addr;
+
+    d->current = p;
+    d->remaining_ms = p->time_ms + seek * config.seek_ms;
+    return 1;
+}
+
+void dev_tick(uint32_t now_ms, queue_t *done) {
+    for (uint32_t i = 0; i < config.count; i++) {
+        io_dev_t *d = &devices[i];
+
+        // Um tick de serviço; o que sobrar de um pedido que termina passa ao seguinte
+        uint32_t budget = TICKS_MS;
+        while (budget > 0 || (d->current && d->remaining_ms == 0)) {
+            if (!d->current && !start_next(d, now_ms)) break;
+
+            uint32_t used = d->remaining_ms < budget ? d->remaining_ms : budget;
+            d->remaining_ms -= used;
+            d->busy_ms += used;
+            budget -= used;
+            if (d->remaining_ms == 0) {
+                enqueue_pcb(done, d->current);
+                d->current = NULL;
+                d->requests++;
+            }
+        }
+    }
+}
+
+uint32_t dev_pending(void) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < config.count; i++) {
+        n += devices[i].queue.count + (devices[i].current ? 1 : 0);
+    }
+    return n;
+}
+
+uint32_t dev_cancel_sockfd(uint32_t sockfd) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < config.count; i++) {
+        io_dev_t *d = &devices[i];
+        n += remove_pcbs_by_sockfd(&d->queue, sockfd);
+        // O pedido em serviço é abandonado; o dispositivo fica livre
+        if (d->current && d->current->cold->sockfd == sockfd) {
+            free_pcb(d->current);
+            d->current = NULL;
+            d->remaining_ms = 0;
+            n++;
+        }
+    }
+    return n;
+}
+
+void dev_print_stats(FILE *out, uint32_t now_ms) {
+    if (config.count == 0) return;
+    fprintf(out, "I/O devices (%u, %s, %u ms per block of seek):\n",
+            config.count, dev_sched_name(config.sched), config.seek_ms);
+    for (uint32_t i = 0; i < config.count; i++) {
+        const io_dev_t *d = &devices[i];
+        double util = now_ms ? 100.0 * (double)d->busy_ms / (double)now_ms : 0.0;
+        double avg_wait = d->requests ? (double)d->wait_ms / (double)d->requests : 0.0;
+        fprintf(out, "  dev%-2u %6llu requests, %6.2f%% busy, wait avg %8.1f ms max %6u ms, "
+                     "seek %llu blocks, peak queue %u\n",
+                i, (unsigned long long)d->requests, util, avg_wait, d->max_wait_ms,
+                (unsigned long long)d->seek_blocks, d->peak_queue);
+    }
+}
+
+void dev_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &config, sizeof(config));
+    for (uint32_t i = 0; i < config.count; i++) {
+        // Os ponteiros são escritos a NULL, para o mesmo estado dar sempre o mesmo ficheiro
+        io_dev_t d;
+        memcpy(&d, &devices[i], sizeof(d));
+        d.queue.head = d.queue.tail = NULL;
+        d.current = NULL;
+        ckpt_put(c, &d, sizeof(d));
+        ckpt_put_queue(c, &devices[i].queue);
+        ckpt_put_pcb(c, devices[i].current);
+    }
+}
+
+int dev_restore(ckpt_t *c) {
+    dev_config_t cfg;
+    ckpt_get(c, &cfg, sizeof(cfg));
+    dev_shutdown();
+    if (c->error || cfg.sched > DEV_SCAN || dev_init(&cfg) < 0) return -1;
+
+    for (uint32_t i = 0; i < config.count && !c->error; i++) {
+        io_dev_t *d = &devices[i];
+        ckpt_get(c, d, sizeof(io_dev_t));
+        d->queue = (queue_t){.head = NULL, .tail = NULL, .count = 0};
+        d->current = NULL;
+        ckpt_get_queue(c, &d->queue);
+        d->current = ckpt_get_pcb(c);
+    }
+    return c->error ? -1 : 0;
+}
@@ -0,0 +1,110 @@
+#ifndef DEV_H
+#define DEV_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "queue.h"
+#include "ckpt.h"
+
+/*
+ * Dispositivos de I/O simulados.
+ *
+ * Sem dispositivos (count = 0) cada BLOCK é servido em paralelo com todos os
+ * outros, como se houvesse um dispositivo por pedido. Com N dispositivos,
+ * cada pedido entra na fila do dispositivo com menos trabalho e só começa a
+ * ser servido quando este fica livre; o endereço do bloco é a primeira
+ * página do burst, e cada bloco de distância à cabeça custa seek_ms.
+ */
+typedef enum {
+    DEV_FIFO = 0,       // por ordem de chegada
+    DEV_SSTF,           // menor distância à cabeça (shortest seek time first)
+    DEV_SCAN            // elevador: continua no mesmo sentido enquanto houver pedidos
+} dev_sched_en;
+
+typedef struct {
+    uint32_t count;             // Número de dispositivos (0 = sem filas)
+    dev_sched_en sched;         // Disciplina de serviço de cada fila
+    uint32_t seek_ms;           // Custo por bloco de distância entre pedidos
+} dev_config_t;
+
+typedef struct {
+    queue_t queue;              // pedidos à espera
+    pcb_t *current;             // pedido em serviço (NULL = livre)
+    uint32_t remaining_ms;      // serviço que falta ao pedido atual
+    uint32_t head;              // endereço do último bloco servido
+    int8_t direction;           // SCAN: +1 a subir, -1 a descer
+
+    uint64_t requests;          // pedidos concluídos
+    uint64_t busy_ms;           // tempo em serviço
+    uint64_t wait_ms;           // soma das esperas na fila
+    uint32_t max_wait_ms;
+    uint64_t seek_blocks;       // distância total percorrida pela cabeça
+    uint32_t peak_queue;
+} io_dev_t;
+
+int dev_sched_from_name(const char *name, dev_sched_en *out);
+
+const char *dev_sched_name(dev_sched_en sched);
+
+/**
+ * @brief Cria os dispositivos
+ *
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+int dev_init(const dev_config_t *cfg);
+
+void dev_shutdown(void);
+
+/**
+ * @brief Número de dispositivos (0 = I/O sem filas)
+ */
+uint32_t dev_count(void);
+
+const io_dev_t *dev_get(uint32_t i);
+
+/**
+ * @brief Coloca um pedido de I/O na fila de um dispositivo
+ *
+ * p->time_ms é o tempo de transferência; p->last_update_time_ms deve ser o
+ * instante de chegada (usado para medir a espera na fila).
+ */
+void dev_submit(pcb_t *p, uint32_t now_ms);
+
+/**
+ * @brief Avança os dispositivos um tick
+ *
+ * Os pedidos concluídos são movidos para done (por ordem de conclusão).
+ */
+void dev_tick(uint32_t now_ms, queue_t *done);
+
+/**
+ * @brief Número de pedidos em fila ou em serviço
+ */
+uint32_t dev_pending(void);
+
+/**
+ * @brief Remove e liberta os pedidos de um cliente que se desligou
+ *
+ * @return O número de pedidos removidos
+ */
+uint32_t dev_cancel_sockfd(uint32_t sockfd);
+
+/**
+ * @brief Imprime a utilização e a espera média de cada dispositivo
+ */
+void dev_print_stats(FILE *out, uint32_t now_ms);
+
+/**
+ * @brief Escreve a configuração e o estado de cada dispositivo (filas incluídas)
+ */
+void dev_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui os dispositivos atuais pelos de um checkpoint
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int dev_restore(ckpt_t *c);
+
+#endif //DEV_H
@@ -2,7 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "msg.h"
-#include <unistd.h>
+#include "trace.h"
+#include "stats.h"
+#include "conn.h"
 
 /**
  * Algoritmo de escalonamento FIFO (First-In-First-Out)
@@ -39,12 +41,13 @@ void fifo_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
             };
 
             // Envia a mensagem pelo socket associado ao processo
-            if (write((*cpu_task)->sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-                perror("write");
-            }
+            TRACE(TRACE_DONE, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.bursts_done++;
+            conn_notify((*cpu_task)->cold->sockfd, &msg);
+            TRACE(TRACE_MSG_OUT, (*cpu_task)->pid, current_time_ms, PROCESS_REQUEST_DONE);
 
             // Liberta a memória usada pelo processo (já terminou)
-            free((*cpu_task));
+            free_pcb(*cpu_task);
 
             // Indica que o CPU está livre novamente
             (*cpu_task) = NULL;
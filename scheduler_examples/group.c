@@ -0,0 +1,505 @@
+#include "group.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "msg.h"
+#include "trace.h"
+#include "stats.h"
+
+#define MIN_CAPACITY 16
+#define VTIME_SCALE  (1u << 16)     // tempo virtual de um ms de CPU com peso 1
+
+typedef struct {
+    group_stats_t stats;
+    uint64_t vruntime;          // tempo de CPU / peso, em VTIME_SCALE por ms
+    queue_t rq;                 // prontos do grupo: a ready queue da política
+    pcb_t *parked;              // processo tirado do CPU por outro grupo
+    uint32_t parked_ms;
+    int32_t heap_pos;           // -1 se o grupo não estiver no heap
+    int active;                 // tem prontos ou está no CPU
+    double share_mark;          // share_clock quando ficou ativo
+} group_t;
+
+static _Thread_local group_config_t config;
+static _Thread_local group_t *groups = NULL;        // pela ordem em que apareceram
+static _Thread_local uint32_t ngroups = 0;
+static _Thread_local uint32_t capacity = 0;
+static _Thread_local uint32_t *slots = NULL;        // id -> índice + 1 (0 = livre), endereçamento aberto
+static _Thread_local uint32_t slot_mask = 0;
+static _Thread_local uint32_t *heap = NULL;         // grupos com prontos que não estão no CPU
+static _Thread_local uint32_t heap_len = 0;
+static _Thread_local int32_t running = -1;          // grupo do processo no CPU
+static _Thread_local uint32_t slice_start_ms = 0;   // quando o grupo no CPU o ganhou
+static _Thread_local uint64_t min_vruntime = 0;     // menor tempo virtual dos grupos ativos (só sobe)
+static _Thread_local uint32_t active_groups = 0;
+static _Thread_local uint64_t active_weight = 0;
+static _Thread_local double share_clock = 0.0;      // ms devidos por unidade de peso, nos ticks disputados
+
+// Hash multiplicativo (Fibonacci), como na tabela de processos
+static uint32_t slot_of(uint32_t id) {
+    return (id * 2654435769u) & slot_mask;
+}
+
+static int32_t index_of(const group_t *g) {
+    return (int32_t)(g - groups);
+}
+
+static int runnable(const group_t *g) {
+    return g->rq.count > 0 || g->parked != NULL;
+}
+
+static group_t *find(uint32_t id) {
+    if (!slots) return NULL;
+    for (uint32_t i = slot_of(id); slots[i]; i = (i + 1) & slot_mask) {
+        if (groups[slots[i] - 1].stats.id == id) return &groups[slots[i] - 1];
+    }
+    return NULL;
+}
+
+// Os grupos e o heap crescem juntos (cada grupo está no heap no máximo uma vez)
+static int grow(void) {
+    uint32_t cap = capacity ? capacity * 2 : MIN_CAPACITY;
+    group_t *g = realloc(groups, cap * sizeof(group_t));
+    if (!g) return -1;
+    groups = g;
+    uint32_t *h = realloc(heap, cap * sizeof(uint32_t));
+    if (!h) return -1;
+    heap = h;
+    uint32_t *s = calloc((size_t)cap * 2, sizeof(uint32_t));
+    if (!s) return -1;
+    free(slots);
+    slots = s;
+    slot_mask = cap * 2 - 1;
+    capacity = cap;
+    for (uint32_t i = 0; i < ngroups; i++) {
+        uint32_t j = slot_of(groups[i].stats.id);
+        while (slots[j]) j = (j + 1) & slot_mask;
+        slots[j] = i + 1;
+    }
+    return 0;
+}
+
+// Grupo de um id, criado (com o peso por omissão) se ainda não existir
+static group_t *group_get(uint32_t id) {
+    group_t *g = find(id);
+    if (g) return g;
+    if (ngroups == capacity && grow() < 0) return NULL;
+
+    g = &groups[ngroups];
+    memset(g, 0, sizeof(*g));
+    g->stats.id = id;
+    g->stats.weight = GROUP_WEIGHT_DEFAULT;
+    g->vruntime = min_vruntime;
+    g->heap_pos = -1;
+    uint32_t i = slot_of(id);
+    while (slots[i]) i = (i + 1) & slot_mask;
+    slots[i] = ++ngroups;
+    return g;
+}
+
+// ---------------------------------------------------------
+// Heap dos grupos prontos, pelo tempo virtual
+// ---------------------------------------------------------
+
+static int before(uint32_t a, uint32_t b) {
+    if (groups[a].vruntime != groups[b].vruntime) return groups[a].vruntime < groups[b].vruntime;
+    return a < b;   // empate: o grupo mais antigo
+}
+
+static void heap_set(uint32_t pos, uint32_t idx) {
+    heap[pos] = idx;
+    groups[idx].heap_pos = (int32_t)pos;
+}
+
+static void sift_up(uint32_t pos) {
+    uint32_t idx = heap[pos];
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 2;
+        if (!before(idx, heap[parent])) break;
+        heap_set(pos, heap[parent]);
+        pos = parent;
+    }
+    heap_set(pos, idx);
+}
+
+static void sift_down(uint32_t pos) {
+    uint32_t idx = heap[pos];
+    while (1) {
+        uint32_t child = 2 * pos + 1;
+        if (child >= heap_len) break;
+        if (child + 1 < heap_len && before(heap[child + 1], heap[child])) child++;
+        if (!before(heap[child], idx)) break;
+        heap_set(pos, heap[child]);
+        pos = child;
+    }
+    heap_set(pos, idx);
+}
+
+static void heap_remove(group_t *g) {
+    uint32_t pos = (uint32_t)g->heap_pos;
+    g->heap_pos = -1;
+    uint32_t last = heap[--heap_len];
+    if (pos == heap_len) return;
+    heap_set(pos, last);
+    sift_down(pos);
+    sift_up((uint32_t)groups[last].heap_pos);
+}
+
+// Um grupo ativo ganha share_clock × peso; ao ficar inativo a parte fica em owed_ms
+static void set_active(group_t *g, int on) {
+    if (g->active == on) return;
+    g->active = on;
+    if (on) {
+        g->share_mark = share_clock;
+        active_groups++;
+        active_weight += g->stats.weight;
+    } else {
+        g->stats.owed_ms += (share_clock - g->share_mark) * g->stats.weight;
+        active_groups--;
+        active_weight -= g->stats.weight;
+    }
+}
+
+// Põe no heap um grupo que não está no CPU. Um grupo que esteve parado não
+// traz crédito: recomeça no menor tempo virtual dos grupos ativos
+static void wake(group_t *g) {
+    if (g->heap_pos >= 0 || index_of(g) == running) return;
+    if (g->vruntime < min_vruntime) g->vruntime = min_vruntime;
+    heap[heap_len] = (uint32_t)index_of(g);
+    sift_up(heap_len++);
+    set_active(g, 1);
+}
+
+// ---------------------------------------------------------
+// Configuração
+// ---------------------------------------------------------
+
+// Apaga os grupos, libertando os PCBs que ainda estejam nas filas
+static void reset_groups(void) {
+    for (uint32_t i = 0; i < ngroups; i++) {
+        while (groups[i].rq.head) free_pcb(dequeue_pcb(&groups[i].rq));
+        free_pcb(groups[i].parked);
+    }
+    ngroups = 0;
+    heap_len = 0;
+    running = -1;
+    slice_start_ms = 0;
+    min_vruntime = 0;
+    active_groups = 0;
+    active_weight = 0;
+    share_clock = 0.0;
+    if (slots) memset(slots, 0, (size_t)(slot_mask + 1) * sizeof(uint32_t));
+}
+
+int group_init(const group_config_t *cfg) {
+    group_shutdown();
+    config = *cfg;
+    return grow();
+}
+
+void group_shutdown(void) {
+    reset_groups();
+    free(groups);
+    free(heap);
+    free(slots);
+    groups = NULL;
+    heap = NULL;
+    slots = NULL;
+    capacity = 0;
+    slot_mask = 0;
+    memset(&config, 0, sizeof(config));
+}
+
+int group_enabled(void) {
+    return config.policy != NULL;
+}
+
+int group_set_weights(const char *list) {
+    const char *s = list;
+    while (*s) {
+        const char *colon = strchr(s, ':');
+        if (!colon || colon == s) return -1;
+        char *endptr;
+        unsigned long w = strtoul(colon + 1, &endptr, 10);
+        if (endptr == colon + 1 || (*endptr != ',' && *endptr != '\0') || w == 0 || w > GROUP_WEIGHT_MAX) {
+            return -1;
+        }
+
+        char name[MSG_GROUP_CHARS + 1] = {0};
+        size_t len = (size_t)(colon - s);
+        memcpy(name, s, len < MSG_GROUP_CHARS ? len : MSG_GROUP_CHARS);
+        group_t *g = group_get(msg_group_from_name(name));
+        if (!g) return -1;
+        g->stats.weight = (uint32_t)w;
+
+        s = *endptr ? endptr + 1 : endptr;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------
+// Escalonador
+// ---------------------------------------------------------
+
+void group_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
+    // 0) O tick que passou: se estava disputado, conta para a parte de cada grupo
+    if (running >= 0 && *cpu_task && active_groups > 1) {
+        share_clock += (double)TICKS_MS / (double)active_weight;
+        groups[running].stats.contended_ms += TICKS_MS;
+    }
+
+    // 1) Chegadas: cada processo vai para a fila do seu grupo
+    pcb_t *p;
+    while ((p = dequeue_pcb(rq)) != NULL) {
+        group_t *g = group_get(p->cold->group);
+        if (!g) {
+            enqueue_pcb(rq, p);     // sem memória: fica na fila até ao próximo tick
+            break;
+        }
+        enqueue_pcb(&g->rq, p);
+        wake(g);
+    }
+
+    // 2) O grupo no CPU paga o tick na proporção inversa do peso, e a sua
+    //    política avança sobre a fila do grupo
+    pcb_t *prev = *cpu_task;
+    if (*cpu_task) {
+        group_t *g = group_get((*cpu_task)->cold->group);
+        if (!g) {
+            config.policy(current_time_ms, rq, cpu_task);
+            return;
+        }
+        if (index_of(g) != running) {
+            // O processo no CPU veio de um checkpoint ou de um hot upgrade
+            if (g->heap_pos >= 0) heap_remove(g);
+            running = index_of(g);
+            slice_start_ms = current_time_ms;
+            set_active(g, 1);
+        }
+        g->stats.cpu_ms += TICKS_MS;
+        g->vruntime += (uint64_t)TICKS_MS * VTIME_SCALE / g->stats.weight;
+        config.policy(current_time_ms, &g->rq, cpu_task);
+        if (!*cpu_task) {
+            running = -1;
+            if (runnable(g)) wake(g);
+            else set_active(g, 0);
+        }
+    } else if (running >= 0) {
+        // O processo no CPU foi cancelado (o cliente desligou-se)
+        group_t *g = &groups[running];
+        running = -1;
+        if (runnable(g)) wake(g);
+        else set_active(g, 0);
+    }
+
+    // 3) Passado o slice, o grupo cede o CPU a um grupo que esteja atrás
+    //    dele; o processo fica guardado e é o primeiro quando o grupo voltar
+    if (*cpu_task && heap_len > 0 && current_time_ms - slice_start_ms >= config.slice_ms) {
+        group_t *g = &groups[running];
+        if (groups[heap[0]].vruntime < g->vruntime) {
+            g->parked = *cpu_task;
+            g->parked_ms = current_time_ms;
+            *cpu_task = NULL;
+            running = -1;
+            if (g->parked == prev) {
+                g->stats.preemptions++;
+                g_stats.preemptions++;
+                TRACE(TRACE_PREEMPT, prev->pid, current_time_ms, 0);
+            }
+            wake(g);
+        }
+    }
+
+    // 4) CPU livre: o grupo com menor tempo virtual escolhe o processo
+    if (!*cpu_task && heap_len > 0) {
+        group_t *g = &groups[heap[0]];
+        heap_remove(g);
+        if (g->parked) {
+            *cpu_task = g->parked;
+            g->parked = NULL;
+            (*cpu_task)->slice_start_ms += current_time_ms - g->parked_ms;  // o quantum continua
+        } else {
+            config.policy(current_time_ms, &g->rq, cpu_task);
+        }
+        if (*cpu_task) {
+            running = index_of(g);
+            slice_start_ms = current_time_ms;
+            g->stats.dispatches++;
+        } else {
+            wake(g);    // a política ainda não quis escolher (p.ex. o atraso inicial do SJF)
+        }
+    }
+
+    // 5) O menor tempo virtual dos grupos ativos só avança
+    uint64_t v = UINT64_MAX;
+    if (running >= 0) v = groups[running].vruntime;
+    if (heap_len > 0 && groups[heap[0]].vruntime < v) v = groups[heap[0]].vruntime;
+    if (v != UINT64_MAX && v > min_vruntime) min_vruntime = v;
+}
+
+uint32_t group_ready_count(void) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ngroups; i++) n += groups[i].rq.count + (groups[i].parked != NULL);
+    return n;
+}
+
+uint32_t group_cancel_sockfd(uint32_t sockfd) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ngroups; i++) {
+        group_t *g = &groups[i];
+        n += remove_pcbs_by_sockfd(&g->rq, sockfd);
+        if (g->parked && g->parked->cold->sockfd == sockfd) {
+            free_pcb(g->parked);
+            g->parked = NULL;
+            n++;
+        }
+        if (g->heap_pos >= 0 && !runnable(g)) {
+            heap_remove(g);
+            set_active(g, 0);
+        }
+    }
+    return n;
+}
+
+// ---------------------------------------------------------
+// Estatísticas e checkpoint
+// ---------------------------------------------------------
+
+uint32_t group_num(void) {
+    return ngroups;
+}
+
+void group_settle_shares(void) {
+    // Os grupos ainda ativos levam para owed_ms a parte que ganharam até agora
+    for (uint32_t i = 0; i < ngroups; i++) {
+        group_t *g = &groups[i];
+        if (!g->active) continue;
+        g->stats.owed_ms += (share_clock - g->share_mark) * g->stats.weight;
+        g->share_mark = share_clock;
+    }
+}
+
+const group_stats_t *group_stats_at(uint32_t i) {
+    return i < ngroups ? &groups[i].stats : NULL;
+}
+
+void group_print_stats(FILE *out) {
+    if (!group_enabled() || ngroups == 0) return;
+
+    uint64_t cpu_ms = 0, contended_ms = 0;
+    double owed_ms = 0.0;
+    for (uint32_t i = 0; i < ngroups; i++) {
+        const group_stats_t *s = &groups[i].stats;
+        cpu_ms += s->cpu_ms;
+        contended_ms += s->contended_ms;
+        owed_ms += s->owed_ms;
+    }
+
+    fprintf(out, "Fair share (%s within groups, %u ms group slice): %u groups, %llu ms of CPU, "
+                 "%llu ms with more than one group ready\n",
+            config.policy_name, config.slice_ms, ngroups,
+            (unsigned long long)cpu_ms, (unsigned long long)contended_ms);
+    fprintf(out, "  %-6s %6s %10s %12s %7s %9s %10s %11s\n",
+            "group", "weight", "cpu ms", "contended ms", "share%", "by weight%", "dispatches", "preemptions");
+    for (uint32_t i = 0; i < ngroups; i++) {
+        const group_stats_t *s = &groups[i].stats;
+        char name[MSG_GROUP_CHARS + 1];
+        msg_group_name(s->id, name);
+        fprintf(out, "  %-6s %6u %10llu %12llu %7.1f %9.1f %10llu %11llu\n",
+                name, s->weight, (unsigned long long)s->cpu_ms, (unsigned long long)s->contended_ms,
+                contended_ms ? 100.0 * (double)s->contended_ms / (double)contended_ms : 0.0,
+                owed_ms > 0.0 ? 100.0 * s->owed_ms / owed_ms : 0.0,
+                (unsigned long long)s->dispatches, (unsigned long long)s->preemptions);
+    }
+}
+
+// O checkpoint leva o estado completo dos dois níveis (filas, processo
+// guardado, grupo no CPU, heap e relógio de partilha) sem mexer nele: um
+// checkpoint periódico não pode mudar o escalonamento da simulação
+void group_checkpoint(ckpt_t *c) {
+    uint8_t enabled = group_enabled() != 0;
+    ckpt_put(c, &enabled, sizeof(enabled));
+    if (!enabled) return;
+    ckpt_put(c, &min_vruntime, sizeof(min_vruntime));
+    ckpt_put(c, &share_clock, sizeof(share_clock));
+    ckpt_put(c, &running, sizeof(running));
+    ckpt_put(c, &slice_start_ms, sizeof(slice_start_ms));
+    ckpt_put(c, &ngroups, sizeof(ngroups));
+    for (uint32_t i = 0; i < ngroups; i++) {
+        const group_t *g = &groups[i];
+        uint8_t active = g->active != 0;
+        uint8_t queued = g->heap_pos >= 0;
+        ckpt_put(c, &g->stats, sizeof(group_stats_t));
+        ckpt_put(c, &g->vruntime, sizeof(uint64_t));
+        ckpt_put(c, &active, sizeof(active));
+        ckpt_put(c, &g->share_mark, sizeof(g->share_mark));
+        ckpt_put(c, &queued, sizeof(queued));
+        ckpt_put_queue(c, &g->rq);
+        ckpt_put_pcb(c, g->parked);
+        ckpt_put(c, &g->parked_ms, sizeof(g->parked_ms));
+    }
+}
+
+int group_restore(ckpt_t *c) {
+    uint8_t enabled;
+    ckpt_get(c, &enabled, sizeof(enabled));
+    if (c->error) return -1;
+    if (enabled != (group_enabled() != 0)) {
+        fprintf(stderr, "The checkpoint was taken %s --fair-share\n", enabled ? "with" : "without");
+        return -1;
+    }
+    if (!enabled) return 0;
+
+    uint64_t min_v;
+    double clock;
+    int32_t run;
+    uint32_t slice_start, n;
+    ckpt_get(c, &min_v, sizeof(min_v));
+    ckpt_get(c, &clock, sizeof(clock));
+    ckpt_get(c, &run, sizeof(run));
+    ckpt_get(c, &slice_start, sizeof(slice_start));
+    ckpt_get(c, &n, sizeof(n));
+    if (c->error || run < -1 || (run >= 0 && (uint32_t)run >= n)) return -1;
+
+    reset_groups();
+    min_vruntime = min_v;
+    share_clock = clock;
+    running = run;
+    slice_start_ms = slice_start;
+    for (uint32_t i = 0; i < n; i++) {
+        group_stats_t st;
+        uint64_t v;
+        uint8_t active, queued;
+        double mark;
+        ckpt_get(c, &st, sizeof(st));
+        ckpt_get(c, &v, sizeof(v));
+        ckpt_get(c, &active, sizeof(active));
+        ckpt_get(c, &mark, sizeof(mark));
+        ckpt_get(c, &queued, sizeof(queued));
+        if (c->error || st.weight == 0 || find(st.id)) return -1;
+        group_t *g = group_get(st.id);
+        if (!g) return -1;
+        g->stats = st;
+        g->vruntime = v;
+        ckpt_get_queue(c, &g->rq);
+        g->parked = ckpt_get_pcb(c);
+        ckpt_get(c, &g->parked_ms, sizeof(g->parked_ms));
+        if (c->error) return -1;
+
+        if (active) {
+            g->active = 1;
+            g->share_mark = mark;
+            active_groups++;
+            active_weight += g->stats.weight;
+        }
+        // O heap é refeito: a ordem (tempo virtual, índice) é total, pelo
+        // que o topo é o mesmo do processo original
+        if (queued) {
+            if (!runnable(g) || (int32_t)i == running) return -1;
+            heap[heap_len] = i;
+            sift_up(heap_len++);
+        }
+    }
+    return 0;
+}
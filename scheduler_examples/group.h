@@ -0,0 +1,145 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "queue.h"
+#include "ckpt.h"
+
+/*
+ * Escalonamento em dois níveis por grupos (fair share). Cada aplicação
+ * envia o seu grupo (msg_t.group, derivado do nome do ficheiro de bursts):
+ * o CPU é repartido primeiro entre grupos, na proporção dos pesos, e só
+ * depois entre os processos de cada grupo, por uma das políticas
+ * existentes (FIFO, SJF ou RR) a correr sobre a fila do grupo.
+ *
+ * Todos os grupos usam o mesmo estado da política (é o do módulo, não um
+ * por grupo). O quantum fixo do RR não depende dele, mas o adaptativo
+ * (último quantum e média dos bursts) misturava os grupos, pelo que não é
+ * aceite com fair share. A espera inicial do SJF é uma só para a simulação.
+ *
+ * Cada grupo tem um tempo virtual: o tempo de CPU que recebeu dividido
+ * pelo peso. Os grupos com processos prontos estão num heap ordenado pelo
+ * tempo virtual e o CPU vai para o do topo (O(log grupos)). O grupo no CPU
+ * só o perde depois de slice_ms, e só para um grupo que esteja atrás dele;
+ * o processo que estava a correr fica guardado no grupo e volta ao CPU,
+ * com o resto do seu quantum, quando o grupo for de novo escolhido, pelo
+ * que dentro do grupo a política se comporta como se estivesse sozinha.
+ *
+ * Um grupo que fica sem processos prontos não acumula crédito: ao voltar,
+ * o seu tempo virtual sobe até ao menor dos grupos ativos.
+ *
+ * A parte de cada grupo só é medida nos ticks em que mais de um grupo tem
+ * trabalho (contended_ms), e é comparada com a que os pesos dos grupos
+ * ativos lhe davam (owed_ms, acumulada por um relógio de partilha, sem
+ * percorrer os grupos em cada tick).
+ *
+ * O estado é _Thread_local, para o schedcmp ter um por simulação.
+ */
+
+#define GROUP_WEIGHT_DEFAULT 1
+#define GROUP_WEIGHT_MAX     1000
+
+typedef void (*group_policy_fn)(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+
+typedef struct {
+    group_policy_fn policy;     // escalonador dentro de cada grupo
+    const char *policy_name;
+    uint32_t slice_ms;          // tempo mínimo de um grupo no CPU antes de o poder perder
+} group_config_t;
+
+typedef struct {
+    uint32_t id;                // msg_group_from_name (0 = aplicações sem grupo)
+    uint32_t weight;
+    uint64_t cpu_ms;            // ticks passados no CPU
+    uint64_t contended_ms;      // CPU recebido enquanto outro grupo também tinha prontos
+    double owed_ms;             // o que os pesos lhe davam nesses ticks
+    uint64_t dispatches;        // vezes que o grupo ganhou o CPU
+    uint64_t preemptions;       // vezes que o perdeu para outro grupo a meio de um burst
+} group_stats_t;
+
+/**
+ * @brief Ativa o escalonamento por grupos na thread atual (apaga os grupos)
+ *
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+int group_init(const group_config_t *cfg);
+
+/**
+ * @brief Liberta os grupos (os PCBs que ainda estejam nas filas também)
+ */
+void group_shutdown(void);
+
+int group_enabled(void);
+
+/**
+ * @brief Define os pesos a partir de uma lista "A:2,B:1,..."
+ *
+ * Os nomes são convertidos com msg_group_from_name; os grupos que não
+ * aparecem têm peso GROUP_WEIGHT_DEFAULT.
+ *
+ * @return 0 em caso de sucesso, -1 se a lista for inválida
+ */
+int group_set_weights(const char *list);
+
+/**
+ * @brief Escalonador em dois níveis (mesma assinatura das políticas)
+ *
+ * As chegadas do tick são retiradas de rq e distribuídas pelas filas dos
+ * grupos; rq fica vazia.
+ */
+void group_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+
+/**
+ * @brief Processos prontos em todos os grupos (incluindo os guardados)
+ */
+uint32_t group_ready_count(void);
+
+/**
+ * @brief Cancela os processos de um cliente que se desligou
+ */
+uint32_t group_cancel_sockfd(uint32_t sockfd);
+
+uint32_t group_num(void);
+
+/**
+ * @brief Passa para owed_ms a parte que os grupos ativos ganharam até agora
+ *
+ * Tem de ser chamada uma vez antes de ler owed_ms (relatórios) e antes de
+ * um checkpoint; fora disso a parte dos grupos ativos fica por acumular.
+ */
+void group_settle_shares(void);
+
+/**
+ * @brief Contadores do i-ésimo grupo, pela ordem em que apareceram
+ *
+ * O owed_ms dos grupos ativos só está em dia depois de group_settle_shares.
+ */
+const group_stats_t *group_stats_at(uint32_t i);
+
+/**
+ * @brief Escreve a parte do CPU de cada grupo face à que lhe cabia pelo peso
+ *
+ * Chamar depois de group_settle_shares.
+ */
+void group_print_stats(FILE *out);
+
+/**
+ * @brief Escreve os grupos: pesos, tempos virtuais, filas, processo guardado
+ *        e grupo no CPU (sem alterar o estado)
+ */
+void group_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui os grupos pelos de um checkpoint
+ *
+ * Os pesos do checkpoint substituem os da linha de comandos; os processos
+ * voltam às filas dos seus grupos e o grupo no CPU mantém o resto do slice.
+ *
+ * @return 0 em caso de sucesso, -1 se o checkpoint estiver corrompido ou
+ *         tiver sido tirado com/sem fair share ao contrário deste processo
+ */
+int group_restore(ckpt_t *c);
+
+#endif // GROUP_H
@@ -0,0 +1,98 @@
+#include "hist.h"
+
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+void hist_reset(hist_t *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+// Limite superior (inclusive) dos valores que caem no intervalo idx
+static uint64_t bucket_upper(uint32_t idx) {
+    if (idx < HIST_SUB_BUCKETS) return idx;
+    uint32_t shift = idx / (HIST_SUB_BUCKETS / 2) - 1;
+    uint64_t sub = idx - shift * (HIST_SUB_BUCKETS / 2);
+    return ((sub + 1) << shift) - 1;
+}
+
+uint64_t hist_percentile(const hist_t *h, double p) {
+    if (h->total == 0) return 0;
+    uint64_t rank = (uint64_t)((p / 100.0) * (double)h->total + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > h->total) rank = h->total;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return upper > h->max ? h->max : upper;
+        }
+    }
+    return h->max;
+}
+
+void hist_print(FILE *out, const char *label, const hist_t *h) {
+    if (h->total == 0) return;
+    fprintf(out, "  %-18s n=%-9llu mean=%9.2f p50=%9.2f p90=%9.2f p99=%9.2f p99.9=%9.2f max=%9.2f us\n",
+            label, (unsigned long long)h->total,
+            (double)h->sum / (double)h->total / 1000.0,
+            (double)hist_percentile(h, 50.0) / 1000.0,
+            (double)hist_percentile(h, 90.0) / 1000.0,
+            (double)hist_percentile(h, 99.0) / 1000.0,
+            (double)hist_percentile(h, 99.9) / 1000.0,
+            (double)h->max / 1000.0);
+}
+
+// ---------------------------------------------------------
+// Relógio
+// ---------------------------------------------------------
+static int use_tsc = 0;
+static uint64_t tsc_mult = 0;       // ns por tick em ponto fixo 32.32
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void clock_calibrate(void) {
+#ifdef HAVE_TSC
+    // CPUID 0x80000007, EDX bit 8: TSC invariante
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) return;
+
+    const struct timespec pause = {.tv_sec = 0, .tv_nsec = 20 * 1000 * 1000};
+    uint64_t ns0 = monotonic_ns();
+    uint64_t t0 = __rdtsc();
+    nanosleep(&pause, NULL);
+    uint64_t ns1 = monotonic_ns();
+    uint64_t t1 = __rdtsc();
+    if (t1 <= t0 || ns1 <= ns0) return;
+
+    tsc_mult = ((ns1 - ns0) << 32) / (t1 - t0);
+    use_tsc = tsc_mult != 0;
+#endif
+}
+
+uint64_t clock_now_ticks(void) {
+#ifdef HAVE_TSC
+    if (use_tsc) return __rdtsc();
+#endif
+    return monotonic_ns();
+}
+
+uint64_t clock_ticks_to_ns(uint64_t ticks) {
+    if (!use_tsc) return ticks;
+    return (uint64_t)(((unsigned __int128)ticks * tsc_mult) >> 32);
+}
+
+const char *clock_source_name(void) {
+    return use_tsc ? "TSC" : "CLOCK_MONOTONIC";
+}
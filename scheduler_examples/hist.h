@@ -0,0 +1,66 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Histograma de latências no estilo HDR (log-linear): cada potência de 2
+ * é dividida em HIST_SUB_BUCKETS/2 intervalos iguais, o que dá um erro
+ * relativo de até 1/32 (~3%) para qualquer valor entre 1 ns e 2^64 ns,
+ * com um registo em O(1) (um clz e um shift).
+ */
+#define HIST_SUB_BITS    6
+#define HIST_SUB_BUCKETS (1u << HIST_SUB_BITS)
+#define HIST_BUCKETS     ((64 - HIST_SUB_BITS) * (HIST_SUB_BUCKETS / 2) + HIST_SUB_BUCKETS)
+
+typedef struct {
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint32_t counts[HIST_BUCKETS];
+} hist_t;
+
+static inline uint32_t hist_index(uint64_t v) {
+    if (v < HIST_SUB_BUCKETS) return (uint32_t)v;
+    uint32_t shift = (uint32_t)(63 - __builtin_clzll(v)) - (HIST_SUB_BITS - 1);
+    return shift * (HIST_SUB_BUCKETS / 2) + (uint32_t)(v >> shift);
+}
+
+static inline void hist_record(hist_t *h, uint64_t v) {
+    if (h->total == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->total++;
+    h->sum += v;
+    h->counts[hist_index(v)]++;
+}
+
+void hist_reset(hist_t *h);
+
+/**
+ * @brief Valor abaixo do qual fica a percentagem p (0..100) das amostras
+ *
+ * Devolve o limite superior do intervalo que contém o percentil.
+ */
+uint64_t hist_percentile(const hist_t *h, double p);
+
+/**
+ * @brief Imprime uma linha com contagem, média, percentis e máximo (em us)
+ */
+void hist_print(FILE *out, const char *label, const hist_t *h);
+
+/*
+ * Relógio monotónico barato para medir as fases do ciclo principal.
+ * Usa o TSC em x86 quando é invariante (frequência constante); caso
+ * contrário usa clock_gettime(CLOCK_MONOTONIC).
+ */
+void clock_calibrate(void);
+
+uint64_t clock_now_ticks(void);
+
+uint64_t clock_ticks_to_ns(uint64_t ticks);
+
+const char *clock_source_name(void);
+
+#endif //HIST_H
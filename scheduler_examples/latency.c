@@ -0,0 +1,33 @@
+#include "latency.h"
+
+static const char *PHASE_NAMES[LAT_PHASE_COUNT] = {
+    "check_new_commands",
+    "check_blocked",
+    "policy",
+    "memory",
+    "flush",
+    "tick"
+};
+
+static hist_t histograms[LAT_MAX_POLICIES][LAT_PHASE_COUNT];
+
+void latency_record(int policy, lat_phase_en phase, uint64_t ns) {
+    if (policy < 0 || policy >= LAT_MAX_POLICIES) return;
+    hist_record(&histograms[policy][phase], ns);
+}
+
+const hist_t *latency_hist(int policy, lat_phase_en phase) {
+    if (policy < 0 || policy >= LAT_MAX_POLICIES) return NULL;
+    return &histograms[policy][phase];
+}
+
+void latency_dump(FILE *out, const char *const *policy_names) {
+    for (int p = 0; p < LAT_MAX_POLICIES && policy_names[p]; p++) {
+        if (histograms[p][LAT_TICK].total == 0) continue;
+        fprintf(out, "Tick phase latency (%s, clock %s):\n", policy_names[p], clock_source_name());
+        for (int ph = 0; ph < LAT_PHASE_COUNT; ph++) {
+            hist_print(out, PHASE_NAMES[ph], &histograms[p][ph]);
+        }
+    }
+    fflush(out);
+}
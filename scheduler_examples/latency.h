@@ -0,0 +1,36 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "hist.h"
+
+#define LAT_MAX_POLICIES 8
+
+// Fases de cada tick do ciclo principal do ossim
+typedef enum {
+    LAT_COMMANDS = 0,   // check_new_commands (accept + leitura de pedidos + ACKs)
+    LAT_BLOCKED,        // check_blocked_queue
+    LAT_POLICY,         // função do escalonador ativo
+    LAT_MEMORY,         // page faults e tradução de endereços do processo em execução
+    LAT_FLUSH,          // envio das mensagens pendentes (ACK/DONE)
+    LAT_TICK,           // tick completo (sem o usleep)
+    LAT_PHASE_COUNT
+} lat_phase_en;
+
+/**
+ * @brief Regista a duração (em ns) de uma fase do tick para um escalonador
+ */
+void latency_record(int policy, lat_phase_en phase, uint64_t ns);
+
+const hist_t *latency_hist(int policy, lat_phase_en phase);
+
+/**
+ * @brief Imprime os histogramas de todas as fases, por escalonador
+ *
+ * @param policy_names Nomes dos escalonadores, indexados como em latency_record (terminado em NULL)
+ */
+void latency_dump(FILE *out, const char *const *policy_names);
+
+#endif //LATENCY_H
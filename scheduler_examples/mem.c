@@ -0,0 +1,283 @@
+#include "mem.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "debug.h"
+#include "vm.h"
+
+#define NO_FRAME (-1)
+
+/*
+ * Cada frame físico guarda a página (pid, página) que contém.
+ *
+ * - prev/next formam uma lista duplamente ligada por ordem de carregamento
+ *   (FIFO) ou de utilização (LRU). A cabeça é sempre a próxima vítima.
+ * - hnext encadeia os frames que caem no mesmo bucket da tabela de hash,
+ *   o que permite encontrar uma página em O(1) sem alocações extra.
+ * - referenced/last_use_ms são usados pelo Clock e pelo WSClock.
+ */
+typedef struct {
+    int32_t pid;
+    uint32_t page;
+    uint8_t referenced;
+    uint32_t last_use_ms;
+    int32_t prev;
+    int32_t next;
+    int32_t hnext;
+} frame_t;
+
+static mem_config_t config;
+static mem_stats_t stats;
+
+static frame_t *frames = NULL;
+static int32_t *buckets = NULL;     // bucket -> primeiro frame da cadeia
+static uint32_t bucket_mask = 0;
+
+static int32_t lru_head = NO_FRAME; // próxima vítima (FIFO/LRU)
+static int32_t lru_tail = NO_FRAME; // carregada/usada mais recentemente
+static uint32_t clock_hand = 0;     // ponteiro do Clock/WSClock
+static uint32_t used_frames = 0;    // frames livres são sempre [used_frames, frames)
+
+static const char *MEM_POLICY_NAMES[] = {"FIFO", "LRU", "CLOCK", "WSCLOCK"};
+
+int mem_policy_from_name(const char *name, mem_policy_en *out) {
+    for (int i = 0; i <= MEM_WSCLOCK; i++) {
+        if (!strcasecmp(name, MEM_POLICY_NAMES[i])) {
+            *out = (mem_policy_en)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *mem_policy_name(mem_policy_en policy) {
+    return MEM_POLICY_NAMES[policy];
+}
+
+// ---------------------------------------------------------
+// Tabela de hash (pid, página) -> frame
+// ---------------------------------------------------------
+static uint32_t hash_page(int32_t pid, uint32_t page) {
+    uint64_t key = ((uint64_t)(uint32_t)pid << 32) | page;
+    key *= 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(key >> 32) & bucket_mask;
+}
+
+static int32_t hash_find(int32_t pid, uint32_t page) {
+    for (int32_t f = buckets[hash_page(pid, page)]; f != NO_FRAME; f = frames[f].hnext) {
+        if (frames[f].pid == pid && frames[f].page == page) return f;
+    }
+    return NO_FRAME;
+}
+
+static void hash_insert(int32_t f) {
+    uint32_t b = hash_page(frames[f].pid, frames[f].page);
+    frames[f].hnext = buckets[b];
+    buckets[b] = f;
+}
+
+static void hash_remove(int32_t f) {
+    int32_t *link = &buckets[hash_page(frames[f].pid, frames[f].page)];
+    while (*link != NO_FRAME) {
+        if (*link == f) {
+            *link = frames[f].hnext;
+            return;
+        }
+        link = &frames[*link].hnext;
+    }
+}
+
+// ---------------------------------------------------------
+// Lista duplamente ligada (FIFO/LRU)
+// ---------------------------------------------------------
+static void list_unlink(int32_t f) {
+    if (frames[f].prev != NO_FRAME) frames[frames[f].prev].next = frames[f].next;
+    else lru_head = frames[f].next;
+    if (frames[f].next != NO_FRAME) frames[frames[f].next].prev = frames[f].prev;
+    else lru_tail = frames[f].prev;
+}
+
+static void list_push_tail(int32_t f) {
+    frames[f].prev = lru_tail;
+    frames[f].next = NO_FRAME;
+    if (lru_tail != NO_FRAME) frames[lru_tail].next = f;
+    else lru_head = f;
+    lru_tail = f;
+}
+
+// ---------------------------------------------------------
+// Escolha da vítima
+// ---------------------------------------------------------
+
+/*
+ * Clock: avança o ponteiro, dando uma segunda oportunidade às páginas
+ * referenciadas desde a última passagem.
+ */
+static int32_t clock_victim(void) {
+    while (1) {
+        frame_t *fr = &frames[clock_hand];
+        int32_t f = (int32_t)clock_hand;
+        clock_hand = (clock_hand + 1) % config.frames;
+        if (!fr->referenced) return f;
+        fr->referenced = 0;
+    }
+}
+
+/*
+ * WSClock: como o Clock, mas uma página não referenciada só é retirada se
+ * estiver fora do working set (idade > tau). Se uma volta completa não
+ * encontrar nenhuma, usa a página mais antiga vista pelo caminho.
+ */
+static int32_t wsclock_victim(uint32_t now_ms) {
+    int32_t oldest = NO_FRAME;
+    for (uint32_t scanned = 0; scanned < 2 * config.frames; scanned++) {
+        frame_t *fr = &frames[clock_hand];
+        int32_t f = (int32_t)clock_hand;
+        clock_hand = (clock_hand + 1) % config.frames;
+
+        if (fr->referenced) {
+            fr->referenced = 0;
+            fr->last_use_ms = now_ms;
+            continue;
+        }
+        if (now_ms - fr->last_use_ms > config.ws_tau_ms) return f;
+        if (oldest == NO_FRAME || fr->last_use_ms < frames[oldest].last_use_ms) oldest = f;
+    }
+    return oldest != NO_FRAME ? oldest : (int32_t)clock_hand;
+}
+
+static int32_t pick_victim(uint32_t now_ms) {
+    switch (config.policy) {
+        case MEM_FIFO:
+        case MEM_LRU:
+            return lru_head;
+        case MEM_CLOCK:
+            return clock_victim();
+        case MEM_WSCLOCK:
+            return wsclock_victim(now_ms);
+    }
+    return NO_FRAME;
+}
+
+// ---------------------------------------------------------
+// API pública
+// ---------------------------------------------------------
+int mem_init(const mem_config_t *cfg) {
+    mem_shutdown();
+    config = *cfg;
+    memset(&stats, 0, sizeof(stats));
+    if (config.frames == 0) return 0;
+
+    uint32_t nbuckets = 1;
+    while (nbuckets < 2 * config.frames) nbuckets <<= 1;
+
+    frames = calloc(config.frames, sizeof(frame_t));
+    buckets = malloc(nbuckets * sizeof(int32_t));
+    if (!frames || !buckets) {
+        mem_shutdown();
+        return -1;
+    }
+    for (uint32_t b = 0; b < nbuckets; b++) buckets[b] = NO_FRAME;
+    bucket_mask = nbuckets - 1;
+    return 0;
+}
+
+void mem_shutdown(void) {
+    free(frames);
+    free(buckets);
+    frames = NULL;
+    buckets = NULL;
+    lru_head = lru_tail = NO_FRAME;
+    clock_hand = 0;
+    used_frames = 0;
+}
+
+uint32_t mem_reference(int32_t pid, const page_info_t *pages, uint32_t now_ms) {
+    if (!frames || !pages) return 0;
+
+    uint32_t faults = 0;
+    for (uint32_t i = 0; i < pages->count && i < MAX_PAGES; i++) {
+        uint32_t page = pages->ids[i];
+        stats.references++;
+
+        int32_t f = hash_find(pid, page);
+        if (f != NO_FRAME) {
+            // Hit: atualiza a informação de utilização
+            frames[f].referenced = 1;
+            frames[f].last_use_ms = now_ms;
+            if (config.policy == MEM_LRU) {
+                list_unlink(f);
+                list_push_tail(f);
+            }
+            continue;
+        }
+
+        // Page fault: usa um frame livre ou retira uma vítima
+        faults++;
+        if (used_frames < config.frames) {
+            f = (int32_t)used_frames++;
+        } else {
+            f = pick_victim(now_ms);
+            DBG("Evicting page %u of pid %d from frame %d", frames[f].page, frames[f].pid, f);
+            hash_remove(f);
+            list_unlink(f);
+            vm_unmap(frames[f].pid, frames[f].page);
+            stats.evictions++;
+        }
+
+        frames[f].pid = pid;
+        frames[f].page = page;
+        frames[f].referenced = 1;
+        frames[f].last_use_ms = now_ms;
+        hash_insert(f);
+        list_push_tail(f);
+        vm_map(pid, page, f);
+    }
+
+    stats.faults += faults;
+    stats.fault_time_ms += (uint64_t)faults * config.fault_ms;
+    return faults * config.fault_ms;
+}
+
+const mem_stats_t *mem_get_stats(void) {
+    return &stats;
+}
+
+void mem_print_stats(FILE *out) {
+    if (!frames) return;
+    double fault_rate = stats.references ? 100.0 * (double)stats.faults / (double)stats.references : 0.0;
+    fprintf(out, "Memory (%s, %u frames): %llu references, %llu faults (%.2f%%), %llu evictions, %llu ms fault service\n",
+            mem_policy_name(config.policy), config.frames,
+            (unsigned long long)stats.references, (unsigned long long)stats.faults, fault_rate,
+            (unsigned long long)stats.evictions, (unsigned long long)stats.fault_time_ms);
+}
+
+void mem_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &config, sizeof(config));
+    ckpt_put(c, &stats, sizeof(stats));
+    if (!frames) return;
+    ckpt_put(c, frames, config.frames * sizeof(frame_t));
+    ckpt_put(c, buckets, (bucket_mask + 1) * sizeof(int32_t));
+    ckpt_put(c, &lru_head, sizeof(lru_head));
+    ckpt_put(c, &lru_tail, sizeof(lru_tail));
+    ckpt_put(c, &clock_hand, sizeof(clock_hand));
+    ckpt_put(c, &used_frames, sizeof(used_frames));
+}
+
+int mem_restore(ckpt_t *c) {
+    mem_config_t cfg;
+    ckpt_get(c, &cfg, sizeof(cfg));
+    if (c->error || cfg.policy > MEM_WSCLOCK || mem_init(&cfg) < 0) return -1;
+
+    ckpt_get(c, &stats, sizeof(stats));
+    if (!frames) return c->error ? -1 : 0;
+    ckpt_get(c, frames, config.frames * sizeof(frame_t));
+    ckpt_get(c, buckets, (bucket_mask + 1) * sizeof(int32_t));
+    ckpt_get(c, &lru_head, sizeof(lru_head));
+    ckpt_get(c, &lru_tail, sizeof(lru_tail));
+    ckpt_get(c, &clock_hand, sizeof(clock_hand));
+    ckpt_get(c, &used_frames, sizeof(used_frames));
+    return c->error ? -1 : 0;
+}
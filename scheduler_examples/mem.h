@@ -0,0 +1,86 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "msg.h"
+#include "ckpt.h"
+
+// Algoritmos de substituição de páginas suportados
+typedef enum {
+    MEM_FIFO = 0,
+    MEM_LRU,
+    MEM_CLOCK,
+    MEM_WSCLOCK
+} mem_policy_en;
+
+// Configuração do subsistema de memória
+typedef struct {
+    uint32_t frames;            // Número de frames físicos (0 desativa a simulação)
+    mem_policy_en policy;       // Algoritmo de substituição
+    uint32_t fault_ms;          // Tempo de serviço de cada page fault
+    uint32_t ws_tau_ms;         // Janela do working set (apenas WSClock)
+} mem_config_t;
+
+// Contadores globais do subsistema de memória
+typedef struct {
+    uint64_t references;        // Referências a páginas
+    uint64_t faults;            // Page faults
+    uint64_t evictions;         // Páginas retiradas de um frame ocupado
+    uint64_t fault_time_ms;     // Tempo total cobrado por page faults
+} mem_stats_t;
+
+/**
+ * @brief Converte o nome de um algoritmo (FIFO, LRU, CLOCK, WSCLOCK)
+ *
+ * @return 0 em caso de sucesso, -1 se o nome não for reconhecido
+ */
+int mem_policy_from_name(const char *name, mem_policy_en *out);
+
+const char *mem_policy_name(mem_policy_en policy);
+
+/**
+ * @brief Inicializa o conjunto de frames físicos
+ *
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+int mem_init(const mem_config_t *cfg);
+
+/**
+ * @brief Liberta as estruturas internas do subsistema de memória
+ */
+void mem_shutdown(void);
+
+/**
+ * @brief Referencia as páginas de um burst
+ *
+ * Cada página ausente provoca um page fault: é carregada num frame livre
+ * ou, se não houver, num frame escolhido pelo algoritmo de substituição.
+ *
+ * @param pid O processo dono das páginas
+ * @param pages As páginas referenciadas
+ * @param now_ms Tempo atual da simulação
+ * @return O tempo de serviço dos page faults (faults * fault_ms)
+ */
+uint32_t mem_reference(int32_t pid, const page_info_t *pages, uint32_t now_ms);
+
+const mem_stats_t *mem_get_stats(void);
+
+void mem_print_stats(FILE *out);
+
+/**
+ * @brief Escreve a configuração, os contadores e o conteúdo dos frames
+ */
+void mem_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui o estado atual pelo de um checkpoint
+ *
+ * A configuração do checkpoint prevalece sobre a da linha de comandos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int mem_restore(ckpt_t *c);
+
+#endif //MEM_H
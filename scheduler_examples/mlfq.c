@@ -1,6 +1,10 @@
 #include "queue.h"
 #include "msg.h"
-#include <unistd.h>
+#include "trace.h"
+#include "stats.h"
+#include "conn.h"
+#include "ckpt.h"
+#include "proc.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -12,8 +16,9 @@ typedef struct {
     queue_t queue;
 } mlfq_level_t;
 
-// Vetor de filas — nível 0 tem a maior prioridade
-static mlfq_level_t levels[NUM_QUEUES];
+// Vetor de filas — nível 0 tem a maior prioridade (uma simulação por thread)
+static _Thread_local mlfq_level_t levels[NUM_QUEUES];
+static _Thread_local uint32_t time_slice_ms = TIME_SLICE;
 
 /**
  * Inicializa as filas do MLFQ, garantindo que todas começam vazias.
@@ -22,24 +27,79 @@ void mlfq_init(void) {
     for (int i = 0; i < NUM_QUEUES; i++) {
         levels[i].queue.head = NULL;
         levels[i].queue.tail = NULL;
+        levels[i].queue.count = 0;
     }
 }
 
 /**
- * Adiciona um processo à fila mais prioritária (nível 0).
+ * Altera o time-slice de todos os níveis (variantes do schedcmp).
+ */
+void mlfq_set_time_slice(uint32_t ms) {
+    time_slice_ms = ms;
+}
+
+/**
+ * Número de níveis de prioridade e número de processos em cada nível
+ * (usado pelas estatísticas em tempo real).
+ */
+int mlfq_num_levels(void) {
+    return NUM_QUEUES;
+}
+
+uint32_t mlfq_queue_depth(int level) {
+    return (level >= 0 && level < NUM_QUEUES) ? levels[level].queue.count : 0;
+}
+
+/**
+ * Cancela todos os processos de um cliente que se desligou,
+ * em todos os níveis de prioridade.
+ */
+uint32_t mlfq_cancel_sockfd(uint32_t sockfd) {
+    uint32_t removed = 0;
+    for (int i = 0; i < NUM_QUEUES; i++) {
+        removed += remove_pcbs_by_sockfd(&levels[i].queue, sockfd);
+    }
+    return removed;
+}
+
+/**
+ * Escreve / restaura as filas de todos os níveis (checkpoint).
+ */
+void mlfq_checkpoint(ckpt_t *c) {
+    uint32_t levels_count = NUM_QUEUES;
+    ckpt_put(c, &levels_count, sizeof(levels_count));
+    for (int i = 0; i < NUM_QUEUES; i++) ckpt_put_queue(c, &levels[i].queue);
+}
+
+int mlfq_restore(ckpt_t *c) {
+    uint32_t levels_count;
+    ckpt_get(c, &levels_count, sizeof(levels_count));
+    if (c->error || levels_count != NUM_QUEUES) return -1;
+    for (int i = 0; i < NUM_QUEUES; i++) ckpt_get_queue(c, &levels[i].queue);
+    return c->error ? -1 : 0;
+}
+
+/**
+ * Adiciona um novo burst de um processo à fila do MLFQ.
  *
  * Esta função é chamada sempre que um processo:
  *  - entra no sistema pela primeira vez, ou
  *  - regressa de uma operação de I/O.
  *
- * Ao reiniciar, o processo volta ao topo (nível 0),
- * com os contadores de tempo e fatia (slice) a zero.
+ * Um processo novo começa no topo (nível 0). Um processo que já correu
+ * começa um nível acima daquele em que correu da última vez (proc.h):
+ * largar o CPU para fazer I/O é recompensado, mas um processo que gasta
+ * as fatias não volta logo ao topo. Não há boost periódico, pelo que
+ * subir um nível por burst é o que impede os interativos de ficarem
+ * presos em baixo. Os contadores de tempo e de fatia começam a zero.
  */
 void enqueue_mlfq(pcb_t *pcb) {
-    pcb->priority_level = 0;       // começa no nível mais alto
+    const proc_t *proc = pcb->cold->proc;
+    uint32_t level = (proc && proc->last_level > 0) ? proc->last_level - 1u : 0;
+    pcb->priority_level = level;
     pcb->ellapsed_time_ms = 0;     // reinicia o tempo total de CPU
     pcb->slice_start_ms = 0;       // reinicia o contador do slice atual
-    enqueue_pcb(&levels[0].queue, pcb);
+    enqueue_pcb(&levels[level].queue, pcb);
 }
 
 /**
@@ -47,7 +107,8 @@ void enqueue_mlfq(pcb_t *pcb) {
  *
  * Funcionamento geral:
  *  - Existem várias filas com diferentes níveis de prioridade.
- *  - Processos novos começam no nível mais alto.
+ *  - Processos novos começam no nível mais alto; os que voltam do I/O, um
+ *    nível acima daquele em que correram da última vez.
  *  - Se não terminam dentro do time-slice → descem um nível.
  *  - Se terminam (DONE) → são removidos.
  *  - A escolha do próximo processo é sempre feita da fila mais prioritária que tiver tarefas.
@@ -64,19 +125,22 @@ void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq /*unused*/, pcb_t **cp
                 .request = PROCESS_REQUEST_DONE,
                 .time_ms = current_time_ms
             };
-            if (write((*cpu_task)->sockfd, &msg, sizeof(msg_t)) != sizeof(msg_t)) {
-                perror("write");
-            }
-            free(*cpu_task);
+            TRACE(TRACE_DONE, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.bursts_done++;
+            conn_notify((*cpu_task)->cold->sockfd, &msg);
+            TRACE(TRACE_MSG_OUT, (*cpu_task)->pid, current_time_ms, PROCESS_REQUEST_DONE);
+            free_pcb(*cpu_task);
             *cpu_task = NULL;
         }
         // 1.b) Caso o processo ainda não tenha terminado, verifica o time-slice
-        else if ((current_time_ms - (*cpu_task)->slice_start_ms) >= TIME_SLICE) {
+        else if ((current_time_ms - (*cpu_task)->slice_start_ms) >= time_slice_ms) {
             // Se não está na última fila, desce de prioridade
             if ((*cpu_task)->priority_level < NUM_QUEUES - 1) {
                 (*cpu_task)->priority_level++;
             }
             // Volta para a nova fila de acordo com a prioridade atual
+            TRACE(TRACE_PREEMPT, (*cpu_task)->pid, current_time_ms, (*cpu_task)->priority_level);
+            g_stats.preemptions++;
             enqueue_pcb(&levels[(*cpu_task)->priority_level].queue, *cpu_task);
             *cpu_task = NULL;
         }
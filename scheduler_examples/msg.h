@@ -10,6 +10,8 @@
 #include <sys/types.h>
 
 #define SOCKET_PATH "/tmp/scheduler.sock"
+#define STATS_SOCKET_PATH "/tmp/scheduler-stats.sock"   // Live statistics (JSON snapshot per connection)
+#define UPGRADE_SOCKET_PATH "/tmp/scheduler-upgrade.sock" // Hot upgrade: a new scheduler takes over the sockets here
 
 #define MAX_PAGES 32
 
@@ -18,7 +20,8 @@ static const char PROCESS_REQUEST_STRINGS[][10] = {
     "RUN",
     "BLOCK",
     "ACK",
-    "DONE"
+    "DONE",
+    "REJECT"
 };
 
 // Define the types of requests a process can make to the scheduler
@@ -27,10 +30,11 @@ typedef enum  {
     PROCESS_REQUEST_BLOCK,
     PROCESS_REQUEST_ACK,
     PROCESS_REQUEST_DONE,
+    PROCESS_REQUEST_REJECT,         // Reply instead of ACK when admission control refuses a request;
+                                    // time_ms is how long to wait before sending it again
 } process_request_t;
 
 // Define the structure for page information
-// Note: Not used until we get to memory management, but defined here for completeness
 typedef struct {
     uint32_t count;            // Number of pages in the burst
     uint32_t ids[MAX_PAGES];      // Array of pages (up to MAX_PAGES)
@@ -42,7 +46,36 @@ typedef struct {
     pid_t pid;                      // Process ID
     process_request_t request;      // Request type
     uint32_t time_ms;               // Time information
+    uint32_t group;                 // Group (tenant) of the process, see msg_group_from_name (0 = none)
+    page_info_t pages;              // Pages referenced by the burst (RUN/BLOCK only)
 } msg_t;
 
+#define MSG_GROUP_CHARS 4
+
+// Group identifier of an application: the first characters of the name up
+// to the first '-' or '.', without the directory ("workloads/A-5.csv" -> "A"),
+// packed into an integer so the scheduler can print it back. Apps started
+// from the same family of burst files end up in the same group.
+static inline uint32_t msg_group_from_name(const char *name) {
+    const char *base = name;
+    for (const char *s = name; *s; s++) {
+        if (*s == '/') base = s + 1;
+    }
+    uint32_t group = 0;
+    for (int i = 0; i < MSG_GROUP_CHARS && base[i] && base[i] != '-' && base[i] != '.'; i++) {
+        group |= (uint32_t)(unsigned char)base[i] << (8 * i);
+    }
+    return group;
+}
+
+// Writes the name of a group ("-" for no group) into out, which must hold
+// MSG_GROUP_CHARS + 1 characters
+static inline void msg_group_name(uint32_t group, char *out) {
+    int n = 0;
+    for (; n < MSG_GROUP_CHARS && (group >> (8 * n)) & 0xff; n++) out[n] = (char)((group >> (8 * n)) & 0xff);
+    if (n == 0) out[n++] = '-';
+    out[n] = '\0';
+}
+
 
 #endif //COMMON_H
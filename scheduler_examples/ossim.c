@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -9,20 +10,57 @@
 #include <errno.h>
 #include <signal.h>
 #include <time.h>
+#include <getopt.h>
 
 #include "queue.h"
 #include "msg.h"
 #include "fifo.h"
+#include "mem.h"
+#include "vm.h"
+#include "trace.h"
+#include "latency.h"
+#include "stats.h"
+#include "conn.h"
+#include "dev.h"
+#include "ckpt.h"
+#include "upgrade.h"
+#include "readyset.h"
+#include "predict.h"
+#include "proc.h"
+#include "swcost.h"
+#include "group.h"
+#include "admit.h"
 #include "debug.h"
 
 // Protótipos dos diferentes escalonadores
 void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
 void rr_scheduler (uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+void rr_set_adaptive(uint32_t target_ms, uint32_t min_slice_ms);
+void rr_print_stats(FILE *out);
+void rr_checkpoint(ckpt_t *c);
+int rr_restore(ckpt_t *c);
+
+// Conjunto de prontos em SoA do SJF (definido em sjf.c, --ready-set=soa)
+int sjf_use_ready_set(void);
+uint32_t sjf_ready_set_count(void);
+uint32_t sjf_cancel_sockfd(uint32_t sockfd);
+void sjf_checkpoint_ready(ckpt_t *c, const queue_t *rq);
+
+// Funções específicas do SRTF (definidas em srtf.c)
+void srtf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+uint32_t srtf_count(void);
+uint32_t srtf_cancel_sockfd(uint32_t sockfd);
+void srtf_checkpoint_ready(ckpt_t *c, const queue_t *rq);
 
 // Funções específicas do MLFQ (definidas em mlfq.c)
 void mlfq_init(void);
 void enqueue_mlfq(pcb_t *pcb);
 void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq /*unused*/, pcb_t **cpu_task);
+int mlfq_num_levels(void);
+uint32_t mlfq_queue_depth(int level);
+uint32_t mlfq_cancel_sockfd(uint32_t sockfd);
+void mlfq_checkpoint(ckpt_t *c);
+int mlfq_restore(ckpt_t *c);
 
 // Enum que representa o escalonador ativo
 typedef enum  {
@@ -30,10 +68,11 @@ typedef enum  {
     SCHED_FIFO = 0,
     SCHED_SJF,
     SCHED_RR,
-    SCHED_MLFQ
+    SCHED_MLFQ,
+    SCHED_SRTF
 } scheduler_en;
 
-static const char *SCHEDULER_NAMES[] = {"FIFO","SJF","RR","MLFQ",NULL};
+static const char *SCHEDULER_NAMES[] = {"FIFO","SJF","RR","MLFQ","SRTF",NULL};
 
 // ---------------------------------------------------------
 // Funções utilitárias
@@ -51,6 +90,14 @@ static int set_nonblocking(int fd) {
 static volatile sig_atomic_t g_stop = 0;
 static void on_sigint(int sig) { (void)sig; g_stop = 1; }
 
+// SIGUSR1 pede que os histogramas de latência sejam impressos no próximo tick
+static volatile sig_atomic_t g_dump_latency = 0;
+static void on_sigusr1(int sig) { (void)sig; g_dump_latency = 1; }
+
+// SIGUSR2 pede um checkpoint no fim do tick atual (--checkpoint)
+static volatile sig_atomic_t g_checkpoint = 0;
+static void on_sigusr2(int sig) { (void)sig; g_checkpoint = 1; }
+
 // ---------------------------------------------------------
 // Criação do socket servidor UNIX
 // ---------------------------------------------------------
@@ -87,162 +134,292 @@ static int make_server_socket(const char *path) {
     return fd;
 }
 
-// ---------------------------------------------------------
-// Leitura de mensagens dos clientes (apps)
-// ---------------------------------------------------------
-static int read_msg_nonblock(int sockfd, msg_t *out) {
-    ssize_t n = recv(sockfd, out, sizeof(*out), MSG_DONTWAIT);
-    if (n == 0) {
-        // O cliente fechou a ligação
-        return 0;
-    }
-    if (n < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) return -2; // nada para ler agora
-        return -1; // erro real
-    }
-    if ((size_t)n != sizeof(*out)) return -1;
-    return 1; // leitura bem sucedida
-}
-
 // ---------------------------------------------------------
 // Filas usadas no simulador:
-//   - command_q: sockets ligados (para receber pedidos)
-//   - ready_q:   processos prontos (usado por FIFO/SJF/RR)
-//   - blocked_q: processos bloqueados (I/O em curso)
+//   - ligações: tabela de ligações ativas (conn.h)
+//   - ready_q:   processos prontos (usado por FIFO/SJF/RR/SRTF)
+//   - blocked_q: processos bloqueados (I/O em curso, sem dispositivos)
+//   - dispositivos: filas de I/O por dispositivo (dev.h, --io-devices)
 //   - cpu_task:  processo em execução no CPU
 // ---------------------------------------------------------
 
+// Processos prontos, em qualquer das estruturas das políticas, mais o do CPU
+static uint32_t runnable_tasks(const queue_t *ready_q, const pcb_t *cpu_task, scheduler_en scheduler) {
+    uint32_t n = cpu_task ? 1 : 0;
+    if (scheduler == SCHED_MLFQ) {
+        for (int i = 0; i < mlfq_num_levels(); i++) n += mlfq_queue_depth(i);
+    } else {
+        n += ready_q->count + sjf_ready_set_count() + srtf_count() + group_ready_count();
+    }
+    return n;
+}
+
+/**
+ * Termina uma ligação: cancela todos os PCBs pendentes desse cliente
+ * (prontos, bloqueados ou no CPU), pois já não há a quem enviar o DONE,
+ * e liberta a ligação.
+ */
+static void close_client(conn_t *c,
+                         queue_t *blocked_q,
+                         queue_t *ready_q,
+                         pcb_t **cpu_task,
+                         scheduler_en scheduler)
+{
+    uint32_t sockfd = (uint32_t)c->fd;
+    uint32_t cancelled = remove_pcbs_by_sockfd(blocked_q, sockfd);
+    cancelled += dev_cancel_sockfd(sockfd);
+    if (scheduler == SCHED_MLFQ) {
+        cancelled += mlfq_cancel_sockfd(sockfd);
+    } else {
+        cancelled += remove_pcbs_by_sockfd(ready_q, sockfd);
+        cancelled += sjf_cancel_sockfd(sockfd);
+        cancelled += srtf_cancel_sockfd(sockfd);
+        cancelled += group_cancel_sockfd(sockfd);
+    }
+    if (*cpu_task && (*cpu_task)->cold->sockfd == sockfd) {
+        free_pcb(*cpu_task);
+        *cpu_task = NULL;
+        cancelled++;
+    }
+    // Só depois de os PCBs do cliente desaparecerem: as entradas podem ser recicladas
+    proc_client_closed(sockfd);
+    if (cancelled > 0) {
+        DBG("Cancelled %u pending tasks of client fd=%d", cancelled, c->fd);
+    }
+
+    g_stats.tasks_cancelled += cancelled;
+    g_stats.clients_closed++;
+    g_stats.clients_connected--;
+    conn_close(c);
+}
+
 /**
- * Aceita novas ligações e trata mensagens RUN/BLOCK de todas as ligações ativas.
+ * Trata um pedido recebido de uma aplicação.
  *
  * RUN  → envia ACK e adiciona o processo à fila certa:
  *          - MLFQ → enqueue_mlfq(p)
- *          - restantes → enqueue_pcb(ready_q, p)
+ *          - restantes → enqueue_pcb(ready_q, p) (com --fair-share, o
+ *            group_scheduler passa-o para a fila do seu grupo)
+ *
+ * BLOCK → envia ACK e coloca o processo em blocked_q, ou na fila de um
+ *         dispositivo se houver dispositivos configurados.
+ *
+ * Com controlo de admissão, um pedido recusado recebe REJECT (com o tempo
+ * a esperar antes de o repetir) em vez de ACK e não cria PCB. runnable é
+ * o número de processos prontos ou no CPU, atualizado a cada RUN aceite.
+ *
+ * O ACK é apenas colocado no ring de envio da ligação; todas as mensagens
+ * do tick seguem juntas no conn_flush_all, no fim do tick.
+ */
+static void handle_request(conn_t *c,
+                           const msg_t *msg,
+                           queue_t *blocked_q,
+                           queue_t *ready_q,
+                           uint32_t *runnable,
+                           uint32_t now_ms,
+                           scheduler_en scheduler)
+{
+    c->requests++;
+    TRACE(TRACE_MSG_IN, msg->pid, now_ms, msg->request);
+
+    uint32_t retry_ms = admit_request(&c->bucket, msg->request, *runnable, now_ms);
+    if (retry_ms > 0) {
+        msg_t reject = {
+            .pid = msg->pid,
+            .request = PROCESS_REQUEST_REJECT,
+            .time_ms = retry_ms
+        };
+        if (!conn_send(c, &reject)) {
+            fprintf(stderr, "Dropping request from pid %d: client fd=%d is not reading\n", (int)msg->pid, c->fd);
+            return;
+        }
+        TRACE(TRACE_MSG_OUT, msg->pid, now_ms, PROCESS_REQUEST_REJECT);
+        DBG("Rejected %s from pid %d, retry in %u ms",
+            PROCESS_REQUEST_STRINGS[msg->request], (int)msg->pid, retry_ms);
+        return;
+    }
+
+    // Envia resposta imediata (ACK) a cada pedido recebido
+    msg_t ack = {
+        .pid = msg->pid,
+        .request = PROCESS_REQUEST_ACK,
+        .time_ms = now_ms
+    };
+    if (!conn_send(c, &ack)) {
+        fprintf(stderr, "Dropping request from pid %d: client fd=%d is not reading\n", (int)msg->pid, c->fd);
+        return;
+    }
+    TRACE(TRACE_MSG_OUT, msg->pid, now_ms, PROCESS_REQUEST_ACK);
+    g_stats.acks_sent++;
+
+    // Tratamento do pedido recebido
+    if (msg->request == PROCESS_REQUEST_RUN) {
+        // Cria um novo PCB para este burst de execução
+        pcb_t *p = new_pcb(msg->pid, (uint32_t)c->fd, msg->time_ms);
+        if (!p) return;
+        // Com --predict, o SJF/SRTF ordenam pela duração prevista, não pela declarada
+        if (predict_enabled()) p->estimate_ms = predict_burst(p->pid);
+        proc_t *proc = proc_of(p, now_ms);
+        if (proc) proc->bursts++;
+        p->cold->status = TASK_RUNNING;
+        p->cold->last_update_time_ms = now_ms;     // chegada à ready queue (tempo de resposta)
+        p->cold->pages = msg->pages;
+        p->cold->group = msg->group;
+        p->ellapsed_time_ms = 0;
+        p->slice_start_ms = 0;
+
+        if (scheduler == SCHED_MLFQ) {
+            enqueue_mlfq(p); // MLFQ gere internamente as suas filas
+        } else {
+            enqueue_pcb(ready_q, p);
+        }
+        (*runnable)++;
+
+        g_stats.requests_run++;
+        DBG("Process %d requested RUN for %u ms", p->pid, p->time_ms);
+    }
+    else if (msg->request == PROCESS_REQUEST_BLOCK) {
+        // O processo pediu I/O → vai para a fila de bloqueados
+        pcb_t *p = new_pcb(msg->pid, (uint32_t)c->fd, msg->time_ms);
+        if (!p) return;
+        p->cold->status = TASK_BLOCKED;
+        p->ellapsed_time_ms = 0;
+        p->cold->last_update_time_ms = now_ms;
+        p->cold->pages = msg->pages;
+        p->cold->group = msg->group;
+        proc_t *proc = proc_of(p, now_ms);
+        if (proc) proc->io_requests++;
+        // As páginas do buffer de I/O também têm de estar em memória:
+        // o serviço dos page faults prolonga o tempo bloqueado
+        p->time_ms += mem_reference(p->pid, &p->cold->pages, now_ms);
+        if (dev_count() > 0) {
+            dev_submit(p, now_ms);
+        } else {
+            enqueue_pcb(blocked_q, p);
+        }
+        TRACE(TRACE_BLOCK, p->pid, now_ms, p->time_ms);
+
+        g_stats.requests_block++;
+        DBG("Process %d requested BLOCK for %u ms", p->pid, p->time_ms);
+    }
+    else {
+        // Pedido não reconhecido (segurança extra)
+        DBG("Unexpected request from pid=%d type=%d", (int)msg->pid, (int)msg->request);
+    }
+}
+
+/**
+ * Aceita novas ligações e trata os eventos das ligações prontas (epoll ou
+ * CQEs do io_uring, consoante o backend).
  *
- * BLOCK → envia ACK e coloca o processo em blocked_q.
+ * De cada ligação com dados é lido tudo o que estiver disponível e são
+ * tratadas todas as mensagens completas; uma mensagem incompleta fica no
+ * buffer da ligação até chegar o resto.
  *
- * Cada ligação mantém um PCB “de comando” apenas para guardar o socket ativo.
+ * Quando um cliente fecha a ligação, esta é retirada da tabela e os seus
+ * PCBs pendentes são cancelados (close_client).
  */
-static void check_new_commands(queue_t *command_q,
-                               queue_t *blocked_q,
+static void check_new_commands(queue_t *blocked_q,
                                queue_t *ready_q,
-                               int server_fd,
+                               pcb_t **cpu_task,
                                uint32_t now_ms,
                                scheduler_en scheduler)
 {
-    // 1) Aceitar novas ligações (modo não bloqueante)
-    while (1) {
-        int client = accept(server_fd, NULL, NULL);
-        if (client < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
-            perror("accept");
-            break;
-        }
-        set_nonblocking(client);
-
-        // Cria um PCB apenas para representar esta ligação (comando)
-        pcb_t *cmd = new_pcb(-1, (uint32_t)client, 0);
-        if (!cmd) { close(client); continue; }
-        cmd->status = TASK_COMMAND;
-        enqueue_pcb(command_q, cmd);
-        DBG("New client connected (fd=%d)", client);
-    }
-
-    // 2) Lê mensagens de todos os sockets ligados (sem remover da queue)
-    for (queue_elem_t *it = command_q->head; it != NULL; it = it->next) {
-        pcb_t *cmd = it->pcb;
-        if (!cmd) continue;
-
-        msg_t msg;
-        int r = read_msg_nonblock((int)cmd->sockfd, &msg);
-        if (r == -2) continue;     // nada para ler neste tick
-        if (r <= 0) {
-            if (r == 0) {
-                DBG("Client fd=%d closed connection", (int)cmd->sockfd);
-            } else {
-                perror("read");
-            }
-            close((int)cmd->sockfd);
-            cmd->sockfd = (uint32_t)-1;
-            continue;
-        }
+    uint32_t runnable = admit_enabled() ? runnable_tasks(ready_q, *cpu_task, scheduler) : 0;
 
-        // Envia resposta imediata (ACK) a cada pedido recebido
-        msg_t ack = {
-            .pid = msg.pid,
-            .request = PROCESS_REQUEST_ACK,
-            .time_ms = now_ms
-        };
-        if (write((int)cmd->sockfd, &ack, sizeof(ack)) != sizeof(ack)) {
-            perror("write(ACK)");
-            continue;
-        }
-
-        // Tratamento do pedido recebido
-        if (msg.request == PROCESS_REQUEST_RUN) {
-            // Cria um novo PCB para este burst de execução
-            pcb_t *p = new_pcb(msg.pid, cmd->sockfd, msg.time_ms);
-            if (!p) continue;
-            p->status = TASK_RUNNING;
-            p->ellapsed_time_ms = 0;
-            p->slice_start_ms = 0;
-
-            if (scheduler == SCHED_MLFQ) {
-                enqueue_mlfq(p); // MLFQ gere internamente as suas filas
-            } else {
-                enqueue_pcb(ready_q, p);
+    // Eventos prontos: pedidos, fim de ligação e espaço para enviar
+    // (as novas ligações são aceites dentro do conn_poll)
+    conn_event_t events[64];
+    int n;
+    do {
+        n = conn_poll(events, 64, now_ms);
+        for (int e = 0; e < n; e++) {
+            conn_t *c = conn_get(events[e].fd);
+            if (!c) continue;      // socket de escuta, ou ligação fechada por um evento anterior
+
+            // 1) O cliente voltou a aceitar dados: envia o que ficou pendente
+            if ((events[e].events & CONN_EV_OUT) && conn_flush(c) < 0) {
+                perror("writev");
+                close_client(c, blocked_q, ready_q, cpu_task, scheduler);
+                continue;
             }
 
-            DBG("Process %d requested RUN for %u ms", p->pid, p->time_ms);
-        }
-        else if (msg.request == PROCESS_REQUEST_BLOCK) {
-            // O processo pediu I/O → vai para a fila de bloqueados
-            pcb_t *p = new_pcb(msg.pid, cmd->sockfd, msg.time_ms);
-            if (!p) continue;
-            p->status = TASK_BLOCKED;
-            p->ellapsed_time_ms = 0;
-            p->last_update_time_ms = now_ms;
-            enqueue_pcb(blocked_q, p);
+            // 2) Lê todos os pedidos disponíveis. Enquanto o cliente tiver
+            //    demasiadas respostas por ler (backpressure) o epoll não
+            //    reporta EPOLLIN, mas um HUP/ERR é sempre tratado.
+            if (!(events[e].events & (CONN_EV_IN | CONN_EV_HUP))) continue;
 
-            DBG("Process %d requested BLOCK for %u ms", p->pid, p->time_ms);
-        }
-        else {
-            // Pedido não reconhecido (segurança extra)
-            DBG("Unexpected request from pid=%d type=%d", (int)msg.pid, (int)msg.request);
+            conn_recv_en r;
+            do {
+                r = conn_recv(c);
+                msg_t msg;
+                while (conn_pop_msg(c, &msg)) {
+                    handle_request(c, &msg, blocked_q, ready_q, &runnable, now_ms, scheduler);
+                }
+            } while (r == CONN_RECV_FULL && !conn_paused(c));
+            if (r == CONN_RECV_FULL) r = CONN_RECV_AGAIN;   // o resto fica no socket
+
+            if (r == CONN_RECV_EOF || r == CONN_RECV_ERROR) {
+                if (r == CONN_RECV_EOF) {
+                    DBG("Client fd=%d closed connection", c->fd);
+                } else {
+                    perror("recv");
+                }
+                close_client(c, blocked_q, ready_q, cpu_task, scheduler);
+            }
         }
-    }
+    } while (n == 64);
+}
+
+// O processo terminou o I/O → envia DONE
+static void notify_io_done(pcb_t *p, uint32_t now_ms) {
+    proc_t *proc = proc_of(p, now_ms);
+    if (proc) proc->io_ms += now_ms - p->cold->last_update_time_ms;
+    msg_t done = {
+        .pid = p->pid,
+        .request = PROCESS_REQUEST_DONE,
+        .time_ms = now_ms
+    };
+    TRACE(TRACE_WAKE, p->pid, now_ms, 0);
+    conn_notify(p->cold->sockfd, &done);
+    TRACE(TRACE_MSG_OUT, p->pid, now_ms, PROCESS_REQUEST_DONE);
+    g_stats.blocks_done++;
 }
 
 /**
  * Atualiza os processos bloqueados (I/O).
  * Quando o tempo de bloqueio termina, envia uma mensagem DONE ao processo
  * e remove-o da lista de bloqueados.
+ *
+ * Com dispositivos configurados, os pedidos estão nas filas dos
+ * dispositivos: cada um avança um tick e os pedidos concluídos recebem DONE.
  */
 static void check_blocked_queue(queue_t *blocked_q, uint32_t now_ms) {
+    if (dev_count() > 0) {
+        queue_t done_q = {.head = NULL, .tail = NULL};
+        dev_tick(now_ms, &done_q);
+        while (done_q.head) {
+            pcb_t *p = dequeue_pcb(&done_q);
+            notify_io_done(p, now_ms);
+            free_pcb(p);
+        }
+    }
+
     queue_elem_t *it = blocked_q->head;
     while (it) {
         pcb_t *p = it->pcb;
-        if (p && p->status == TASK_BLOCKED) {
+        if (p && p->cold->status == TASK_BLOCKED) {
             p->ellapsed_time_ms += TICKS_MS;
 
             if (p->ellapsed_time_ms >= p->time_ms) {
-                // O processo terminou o I/O → envia DONE
-                msg_t done = {
-                    .pid = p->pid,
-                    .request = PROCESS_REQUEST_DONE,
-                    .time_ms = now_ms
-                };
-                if (write((int)p->sockfd, &done, sizeof(done)) != sizeof(done)) {
-                    perror("write(DONE:BLOCK)");
-                }
+                notify_io_done(p, now_ms);
 
                 // Remove da fila sem quebrar o iterador
                 queue_elem_t *to_remove = it;
                 it = it->next;
                 queue_elem_t *removed = remove_queue_elem(blocked_q, to_remove);
                 if (removed) {
-                    free(removed->pcb);
-                    free(removed);
+                    free_pcb(removed->pcb);
                 }
                 continue;
             }
@@ -251,6 +428,410 @@ static void check_blocked_queue(queue_t *blocked_q, uint32_t now_ms) {
     }
 }
 
+// ---------------------------------------------------------
+// Estatísticas em tempo real (STATS_SOCKET_PATH)
+// ---------------------------------------------------------
+
+/**
+ * Constrói o snapshot JSON do estado do simulador.
+ * Só lê contadores e profundidades já mantidos em O(1), pelo que não
+ * percorre nenhuma fila (com --fair-share acerta antes a parte de cada
+ * grupo, group_settle_shares).
+ */
+static size_t format_stats_snapshot(char *buf, size_t cap,
+                                    const queue_t *ready_q,
+                                    const queue_t *blocked_q,
+                                    const pcb_t *cpu_task,
+                                    uint32_t now_ms,
+                                    scheduler_en scheduler)
+{
+    size_t len = 0;
+#define APPEND(...) do { \
+        int n_ = snprintf(buf + len, cap - len, __VA_ARGS__); \
+        if (n_ < 0 || (size_t)n_ >= cap - len) return 0; \
+        len += (size_t)n_; \
+    } while (0)
+
+    APPEND("{\"time_ms\":%u,\"scheduler\":\"%s\",\"running_pid\":%d,\"ready\":[",
+           now_ms, SCHEDULER_NAMES[scheduler], cpu_task ? (int)cpu_task->pid : -1);
+    if (scheduler == SCHED_MLFQ) {
+        for (int i = 0; i < mlfq_num_levels(); i++) APPEND("%s%u", i ? "," : "", mlfq_queue_depth(i));
+    } else {
+        APPEND("%u", ready_q->count + sjf_ready_set_count() + srtf_count() + group_ready_count());
+    }
+    APPEND("],\"blocked\":%u,", blocked_q->count + dev_pending());
+    if (group_enabled()) {
+        // A parte de cada grupo conta só os ticks em que mais de um tinha trabalho
+        group_settle_shares();
+        uint64_t contended_ms = 0;
+        double owed_ms = 0.0;
+        for (uint32_t i = 0; i < group_num(); i++) {
+            const group_stats_t *g = group_stats_at(i);
+            contended_ms += g->contended_ms;
+            owed_ms += g->owed_ms;
+        }
+        APPEND("\"groups\":[");
+        for (uint32_t i = 0; i < group_num(); i++) {
+            const group_stats_t *g = group_stats_at(i);
+            char name[MSG_GROUP_CHARS + 1];
+            msg_group_name(g->id, name);
+            APPEND("%s{\"name\":\"%s\",\"weight\":%u,\"cpu_ms\":%llu,\"share\":%.3f,\"fair_share\":%.3f}",
+                   i ? "," : "", name, g->weight, (unsigned long long)g->cpu_ms,
+                   contended_ms ? (double)g->contended_ms / (double)contended_ms : 0.0,
+                   owed_ms > 0.0 ? g->owed_ms / owed_ms : 0.0);
+        }
+        APPEND("],");
+    }
+    if (admit_enabled()) {
+        const admit_stats_t *a = admit_get_stats();
+        APPEND("\"admission\":{\"runnable\":%u,\"admitted\":%llu,\"rejected_runnable\":%llu,"
+               "\"rejected_rate\":%llu},",
+               runnable_tasks(ready_q, cpu_task, scheduler), (unsigned long long)a->admitted,
+               (unsigned long long)a->rejected_runnable, (unsigned long long)a->rejected_rate);
+    }
+    if (dev_count() > 0) {
+        APPEND("\"devices\":[");
+        for (uint32_t i = 0; i < dev_count(); i++) {
+            const io_dev_t *d = dev_get(i);
+            APPEND("%s{\"queue\":%u,\"busy\":%s,\"requests\":%llu,\"util\":%.3f,\"avg_wait_ms\":%.1f}",
+                   i ? "," : "", d->queue.count, d->current ? "true" : "false",
+                   (unsigned long long)d->requests,
+                   now_ms ? (double)d->busy_ms / (double)now_ms : 0.0,
+                   d->requests ? (double)d->wait_ms / (double)d->requests : 0.0);
+        }
+        APPEND("],");
+    }
+    APPEND("\"counters\":{\"run\":%llu,\"block\":%llu,\"acks\":%llu,\"bursts_done\":%llu,"
+           "\"io_done\":%llu,\"context_switches\":%llu,\"preemptions\":%llu},",
+           (unsigned long long)g_stats.requests_run, (unsigned long long)g_stats.requests_block,
+           (unsigned long long)g_stats.acks_sent, (unsigned long long)g_stats.bursts_done,
+           (unsigned long long)g_stats.blocks_done, (unsigned long long)g_stats.context_switches,
+           (unsigned long long)g_stats.preemptions);
+    APPEND("\"clients\":{\"connected\":%u,\"accepted\":%llu,\"closed\":%llu,\"cancelled_tasks\":%llu},",
+           g_stats.clients_connected, (unsigned long long)g_stats.clients_accepted,
+           (unsigned long long)g_stats.clients_closed, (unsigned long long)g_stats.tasks_cancelled);
+    APPEND("\"processes\":{\"seen\":%u,\"live\":%u},", proc_count(), proc_live());
+    const mem_stats_t *ms = mem_get_stats();
+    APPEND("\"outbound\":{\"stalls\":%llu,\"dropped\":%llu,\"pauses\":%llu,\"peak_backlog\":%u},",
+           (unsigned long long)g_stats.tx_stalls, (unsigned long long)g_stats.tx_dropped,
+           (unsigned long long)g_stats.backpressure_pauses, g_stats.tx_peak_backlog);
+    APPEND("\"memory\":{\"references\":%llu,\"faults\":%llu},",
+           (unsigned long long)ms->references, (unsigned long long)ms->faults);
+    static const char *LATENCY_NAMES[] = {"commands", "blocked", "policy", "memory", "flush", "tick"};
+    APPEND("\"latency_us\":{");
+    for (int ph = 0; ph < LAT_PHASE_COUNT; ph++) {
+        const hist_t *h = latency_hist(scheduler, (lat_phase_en)ph);
+        APPEND("%s\"%s\":{\"p50\":%.2f,\"p99\":%.2f,\"max\":%.2f}", ph ? "," : "", LATENCY_NAMES[ph],
+               (double)hist_percentile(h, 50.0) / 1000.0,
+               (double)hist_percentile(h, 99.0) / 1000.0,
+               (double)h->max / 1000.0);
+    }
+    APPEND("}}\n");
+#undef APPEND
+    return len;
+}
+
+/**
+ * Responde a todas as ligações pendentes no socket de estatísticas:
+ * cada cliente recebe um snapshot e a ligação é fechada.
+ * O envio nunca bloqueia o tick (MSG_DONTWAIT).
+ */
+static void serve_stats_queries(int stats_fd,
+                                const queue_t *ready_q,
+                                const queue_t *blocked_q,
+                                const pcb_t *cpu_task,
+                                uint32_t now_ms,
+                                scheduler_en scheduler)
+{
+    char buf[8192];
+    size_t len = 0;
+    while (1) {
+        int client = accept(stats_fd, NULL, NULL);
+        if (client < 0) break;
+        // O snapshot só é construído se houver pelo menos um pedido neste tick
+        if (len == 0) len = format_stats_snapshot(buf, sizeof(buf), ready_q, blocked_q, cpu_task, now_ms, scheduler);
+        if (len > 0 && send(client, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+            perror("send(stats)");
+        }
+        close(client);
+    }
+}
+
+// ---------------------------------------------------------
+// Checkpoint e restauro (ckpt.h)
+// ---------------------------------------------------------
+
+/**
+ * Escreve o estado completo da simulação no início de um tick: relógio,
+ * filas (pela ordem atual), processo no CPU, estado interno do MLFQ,
+ * contadores, memória, TLB, dispositivos de I/O, custo das trocas de
+ * contexto e grupos (com as suas filas).
+ *
+ * Os histogramas de latência não fazem parte do checkpoint: medem o tempo
+ * real gasto por este processo, não o estado da simulação.
+ */
+static void write_state(ckpt_t *c,
+                        uint32_t now_ms,
+                        scheduler_en scheduler,
+                        const queue_t *ready_q,
+                        const queue_t *blocked_q,
+                        const pcb_t *cpu_task)
+{
+    int32_t sched = scheduler;
+    ckpt_put(c, &now_ms, sizeof(now_ms));
+    ckpt_put(c, &sched, sizeof(sched));
+    // O conjunto em SoA do SJF e o heap do SRTF são escritos como parte da
+    // ready queue, sem os esvaziar
+    if (scheduler == SCHED_MLFQ) {
+        mlfq_checkpoint(c);
+    } else if (scheduler == SCHED_SJF) {
+        sjf_checkpoint_ready(c, ready_q);
+    } else if (scheduler == SCHED_SRTF) {
+        srtf_checkpoint_ready(c, ready_q);
+    } else {
+        ckpt_put_queue(c, ready_q);
+    }
+    ckpt_put_queue(c, blocked_q);
+    ckpt_put_pcb(c, cpu_task);
+    ckpt_put(c, &g_stats, sizeof(g_stats));
+    proc_checkpoint(c);
+    mem_checkpoint(c);
+    vm_checkpoint(c);
+    dev_checkpoint(c);
+    predict_checkpoint(c);
+    rr_checkpoint(c);
+    swcost_checkpoint(c);
+    group_settle_shares();
+    group_checkpoint(c);
+}
+
+/**
+ * Lê o estado escrito por write_state. Tem de ser usado o mesmo
+ * escalonador; a configuração da memória, da TLB, dos dispositivos, do
+ * preditor de bursts, o quantum adaptativo do RR, o custo das trocas de
+ * contexto e os pesos dos grupos vêm do checkpoint e substituem os da
+ * linha de comandos.
+ */
+static int read_state(ckpt_t *c,
+                      const char *name,
+                      uint32_t *now_ms,
+                      scheduler_en scheduler,
+                      queue_t *ready_q,
+                      queue_t *blocked_q,
+                      pcb_t **cpu_task)
+{
+    int32_t sched;
+    ckpt_get(c, now_ms, sizeof(*now_ms));
+    ckpt_get(c, &sched, sizeof(sched));
+    if (!c->error && sched != (int32_t)scheduler) {
+        fprintf(stderr, "%s was taken with the %s scheduler\n", name,
+                (sched >= SCHED_FIFO && sched <= SCHED_SRTF) ? SCHEDULER_NAMES[sched] : "unknown");
+        return -1;
+    }
+
+    int err = 0;
+    if (scheduler == SCHED_MLFQ) {
+        err = mlfq_restore(c);
+    } else {
+        ckpt_get_queue(c, ready_q);
+    }
+    ckpt_get_queue(c, blocked_q);
+    *cpu_task = ckpt_get_pcb(c);
+    ckpt_get(c, &g_stats, sizeof(g_stats));
+    if (err == 0) err = proc_restore(c);
+    if (err == 0) err = mem_restore(c);
+    if (err == 0) err = vm_restore(c);
+    if (err == 0) err = dev_restore(c);
+    if (err == 0) err = predict_restore(c);
+    if (err == 0) err = rr_restore(c);
+    if (err == 0) err = swcost_restore(c);
+    if (err == 0) err = group_restore(c);
+    return (err < 0 || c->error) ? -1 : 0;
+}
+
+static int save_checkpoint(const char *path,
+                           uint32_t now_ms,
+                           scheduler_en scheduler,
+                           const queue_t *ready_q,
+                           const queue_t *blocked_q,
+                           const pcb_t *cpu_task)
+{
+    ckpt_t c;
+    if (ckpt_open_write(&c, path) < 0) return -1;
+    write_state(&c, now_ms, scheduler, ready_q, blocked_q, cpu_task);
+    return ckpt_close_write(&c);
+}
+
+/**
+ * Retoma a simulação a partir de um checkpoint.
+ *
+ * As ligações não sobrevivem ao processo: os PCBs restaurados continuam a
+ * ser escalonados (e a ocupar o CPU e os dispositivos) como no processo
+ * original, mas os seus DONE são descartados.
+ */
+static int restore_checkpoint(const char *path,
+                              uint32_t *now_ms,
+                              scheduler_en scheduler,
+                              queue_t *ready_q,
+                              queue_t *blocked_q,
+                              pcb_t **cpu_task)
+{
+    ckpt_t c;
+    if (ckpt_open_read(&c, path) < 0) return -1;
+
+    int err = read_state(&c, path, now_ms, scheduler, ready_q, blocked_q, cpu_task);
+    g_stats.clients_connected = 0;      // nenhuma ligação passou para este processo
+    if (ckpt_close_read(&c) < 0 || err < 0) {
+        fprintf(stderr, "Checkpoint %s is truncated or corrupted\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------
+// Hot upgrade (upgrade.h)
+// ---------------------------------------------------------
+
+/**
+ * Passa o simulador ao novo processo ligado em ctrl_client: o estado vai
+ * num memfd (com as filas e, para cada ligação, os dados por processar e
+ * as respostas por enviar) e os sockets vão com SCM_RIGHTS.
+ *
+ * @return 0 se o novo processo confirmou que assumiu os sockets, -1 se o
+ *         upgrade falhou (este processo continua a servir os clientes)
+ */
+static int hand_over(int ctrl_client,
+                     const int listen_fds[3],
+                     uint32_t now_ms,
+                     scheduler_en scheduler,
+                     const queue_t *ready_q,
+                     const queue_t *blocked_q,
+                     const pcb_t *cpu_task)
+{
+    if (conn_backend() != CONN_BACKEND_EPOLL) {
+        fprintf(stderr, "Hot upgrade refused: it requires --io-backend=epoll in the running scheduler\n");
+        return -1;
+    }
+
+    int state_fd = upgrade_state_fd();
+    if (state_fd < 0) return -1;
+
+    uint32_t nconns = conn_count();
+    int *fds = malloc((UPGRADE_FD_CONNS + nconns) * sizeof(int));
+    if (!fds) {
+        close(state_fd);
+        return -1;
+    }
+    fds[UPGRADE_FD_STATE] = state_fd;
+    fds[UPGRADE_FD_LISTEN] = listen_fds[0];
+    fds[UPGRADE_FD_STATS] = listen_fds[1];
+    fds[UPGRADE_FD_CONTROL] = listen_fds[2];
+
+    // Os fds antigos das ligações vêm primeiro: o novo processo precisa
+    // deles para traduzir o sockfd dos PCBs enquanto lê as filas
+    ckpt_t c;
+    int err = ckpt_open_fd_write(&c, state_fd);
+    if (err == 0) {
+        ckpt_put(&c, &nconns, sizeof(nconns));
+        for (uint32_t i = 0; i < nconns; i++) {
+            uint32_t fd = (uint32_t)conn_at(i)->fd;
+            fds[UPGRADE_FD_CONNS + i] = (int)fd;
+            ckpt_put(&c, &fd, sizeof(fd));
+        }
+        write_state(&c, now_ms, scheduler, ready_q, blocked_q, cpu_task);
+        for (uint32_t i = 0; i < nconns; i++) conn_checkpoint(conn_at(i), &c);
+        err = ckpt_close_write(&c);
+    }
+
+    // Espera (no máximo 5 s) que o novo processo confirme
+    char ack = 0;
+    if (err == 0) err = upgrade_send_fds(ctrl_client, fds, UPGRADE_FD_CONNS + nconns);
+    if (err == 0) {
+        struct timeval timeout = {.tv_sec = 5, .tv_usec = 0};
+        setsockopt(ctrl_client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (recv(ctrl_client, &ack, 1, MSG_WAITALL) != 1 || ack != 'Y') err = -1;
+    }
+    if (err < 0) fprintf(stderr, "Hot upgrade failed, still serving %u clients\n", nconns);
+
+    free(fds);
+    close(state_fd);
+    return err;
+}
+
+/**
+ * Assume os sockets e o estado do scheduler em execução (--takeover).
+ * As ligações e os PCBs continuam exatamente onde estavam.
+ */
+static int take_over(int listen_fds[3],
+                     uint32_t *now_ms,
+                     scheduler_en scheduler,
+                     queue_t *ready_q,
+                     queue_t *blocked_q,
+                     pcb_t **cpu_task)
+{
+    int sock = upgrade_connect(UPGRADE_SOCKET_PATH);
+    if (sock < 0) return -1;
+
+    uint32_t nfds;
+    int *fds = upgrade_recv_fds(sock, &nfds);
+    if (!fds || nfds < UPGRADE_FD_CONNS) {
+        fprintf(stderr, "The running scheduler did not hand over its sockets\n");
+        free(fds);
+        close(sock);
+        return -1;
+    }
+
+    ckpt_t c;
+    uint32_t nconns = 0;
+    uint32_t *fd_map = NULL;
+    uint32_t fd_map_len = 0;
+    int err = ckpt_open_fd_read(&c, fds[UPGRADE_FD_STATE]);
+    if (err == 0) {
+        ckpt_get(&c, &nconns, sizeof(nconns));
+        uint32_t *old_fds = malloc((nconns ? nconns : 1) * sizeof(uint32_t));
+        if (c.error || nconns != nfds - UPGRADE_FD_CONNS || !old_fds) err = -1;
+
+        // fd no processo antigo -> fd recebido
+        for (uint32_t i = 0; err == 0 && i < nconns; i++) {
+            ckpt_get(&c, &old_fds[i], sizeof(uint32_t));
+            if (old_fds[i] >= fd_map_len && !c.error) fd_map_len = old_fds[i] + 1;
+        }
+        if (err == 0 && !c.error) {
+            fd_map = malloc((fd_map_len ? fd_map_len : 1) * sizeof(uint32_t));
+            if (!fd_map) err = -1;
+            for (uint32_t i = 0; fd_map && i < fd_map_len; i++) fd_map[i] = CKPT_ORPHAN_FD;
+            for (uint32_t i = 0; fd_map && i < nconns; i++) {
+                fd_map[old_fds[i]] = (uint32_t)fds[UPGRADE_FD_CONNS + i];
+            }
+        }
+        free(old_fds);
+
+        c.fd_map = fd_map;
+        c.fd_map_len = fd_map_len;
+        if (err == 0) err = read_state(&c, "The running scheduler", now_ms, scheduler, ready_q, blocked_q, cpu_task);
+        for (uint32_t i = 0; err == 0 && i < nconns; i++) {
+            if (!conn_restore(&c, fds[UPGRADE_FD_CONNS + i]) || c.error) err = -1;
+        }
+        if (ckpt_close_read(&c) < 0) err = -1;
+    }
+    free(fd_map);
+    close(fds[UPGRADE_FD_STATE]);
+
+    // Só depois de tudo registado é que o processo antigo pode terminar
+    if (err == 0) {
+        listen_fds[0] = fds[UPGRADE_FD_LISTEN];
+        listen_fds[1] = fds[UPGRADE_FD_STATS];
+        listen_fds[2] = fds[UPGRADE_FD_CONTROL];
+        err = send(sock, "Y", 1, MSG_NOSIGNAL) == 1 ? 0 : -1;
+    }
+    if (err < 0) fprintf(stderr, "Failed to take over the running scheduler; it keeps running\n");
+    else printf("Took over from PID %d at %u ms with %u clients\n", (int)upgrade_peer_pid(sock), *now_ms, nconns);
+
+    free(fds);
+    close(sock);
+    return err;
+}
+
 // ---------------------------------------------------------
 // Identificação do escalonador a usar
 // ---------------------------------------------------------
@@ -260,34 +841,457 @@ static scheduler_en get_scheduler(const char *name) {
     if (!strcmp(name, "SJF"))   return SCHED_SJF;
     if (!strcmp(name, "RR"))    return SCHED_RR;
     if (!strcmp(name, "MLFQ"))  return SCHED_MLFQ;
+    if (!strcmp(name, "SRTF"))  return SCHED_SRTF;
     return NULL_SCHEDULER;
 }
 
+// ---------------------------------------------------------
+// Opções da linha de comandos
+// ---------------------------------------------------------
+enum {
+    OPT_FRAMES = 1000,
+    OPT_MEM_POLICY,
+    OPT_FAULT_MS,
+    OPT_WS_TAU_MS,
+    OPT_TLB_SETS,
+    OPT_TLB_WAYS,
+    OPT_TLB_MODE,
+    OPT_TLB_WALK_NS,
+    OPT_TRACE,
+    OPT_IO_BACKEND,
+    OPT_IO_DEVICES,
+    OPT_IO_SCHED,
+    OPT_SEEK_MS,
+    OPT_CHECKPOINT,
+    OPT_CHECKPOINT_EVERY_MS,
+    OPT_RESTORE,
+    OPT_TAKEOVER,
+    OPT_READY_SET,
+    OPT_PREDICT,
+    OPT_PREDICT_ALPHA,
+    OPT_PREDICT_INITIAL_MS,
+    OPT_RR_TARGET_MS,
+    OPT_RR_MIN_SLICE_MS,
+    OPT_CS_DISPATCH_US,
+    OPT_CS_WARMUP_US,
+    OPT_CS_WARMUP_DECAY_MS,
+    OPT_FAIR_SHARE,
+    OPT_GROUP_WEIGHTS,
+    OPT_GROUP_SLICE_MS,
+    OPT_MAX_RUNNABLE,
+    OPT_CLIENT_RATE,
+    OPT_CLIENT_BURST,
+    OPT_RETRY_MS,
+};
+
+static const struct option LONG_OPTIONS[] = {
+    {"frames",     required_argument, NULL, OPT_FRAMES},
+    {"mem-policy", required_argument, NULL, OPT_MEM_POLICY},
+    {"fault-ms",   required_argument, NULL, OPT_FAULT_MS},
+    {"ws-tau-ms",  required_argument, NULL, OPT_WS_TAU_MS},
+    {"tlb-sets",   required_argument, NULL, OPT_TLB_SETS},
+    {"tlb-ways",   required_argument, NULL, OPT_TLB_WAYS},
+    {"tlb-mode",   required_argument, NULL, OPT_TLB_MODE},
+    {"tlb-walk-ns", required_argument, NULL, OPT_TLB_WALK_NS},
+    {"trace",      required_argument, NULL, OPT_TRACE},
+    {"io-backend", required_argument, NULL, OPT_IO_BACKEND},
+    {"io-devices", required_argument, NULL, OPT_IO_DEVICES},
+    {"io-sched",   required_argument, NULL, OPT_IO_SCHED},
+    {"seek-ms",    required_argument, NULL, OPT_SEEK_MS},
+    {"checkpoint", required_argument, NULL, OPT_CHECKPOINT},
+    {"checkpoint-every-ms", required_argument, NULL, OPT_CHECKPOINT_EVERY_MS},
+    {"restore",    required_argument, NULL, OPT_RESTORE},
+    {"takeover",   no_argument,       NULL, OPT_TAKEOVER},
+    {"ready-set",  required_argument, NULL, OPT_READY_SET},
+    {"predict",    required_argument, NULL, OPT_PREDICT},
+    {"predict-alpha", required_argument, NULL, OPT_PREDICT_ALPHA},
+    {"predict-initial-ms", required_argument, NULL, OPT_PREDICT_INITIAL_MS},
+    {"rr-target-ms", required_argument, NULL, OPT_RR_TARGET_MS},
+    {"rr-min-slice-ms", required_argument, NULL, OPT_RR_MIN_SLICE_MS},
+    {"cs-dispatch-us", required_argument, NULL, OPT_CS_DISPATCH_US},
+    {"cs-warmup-us", required_argument, NULL, OPT_CS_WARMUP_US},
+    {"cs-warmup-decay-ms", required_argument, NULL, OPT_CS_WARMUP_DECAY_MS},
+    {"fair-share", no_argument,       NULL, OPT_FAIR_SHARE},
+    {"group-weights", required_argument, NULL, OPT_GROUP_WEIGHTS},
+    {"group-slice-ms", required_argument, NULL, OPT_GROUP_SLICE_MS},
+    {"max-runnable", required_argument, NULL, OPT_MAX_RUNNABLE},
+    {"client-rate", required_argument, NULL, OPT_CLIENT_RATE},
+    {"client-burst", required_argument, NULL, OPT_CLIENT_BURST},
+    {"retry-ms",   required_argument, NULL, OPT_RETRY_MS},
+    {NULL, 0, NULL, 0}
+};
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s <FIFO|SJF|RR|MLFQ|SRTF> [options]\n"
+            "  --frames=N          physical frames for page replacement (0 disables, default 64)\n"
+            "  --mem-policy=NAME   FIFO, LRU, CLOCK or WSCLOCK (default LRU)\n"
+            "  --fault-ms=N        service time of each page fault (default %d)\n"
+            "  --ws-tau-ms=N       working set window for WSCLOCK (default 1000)\n"
+            "  --tlb-sets=N        TLB sets, power of 2 (0 disables, default 16)\n"
+            "  --tlb-ways=N        TLB associativity (default 4)\n"
+            "  --tlb-mode=MODE     FLUSH or ASID on context switch (default FLUSH)\n"
+            "  --tlb-walk-ns=N     cost of a page table walk on a TLB miss (default 100)\n"
+            "  --trace=FILE        write a binary event trace (convert with trace2json)\n"
+            "  --io-backend=NAME   epoll or uring for client sockets (default epoll;\n"
+            "                      uring falls back to epoll when unavailable)\n"
+            "  --io-devices=N      simulated I/O devices with request queues (0 serves\n"
+            "                      every BLOCK in parallel, default 0)\n"
+            "  --io-sched=NAME     FIFO, SSTF or SCAN device queue order (default FIFO)\n"
+            "  --seek-ms=N         cost per block of head movement (default 1)\n"
+            "  --checkpoint=FILE   write the simulator state to FILE on SIGUSR2\n"
+            "  --checkpoint-every-ms=N\n"
+            "                      also checkpoint every N ms of simulated time\n"
+            "  --restore=FILE      resume from a checkpoint taken with the same scheduler\n"
+            "  --takeover          take the sockets, clients and state of the running\n"
+            "                      scheduler (same scheduler) without dropping a tick\n"
+            "  --ready-set=NAME    list or soa: SJF picks from a vectorized structure-of-\n"
+            "                      arrays ready set instead of the list (default list)\n"
+            "  --predict=MODEL     OFF, EWMA or HIST: SJF and SRTF order by the burst\n"
+            "                      length predicted from each pid's history instead of\n"
+            "                      the declared one (default OFF)\n"
+            "  --predict-alpha=A   weight of the last burst in EWMA, 0 < A <= 1 (default 0.5)\n"
+            "  --predict-initial-ms=N\n"
+            "                      prediction for a pid with no history (default 100)\n"
+            "  --rr-target-ms=N    adaptive RR: the quantum becomes N ms divided by the\n"
+            "                      runnable tasks, capped at twice the recent average burst\n"
+            "                      (0 keeps the fixed 500 ms quantum, default 0;\n"
+            "                      not with --fair-share)\n"
+            "  --rr-min-slice-ms=N smallest adaptive quantum (default 20)\n"
+            "  --cs-dispatch-us=N  simulated cost of every context switch (default 0)\n"
+            "  --cs-warmup-us=N    cache warm-up cost of a task that was cold (default 0)\n"
+            "  --cs-warmup-decay-ms=N\n"
+            "                      time off the CPU after which a task is cold; the\n"
+            "                      warm-up cost grows linearly up to it (default 100)\n"
+            "  --fair-share        split the CPU between groups (the burst file family\n"
+            "                      sent by the clients, A-5.csv -> A) by weight first,\n"
+            "                      then run FIFO, SJF or RR inside each group\n"
+            "  --group-weights=LIST\n"
+            "                      weights as NAME:W,... (1 to %d, default %d)\n"
+            "  --group-slice-ms=N  time a group keeps the CPU before a group that is\n"
+            "                      behind its share can take it (default 100)\n"
+            "  --max-runnable=N    reject RUN requests while N tasks are ready or running;\n"
+            "                      clients get REJECT and retry later (0 = no limit, default 0)\n"
+            "  --client-rate=N     token bucket of N requests per second of simulated time\n"
+            "                      for each client connection (0 = no limit, default 0)\n"
+            "  --client-burst=N    requests a client can send back to back (default 16)\n"
+            "  --retry-ms=N        wait suggested to a client rejected by --max-runnable\n"
+            "                      (default 100)\n",
+            prog, TICKS_MS, GROUP_WEIGHT_MAX, GROUP_WEIGHT_DEFAULT);
+}
+
+// Converte um argumento numérico, terminando o programa se for inválido
+static uint32_t parse_u32_arg(const char *opt, const char *value) {
+    char *endptr;
+    errno = 0;
+    unsigned long v = strtoul(value, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || v > UINT32_MAX) {
+        fprintf(stderr, "Invalid value for --%s: %s\n", opt, value);
+        exit(EXIT_FAILURE);
+    }
+    return (uint32_t)v;
+}
+
 // ---------------------------------------------------------
 // Função principal do simulador (main)
 // ---------------------------------------------------------
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <FIFO|SJF|RR|MLFQ>\n", argv[0]);
+    mem_config_t mem_cfg = {
+        .frames = 64,
+        .policy = MEM_LRU,
+        .fault_ms = TICKS_MS,
+        .ws_tau_ms = 1000
+    };
+    vm_config_t vm_cfg = {
+        .tlb_sets = 16,
+        .tlb_ways = 4,
+        .mode = TLB_FLUSH,
+        .hit_ns = 1,
+        .walk_ns = 100
+    };
+    const char *trace_path = NULL;
+    conn_backend_en io_backend = CONN_BACKEND_EPOLL;
+    dev_config_t dev_cfg = {
+        .count = 0,
+        .sched = DEV_FIFO,
+        .seek_ms = 1
+    };
+    const char *checkpoint_path = NULL;
+    uint32_t checkpoint_every_ms = 0;
+    const char *restore_path = NULL;
+    int takeover = 0;
+    int soa_ready_set = 0;
+    uint32_t rr_target_ms = 0;
+    uint32_t rr_min_slice_ms = 20;
+    swcost_config_t swcost_cfg = {
+        .dispatch_us = 0,
+        .warmup_us = 0,
+        .warmup_decay_ms = 100
+    };
+    int fair_share = 0;
+    const char *group_weights = NULL;
+    group_config_t group_cfg = {
+        .policy = NULL,
+        .policy_name = NULL,
+        .slice_ms = 100
+    };
+    admit_config_t admit_cfg = {
+        .max_runnable = 0,
+        .client_rate = 0,
+        .client_burst = 16,
+        .retry_ms = 100
+    };
+    predict_config_t predict_cfg = {
+        .model = PREDICT_OFF,
+        .alpha = 0.5,
+        .initial_ms = 100
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", LONG_OPTIONS, NULL)) != -1) {
+        switch (opt) {
+            case OPT_FRAMES:
+                mem_cfg.frames = parse_u32_arg("frames", optarg);
+                break;
+            case OPT_MEM_POLICY:
+                if (mem_policy_from_name(optarg, &mem_cfg.policy) < 0) {
+                    fprintf(stderr, "Invalid memory policy '%s'. Use FIFO, LRU, CLOCK or WSCLOCK.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_FAULT_MS:
+                mem_cfg.fault_ms = parse_u32_arg("fault-ms", optarg);
+                break;
+            case OPT_WS_TAU_MS:
+                mem_cfg.ws_tau_ms = parse_u32_arg("ws-tau-ms", optarg);
+                break;
+            case OPT_TLB_SETS:
+                vm_cfg.tlb_sets = parse_u32_arg("tlb-sets", optarg);
+                break;
+            case OPT_TLB_WAYS:
+                vm_cfg.tlb_ways = parse_u32_arg("tlb-ways", optarg);
+                break;
+            case OPT_TLB_MODE:
+                if (tlb_mode_from_name(optarg, &vm_cfg.mode) < 0) {
+                    fprintf(stderr, "Invalid TLB mode '%s'. Use FLUSH or ASID.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_TLB_WALK_NS:
+                vm_cfg.walk_ns = parse_u32_arg("tlb-walk-ns", optarg);
+                break;
+            case OPT_TRACE:
+                trace_path = optarg;
+                break;
+            case OPT_IO_BACKEND:
+                if (strcasecmp(optarg, "epoll") == 0) {
+                    io_backend = CONN_BACKEND_EPOLL;
+                } else if (strcasecmp(optarg, "uring") == 0 || strcasecmp(optarg, "io_uring") == 0) {
+                    io_backend = CONN_BACKEND_URING;
+                } else {
+                    fprintf(stderr, "Invalid I/O backend '%s'. Use epoll or uring.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_IO_DEVICES:
+                dev_cfg.count = parse_u32_arg("io-devices", optarg);
+                break;
+            case OPT_IO_SCHED:
+                if (dev_sched_from_name(optarg, &dev_cfg.sched) < 0) {
+                    fprintf(stderr, "Invalid device scheduler '%s'. Use FIFO, SSTF or SCAN.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_SEEK_MS:
+                dev_cfg.seek_ms = parse_u32_arg("seek-ms", optarg);
+                break;
+            case OPT_CHECKPOINT:
+                checkpoint_path = optarg;
+                break;
+            case OPT_CHECKPOINT_EVERY_MS:
+                checkpoint_every_ms = parse_u32_arg("checkpoint-every-ms", optarg);
+                break;
+            case OPT_RESTORE:
+                restore_path = optarg;
+                break;
+            case OPT_TAKEOVER:
+                takeover = 1;
+                break;
+            case OPT_READY_SET:
+                if (strcasecmp(optarg, "list") == 0) {
+                    soa_ready_set = 0;
+                } else if (strcasecmp(optarg, "soa") == 0) {
+                    soa_ready_set = 1;
+                } else {
+                    fprintf(stderr, "Invalid ready set '%s'. Use list or soa.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_PREDICT:
+                if (predict_model_from_name(optarg, &predict_cfg.model) < 0) {
+                    fprintf(stderr, "Invalid prediction model '%s'. Use OFF, EWMA or HIST.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_PREDICT_ALPHA: {
+                char *endptr;
+                predict_cfg.alpha = strtod(optarg, &endptr);
+                if (*endptr != '\0' || !(predict_cfg.alpha > 0.0 && predict_cfg.alpha <= 1.0)) {
+                    fprintf(stderr, "Invalid value for --predict-alpha: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case OPT_PREDICT_INITIAL_MS:
+                predict_cfg.initial_ms = parse_u32_arg("predict-initial-ms", optarg);
+                break;
+            case OPT_RR_TARGET_MS:
+                rr_target_ms = parse_u32_arg("rr-target-ms", optarg);
+                break;
+            case OPT_RR_MIN_SLICE_MS:
+                rr_min_slice_ms = parse_u32_arg("rr-min-slice-ms", optarg);
+                break;
+            case OPT_CS_DISPATCH_US:
+                swcost_cfg.dispatch_us = parse_u32_arg("cs-dispatch-us", optarg);
+                break;
+            case OPT_CS_WARMUP_US:
+                swcost_cfg.warmup_us = parse_u32_arg("cs-warmup-us", optarg);
+                break;
+            case OPT_CS_WARMUP_DECAY_MS:
+                swcost_cfg.warmup_decay_ms = parse_u32_arg("cs-warmup-decay-ms", optarg);
+                break;
+            case OPT_FAIR_SHARE:
+                fair_share = 1;
+                break;
+            case OPT_GROUP_WEIGHTS:
+                group_weights = optarg;
+                break;
+            case OPT_GROUP_SLICE_MS:
+                group_cfg.slice_ms = parse_u32_arg("group-slice-ms", optarg);
+                break;
+            case OPT_MAX_RUNNABLE:
+                admit_cfg.max_runnable = parse_u32_arg("max-runnable", optarg);
+                break;
+            case OPT_CLIENT_RATE:
+                admit_cfg.client_rate = parse_u32_arg("client-rate", optarg);
+                break;
+            case OPT_CLIENT_BURST:
+                admit_cfg.client_burst = parse_u32_arg("client-burst", optarg);
+                break;
+            case OPT_RETRY_MS:
+                admit_cfg.retry_ms = parse_u32_arg("retry-ms", optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (checkpoint_every_ms > 0 && !checkpoint_path) {
+        fprintf(stderr, "--checkpoint-every-ms requires --checkpoint=FILE\n");
+        return EXIT_FAILURE;
+    }
+    if (takeover && restore_path) {
+        fprintf(stderr, "--takeover and --restore are mutually exclusive\n");
         return EXIT_FAILURE;
     }
 
-    scheduler_en scheduler_type = get_scheduler(argv[1]);
+    scheduler_en scheduler_type = get_scheduler(argv[optind]);
     if (scheduler_type == NULL_SCHEDULER) {
-        fprintf(stderr, "Invalid scheduler '%s'. Use FIFO, SJF, RR or MLFQ.\n", argv[1]);
+        fprintf(stderr, "Invalid scheduler '%s'. Use FIFO, SJF, RR, MLFQ or SRTF.\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if (soa_ready_set && scheduler_type != SCHED_SJF) {
+        fprintf(stderr, "--ready-set=soa only applies to SJF\n");
+        return EXIT_FAILURE;
+    }
+    if (predict_cfg.model != PREDICT_OFF && scheduler_type != SCHED_SJF && scheduler_type != SCHED_SRTF) {
+        fprintf(stderr, "--predict only applies to SJF and SRTF\n");
+        return EXIT_FAILURE;
+    }
+    if (rr_target_ms > 0 && scheduler_type != SCHED_RR) {
+        fprintf(stderr, "--rr-target-ms only applies to RR\n");
+        return EXIT_FAILURE;
+    }
+    if ((group_weights || group_cfg.slice_ms != 100) && !fair_share) {
+        fprintf(stderr, "--group-weights and --group-slice-ms require --fair-share\n");
+        return EXIT_FAILURE;
+    }
+    if (fair_share) {
+        // As políticas com filas próprias (MLFQ, SRTF, conjunto em SoA) não
+        // correm sobre a fila de um grupo
+        if (scheduler_type != SCHED_FIFO && scheduler_type != SCHED_SJF && scheduler_type != SCHED_RR) {
+            fprintf(stderr, "--fair-share runs FIFO, SJF or RR inside each group\n");
+            return EXIT_FAILURE;
+        }
+        if (soa_ready_set) {
+            fprintf(stderr, "--ready-set=soa cannot be combined with --fair-share\n");
+            return EXIT_FAILURE;
+        }
+        // O quantum adaptativo é um só para o módulo: misturava os grupos
+        if (rr_target_ms > 0) {
+            fprintf(stderr, "--rr-target-ms cannot be combined with --fair-share\n");
+            return EXIT_FAILURE;
+        }
+        group_cfg.policy = scheduler_type == SCHED_FIFO ? fifo_scheduler
+                         : scheduler_type == SCHED_SJF ? sjf_scheduler : rr_scheduler;
+        group_cfg.policy_name = SCHEDULER_NAMES[scheduler_type];
+        if (group_init(&group_cfg) < 0) {
+            fprintf(stderr, "Failed to allocate the group table\n");
+            return EXIT_FAILURE;
+        }
+        if (group_weights && group_set_weights(group_weights) < 0) {
+            fprintf(stderr, "Invalid value for --group-weights: %s (use NAME:W,... with 1 <= W <= %d)\n",
+                    group_weights, GROUP_WEIGHT_MAX);
+            return EXIT_FAILURE;
+        }
+    }
+    if (admit_cfg.client_rate > 1000000 || admit_cfg.client_burst == 0) {
+        fprintf(stderr, "--client-rate must be at most 1000000 and --client-burst at least 1\n");
+        return EXIT_FAILURE;
+    }
+    if (rr_target_ms > 0) rr_set_adaptive(rr_target_ms, rr_min_slice_ms);
+    if (soa_ready_set && sjf_use_ready_set() < 0) {
+        fprintf(stderr, "Failed to allocate the ready set\n");
         return EXIT_FAILURE;
     }
 
-    signal(SIGINT, on_sigint);
-
-    int server_fd = make_server_socket(SOCKET_PATH);
-    if (server_fd < 0) return EXIT_FAILURE;
+    if (mem_init(&mem_cfg) < 0) {
+        fprintf(stderr, "Failed to allocate %u frames\n", mem_cfg.frames);
+        return EXIT_FAILURE;
+    }
+    // Sem frames não há páginas mapeadas, logo também não há tradução
+    if (mem_cfg.frames == 0) vm_cfg.tlb_sets = 0;
+    if (vm_init(&vm_cfg) < 0) {
+        fprintf(stderr, "Invalid TLB geometry %ux%u (sets must be a power of 2)\n",
+                vm_cfg.tlb_sets, vm_cfg.tlb_ways);
+        return EXIT_FAILURE;
+    }
+    if (dev_init(&dev_cfg) < 0) {
+        fprintf(stderr, "Failed to allocate %u I/O devices\n", dev_cfg.count);
+        return EXIT_FAILURE;
+    }
+    if (predict_init(&predict_cfg) < 0) {
+        fprintf(stderr, "Failed to allocate the burst history table\n");
+        return EXIT_FAILURE;
+    }
+    if (proc_init() < 0) {
+        fprintf(stderr, "Failed to allocate the process table\n");
+        return EXIT_FAILURE;
+    }
+    swcost_init(&swcost_cfg);
+    admit_init(&admit_cfg);
 
-    printf("Scheduler server listening on %s...\n", SOCKET_PATH);
-    printf("Active scheduler: %s\n", SCHEDULER_NAMES[scheduler_type]);
+    signal(SIGINT, on_sigint);
+    signal(SIGUSR1, on_sigusr1);
+    signal(SIGUSR2, on_sigusr2);
+    signal(SIGPIPE, SIG_IGN);   // escrever para um cliente que saiu não deve terminar o simulador
+    clock_calibrate();
 
     // Estruturas principais
-    queue_t command_queue = {.head=NULL, .tail=NULL};
     queue_t ready_queue   = {.head=NULL, .tail=NULL};
     queue_t blocked_queue = {.head=NULL, .tail=NULL};
     pcb_t *cpu_task = NULL;
@@ -296,34 +1300,187 @@ int main(int argc, char *argv[]) {
         mlfq_init(); // inicializa as filas internas do MLFQ
     }
 
-    // Ciclo principal da simulação
+    // Sockets de escuta: SOCKET_PATH, STATS_SOCKET_PATH e UPGRADE_SOCKET_PATH.
+    // Com --takeover são os do scheduler em execução, já com os clientes ligados
+    int listen_fds[3];
     uint32_t current_time_ms = 0;
-    uint32_t last_print_s = 0;
+    if (conn_init(io_backend) < 0) return EXIT_FAILURE;
+    if (takeover) {
+        if (take_over(listen_fds, &current_time_ms, scheduler_type,
+                      &ready_queue, &blocked_queue, &cpu_task) < 0) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        listen_fds[0] = make_server_socket(SOCKET_PATH);
+        listen_fds[1] = make_server_socket(STATS_SOCKET_PATH);
+        listen_fds[2] = make_server_socket(UPGRADE_SOCKET_PATH);
+        if (listen_fds[0] < 0 || listen_fds[1] < 0 || listen_fds[2] < 0) return EXIT_FAILURE;
+    }
+    if (conn_watch_listener(listen_fds[0]) < 0) return EXIT_FAILURE;
+    int server_fd = listen_fds[0];
+    int stats_fd = listen_fds[1];
+    int ctrl_fd = listen_fds[2];
+
+    if (trace_path && trace_start(trace_path) < 0) return EXIT_FAILURE;
+
+    printf("Scheduler server listening on %s...\n", SOCKET_PATH);
+    printf("Statistics available on %s\n", STATS_SOCKET_PATH);
+    printf("Active scheduler: %s\n", SCHEDULER_NAMES[scheduler_type]);
+    printf("Client I/O: %s\n", conn_backend_name(conn_backend()));
+    if (soa_ready_set) {
+        printf("Ready set: structure of arrays, %s min-scan\n", ready_set_isa_name(ready_set_best_isa()));
+    }
+    if (mem_cfg.frames > 0) {
+        printf("Memory: %u frames, %s replacement, %u ms per fault\n",
+               mem_cfg.frames, mem_policy_name(mem_cfg.policy), mem_cfg.fault_ms);
+    }
+    if (vm_cfg.tlb_sets > 0) {
+        printf("TLB: %u sets x %u ways, %s on context switch\n",
+               vm_cfg.tlb_sets, vm_cfg.tlb_ways, tlb_mode_name(vm_cfg.mode));
+    }
+    if (dev_cfg.count > 0) {
+        printf("I/O devices: %u, %s queue order, %u ms per block of seek\n",
+               dev_cfg.count, dev_sched_name(dev_cfg.sched), dev_cfg.seek_ms);
+    }
+    if (swcost_enabled()) {
+        printf("Context switch cost: %u us per dispatch, %u us to warm a cold cache (cold after %u ms)\n",
+               swcost_cfg.dispatch_us, swcost_cfg.warmup_us, swcost_cfg.warmup_decay_ms);
+    }
+    if (rr_target_ms > 0) {
+        printf("Adaptive quantum: %u ms target latency, %u ms minimum slice\n", rr_target_ms, rr_min_slice_ms);
+    }
+    if (fair_share) {
+        printf("Fair share: %s inside each group, %u ms group slice%s%s\n",
+               group_cfg.policy_name, group_cfg.slice_ms,
+               group_weights ? ", weights " : "", group_weights ? group_weights : "");
+    }
+    if (admit_enabled()) {
+        printf("Admission control: ");
+        if (admit_cfg.max_runnable > 0) {
+            printf("at most %u runnable tasks (retry after %u ms)", admit_cfg.max_runnable, admit_cfg.retry_ms);
+        }
+        if (admit_cfg.max_runnable > 0 && admit_cfg.client_rate > 0) printf(", ");
+        if (admit_cfg.client_rate > 0) {
+            printf("%u requests/s per client, burst %u", admit_cfg.client_rate, admit_cfg.client_burst);
+        }
+        printf("\n");
+    }
+    if (predict_cfg.model != PREDICT_OFF) {
+        printf("Burst prediction: %s, alpha %.2f, first guess %u ms\n",
+               predict_model_name(predict_cfg.model), predict_cfg.alpha, predict_cfg.initial_ms);
+    }
+
+    // Ciclo principal da simulação
+    if (restore_path) {
+        if (restore_checkpoint(restore_path, &current_time_ms, scheduler_type,
+                               &ready_queue, &blocked_queue, &cpu_task) < 0) {
+            return EXIT_FAILURE;
+        }
+        printf("Resumed from %s at %u ms (memory, TLB, I/O device, prediction, adaptive RR, switch cost and group settings from the checkpoint)\n",
+               restore_path, current_time_ms);
+    }
+    uint32_t last_print_s = current_time_ms / 1000;
+    int handed_over = 0;
 
     while (!g_stop) {
+        // Cada fase do tick é medida para os histogramas de latência
+        uint64_t t_start = clock_now_ticks();
+
         // 1) Receber pedidos novos das aplicações
-        check_new_commands(&command_queue, &blocked_queue, &ready_queue,
-                           server_fd, current_time_ms, scheduler_type);
+        check_new_commands(&blocked_queue, &ready_queue, &cpu_task,
+                           current_time_ms, scheduler_type);
+
+        uint64_t t_commands = clock_now_ticks();
 
-        // 2) Atualizar a fila de bloqueados
+        // 2) Atualizar a fila de bloqueados e os dispositivos de I/O
         check_blocked_queue(&blocked_queue, current_time_ms);
+        uint64_t t_blocked = clock_now_ticks();
 
         // 3) Executar o escalonador ativo
-        switch (scheduler_type) {
-            case SCHED_FIFO:
-                fifo_scheduler(current_time_ms, &ready_queue, &cpu_task);
-                break;
-            case SCHED_SJF:
-                sjf_scheduler(current_time_ms, &ready_queue, &cpu_task);
-                break;
-            case SCHED_RR:
-                rr_scheduler(current_time_ms, &ready_queue, &cpu_task);
-                break;
-            case SCHED_MLFQ:
-                mlfq_scheduler(current_time_ms, &ready_queue, &cpu_task);
-                break;
-            default:
-                break;
+        pcb_t *prev_task = cpu_task;
+        if (fair_share) {
+            // A política escolhida corre dentro de cada grupo
+            group_scheduler(current_time_ms, &ready_queue, &cpu_task);
+        } else {
+            switch (scheduler_type) {
+                case SCHED_FIFO:
+                    fifo_scheduler(current_time_ms, &ready_queue, &cpu_task);
+                    break;
+                case SCHED_SJF:
+                    sjf_scheduler(current_time_ms, &ready_queue, &cpu_task);
+                    break;
+                case SCHED_RR:
+                    rr_scheduler(current_time_ms, &ready_queue, &cpu_task);
+                    break;
+                case SCHED_MLFQ:
+                    mlfq_scheduler(current_time_ms, &ready_queue, &cpu_task);
+                    break;
+                case SCHED_SRTF:
+                    srtf_scheduler(current_time_ms, &ready_queue, &cpu_task);
+                    break;
+                default:
+                    break;
+            }
+        }
+        uint64_t t_policy = clock_now_ticks();
+
+        // 3.a) Um processo acabou de ganhar o CPU: as suas páginas têm de
+        //      estar em memória, e o serviço dos page faults prolonga o burst
+        if (cpu_task && cpu_task != prev_task) {
+            TRACE(TRACE_DISPATCH, cpu_task->pid, current_time_ms, 0);
+            g_stats.context_switches++;
+            vm_context_switch(cpu_task->pid);
+            proc_t *proc = proc_of(cpu_task, current_time_ms);
+            if (proc) {
+                proc->dispatches++;
+                proc->last_level = cpu_task->priority_level;
+                if (cpu_task->priority_level > proc->max_level) proc->max_level = cpu_task->priority_level;
+            }
+            // Custo da troca: overhead fixo mais o aquecimento da cache do processo
+            uint32_t switch_ms = swcost_dispatch(proc ? current_time_ms - proc->last_ran_ms : 0,
+                                                 !proc || proc->cpu_ms == 0,
+                                                 proc ? &proc->swcost_owed_us : NULL);
+            cpu_task->time_ms += switch_ms;
+            cpu_task->estimate_ms += switch_ms;
+            // O tempo a mais já é conhecido: entra também na estimativa do SJF/SRTF
+            uint32_t fault_ms = mem_reference(cpu_task->pid, &cpu_task->cold->pages, current_time_ms);
+            cpu_task->time_ms += fault_ms;
+            cpu_task->estimate_ms += fault_ms;
+        }
+
+        // 3.b) O tick conta para o tempo de CPU do processo, que durante este
+        //      tick acede às suas páginas através da TLB (os misses percorrem
+        //      a tabela de páginas e também prolongam o burst)
+        if (cpu_task) {
+            proc_t *proc = proc_of(cpu_task, current_time_ms);
+            if (proc) {
+                proc->cpu_ms += TICKS_MS;
+                proc->last_ran_ms = current_time_ms;
+            }
+            uint32_t walk_ms = vm_access(cpu_task->pid, &cpu_task->cold->pages, current_time_ms);
+            cpu_task->time_ms += walk_ms;
+            cpu_task->estimate_ms += walk_ms;
+        }
+        uint64_t t_memory = clock_now_ticks();
+
+        // 3.c) Enviar as respostas do tick (ACK/DONE), um writev por ligação
+        conn_flush_all();
+        uint64_t t_end = clock_now_ticks();
+
+        latency_record(scheduler_type, LAT_COMMANDS, clock_ticks_to_ns(t_commands - t_start));
+        latency_record(scheduler_type, LAT_BLOCKED, clock_ticks_to_ns(t_blocked - t_commands));
+        latency_record(scheduler_type, LAT_POLICY, clock_ticks_to_ns(t_policy - t_blocked));
+        latency_record(scheduler_type, LAT_MEMORY, clock_ticks_to_ns(t_memory - t_policy));
+        latency_record(scheduler_type, LAT_FLUSH, clock_ticks_to_ns(t_end - t_memory));
+        latency_record(scheduler_type, LAT_TICK, clock_ticks_to_ns(t_end - t_start));
+
+        // 3.d) Responder a pedidos de estatísticas (fora da medição do tick)
+        serve_stats_queries(stats_fd, &ready_queue, &blocked_queue, cpu_task,
+                            current_time_ms, scheduler_type);
+
+        if (g_dump_latency) {
+            g_dump_latency = 0;
+            latency_dump(stdout, SCHEDULER_NAMES);
         }
 
         // 4) Mostrar tempo de simulação uma vez por segundo
@@ -336,17 +1493,89 @@ int main(int argc, char *argv[]) {
         // 5) Avançar o tempo da simulação (tick)
         usleep(TICKS_MS * 1000);
         current_time_ms += TICKS_MS;
+
+        // 6) Checkpoint entre ticks (SIGUSR2 ou periódico). O período não tem
+        //    de ser múltiplo do tick: o checkpoint é tirado no tick em que se
+        //    passa um múltiplo de checkpoint_every_ms
+        if (checkpoint_every_ms > 0 &&
+            current_time_ms / checkpoint_every_ms != (current_time_ms - TICKS_MS) / checkpoint_every_ms) {
+            g_checkpoint = 1;
+        }
+        if (g_checkpoint) {
+            g_checkpoint = 0;
+            if (!checkpoint_path) {
+                fprintf(stderr, "SIGUSR2 ignored: no --checkpoint=FILE given\n");
+            } else if (save_checkpoint(checkpoint_path, current_time_ms, scheduler_type,
+                                       &ready_queue, &blocked_queue, cpu_task) == 0) {
+                printf("Checkpoint written to %s at %u ms\n", checkpoint_path, current_time_ms);
+            }
+        }
+
+        // 7) Hot upgrade: um novo scheduler (--takeover) pediu os sockets
+        int ctrl_client = accept(ctrl_fd, NULL, NULL);
+        if (ctrl_client >= 0) {
+            int done = hand_over(ctrl_client, listen_fds, current_time_ms, scheduler_type,
+                                 &ready_queue, &blocked_queue, cpu_task) == 0;
+            if (done) {
+                printf("Handed over to PID %d at %u ms\n", (int)upgrade_peer_pid(ctrl_client), current_time_ms);
+            }
+            close(ctrl_client);
+            if (done) {
+                handed_over = 1;
+                break;
+            }
+        }
     }
 
-    // Encerramento e limpeza final
+    // Encerramento e limpeza final. Depois do hot upgrade os sockets de
+    // escuta pertencem ao novo processo: fecham-se as cópias, sem unlink
     close(server_fd);
-    unlink(SOCKET_PATH);
+    close(stats_fd);
+    close(ctrl_fd);
+    if (!handed_over) {
+        unlink(SOCKET_PATH);
+        unlink(STATS_SOCKET_PATH);
+        unlink(UPGRADE_SOCKET_PATH);
+    }
 
     // Liberta memória das filas restantes
-    while (command_queue.head) free(dequeue_pcb(&command_queue));
-    while (ready_queue.head)   free(dequeue_pcb(&ready_queue));
-    while (blocked_queue.head) free(dequeue_pcb(&blocked_queue));
-    if (cpu_task) free(cpu_task);
+    conn_close_all();
+    while (ready_queue.head)   free_pcb(dequeue_pcb(&ready_queue));
+    while (blocked_queue.head) free_pcb(dequeue_pcb(&blocked_queue));
+    free_pcb(cpu_task);
+
+    trace_stop();
+
+    if (handed_over) {
+        // O resumo é do novo processo, que continua a contar
+        dev_shutdown();
+        vm_shutdown();
+        mem_shutdown();
+        return EXIT_SUCCESS;
+    }
+
+    stats_print(stdout, current_time_ms);
+    if (conn_backend() == CONN_BACKEND_URING) {
+        printf("Client I/O: io_uring, %llu io_uring_enter calls in %u ticks\n",
+               (unsigned long long)conn_uring_enters(), current_time_ms / TICKS_MS);
+    }
+    latency_dump(stdout, SCHEDULER_NAMES);
+    mem_print_stats(stdout);
+    vm_print_stats(stdout, SCHEDULER_NAMES[scheduler_type]);
+    dev_print_stats(stdout, current_time_ms);
+    predict_print_stats(stdout);
+    rr_print_stats(stdout);
+    swcost_print_stats(stdout, current_time_ms);
+    group_settle_shares();
+    group_print_stats(stdout);
+    admit_print_stats(stdout);
+    proc_print_stats(stdout, 10);
+    group_shutdown();
+    proc_shutdown();
+    predict_shutdown();
+    dev_shutdown();
+    vm_shutdown();
+    mem_shutdown();
 
     return EXIT_SUCCESS;
 }
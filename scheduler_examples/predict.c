@@ -0,0 +1,202 @@
+#include "predict.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define HIST_BUCKETS 12         // bursts de <20 ms até >=20 s, em potências de 2
+#define HIST_WINDOW  64         // acima disto as contagens são divididas por 2
+#define MIN_CAPACITY 64
+
+// Histórico de um pid (uma entrada da tabela de hash)
+typedef struct {
+    int32_t pid;
+    uint8_t used;
+    uint8_t reserved;
+    uint16_t hist_total;
+    uint32_t tau_ms;                        // estimativa EWMA
+    uint32_t samples;
+    uint16_t hist_count[HIST_BUCKETS];
+    uint32_t hist_sum_ms[HIST_BUCKETS];     // para devolver a média do balde, não o centro
+} entry_t;
+
+static const char *MODEL_NAMES[] = {"OFF", "EWMA", "HIST"};
+
+static _Thread_local predict_config_t config;
+static _Thread_local predict_stats_t stats;
+static _Thread_local entry_t *table = NULL;
+static _Thread_local uint32_t capacity = 0;     // potência de 2
+static _Thread_local uint32_t used = 0;
+
+int predict_model_from_name(const char *name, predict_model_en *out) {
+    for (int i = 0; i <= PREDICT_HIST; i++) {
+        if (!strcasecmp(name, MODEL_NAMES[i])) {
+            *out = (predict_model_en)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *predict_model_name(predict_model_en model) {
+    return MODEL_NAMES[model];
+}
+
+// Hash multiplicativo (Fibonacci): os pids seguidos ficam espalhados
+static uint32_t slot_of(int32_t pid, uint32_t cap) {
+    return ((uint32_t)pid * 2654435769u) & (cap - 1);
+}
+
+static entry_t *lookup(int32_t pid) {
+    if (!table) return NULL;
+    for (uint32_t i = slot_of(pid, capacity); table[i].used; i = (i + 1) & (capacity - 1)) {
+        if (table[i].pid == pid) return &table[i];
+    }
+    return NULL;
+}
+
+static int grow(void) {
+    uint32_t cap = capacity ? capacity * 2 : MIN_CAPACITY;
+    entry_t *t = calloc(cap, sizeof(entry_t));
+    if (!t) return -1;
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (!table[i].used) continue;
+        uint32_t j = slot_of(table[i].pid, cap);
+        while (t[j].used) j = (j + 1) & (cap - 1);
+        t[j] = table[i];
+    }
+    free(table);
+    table = t;
+    capacity = cap;
+    return 0;
+}
+
+// Entrada do pid, criada se não existir (NULL sem memória)
+static entry_t *lookup_or_insert(int32_t pid) {
+    entry_t *e = lookup(pid);
+    if (e) return e;
+    // Fator de carga até 1/2: as sequências de procura ficam curtas
+    if ((used + 1) * 2 > capacity && grow() < 0) return NULL;
+    uint32_t i = slot_of(pid, capacity);
+    while (table[i].used) i = (i + 1) & (capacity - 1);
+    e = &table[i];
+    memset(e, 0, sizeof(*e));
+    e->pid = pid;
+    e->used = 1;
+    e->tau_ms = config.initial_ms;
+    used++;
+    return e;
+}
+
+int predict_init(const predict_config_t *cfg) {
+    predict_shutdown();
+    config = *cfg;
+    memset(&stats, 0, sizeof(stats));
+    return config.model == PREDICT_OFF ? 0 : grow();
+}
+
+void predict_shutdown(void) {
+    free(table);
+    table = NULL;
+    capacity = 0;
+    used = 0;
+}
+
+int predict_enabled(void) {
+    return config.model != PREDICT_OFF;
+}
+
+static int bucket_of(uint32_t ms) {
+    int b = 0;
+    for (uint32_t v = ms / 20; v > 0 && b < HIST_BUCKETS - 1; v >>= 1) b++;
+    return b;
+}
+
+// Média dos bursts do balde onde está a mediana
+static uint32_t hist_median(const entry_t *e) {
+    uint32_t seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += e->hist_count[b];
+        if (seen * 2 >= e->hist_total && e->hist_count[b] > 0) {
+            return e->hist_sum_ms[b] / e->hist_count[b];
+        }
+    }
+    return e->tau_ms;
+}
+
+uint32_t predict_burst(int32_t pid) {
+    const entry_t *e = lookup(pid);
+    if (!e || e->samples == 0) return config.initial_ms;
+    return config.model == PREDICT_HIST ? hist_median(e) : e->tau_ms;
+}
+
+void predict_observe(int32_t pid, uint32_t predicted_ms, uint32_t actual_ms) {
+    if (config.model == PREDICT_OFF) return;
+
+    stats.samples++;
+    stats.abs_error_ms += predicted_ms > actual_ms ? predicted_ms - actual_ms : actual_ms - predicted_ms;
+    stats.actual_ms += actual_ms;
+    if (actual_ms > predicted_ms) stats.under++;
+
+    entry_t *e = lookup_or_insert(pid);
+    if (!e) return;
+    e->samples++;
+    e->tau_ms = (uint32_t)(config.alpha * (double)actual_ms + (1.0 - config.alpha) * (double)e->tau_ms + 0.5);
+
+    int b = bucket_of(actual_ms);
+    e->hist_count[b]++;
+    e->hist_sum_ms[b] += actual_ms;
+    if (++e->hist_total > HIST_WINDOW) {
+        // Envelhece o histograma: o comportamento recente pesa mais
+        e->hist_total = 0;
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            e->hist_sum_ms[i] = e->hist_count[i] > 1 ? e->hist_sum_ms[i] / 2 : 0;
+            e->hist_count[i] /= 2;
+            e->hist_total = (uint16_t)(e->hist_total + e->hist_count[i]);
+        }
+    }
+}
+
+const predict_stats_t *predict_get_stats(void) {
+    return &stats;
+}
+
+void predict_print_stats(FILE *out) {
+    if (config.model == PREDICT_OFF) return;
+    double mae = stats.samples ? (double)stats.abs_error_ms / (double)stats.samples : 0.0;
+    double rel = stats.actual_ms ? 100.0 * (double)stats.abs_error_ms / (double)stats.actual_ms : 0.0;
+    double under = stats.samples ? 100.0 * (double)stats.under / (double)stats.samples : 0.0;
+    fprintf(out, "Burst prediction (%s, alpha %.2f, first guess %u ms): %llu bursts, "
+                 "mean abs error %.1f ms (%.1f%% of CPU time), %.1f%% under-predicted, %u pids\n",
+            predict_model_name(config.model), config.alpha, config.initial_ms,
+            (unsigned long long)stats.samples, mae, rel, under, used);
+}
+
+void predict_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &config, sizeof(config));
+    ckpt_put(c, &stats, sizeof(stats));
+    ckpt_put(c, &used, sizeof(used));
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (table[i].used) ckpt_put(c, &table[i], sizeof(entry_t));
+    }
+}
+
+int predict_restore(ckpt_t *c) {
+    predict_config_t cfg;
+    predict_stats_t st;
+    uint32_t n;
+    ckpt_get(c, &cfg, sizeof(cfg));
+    ckpt_get(c, &st, sizeof(st));
+    ckpt_get(c, &n, sizeof(n));
+    if (c->error || cfg.model > PREDICT_HIST || predict_init(&cfg) < 0) return -1;
+    stats = st;
+
+    for (uint32_t i = 0; i < n && !c->error; i++) {
+        entry_t rec;
+        ckpt_get(c, &rec, sizeof(rec));
+        entry_t *e = c->error ? NULL : lookup_or_insert(rec.pid);
+        if (!e) return -1;
+        *e = rec;
+    }
+    return c->error ? -1 : 0;
+}
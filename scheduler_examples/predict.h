@@ -0,0 +1,106 @@
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ckpt.h"
+
+/*
+ * Previsão da duração do próximo burst de CPU de cada processo, para o SJF
+ * e o SRTF não usarem o time_ms declarado pelo cliente (que um sistema real
+ * não conhece). O histórico de cada pid fica numa tabela de hash com
+ * endereçamento aberto (procura O(1) em média) e é alimentado com o tempo
+ * de CPU que cada burst realmente usou.
+ *
+ * O estado é _Thread_local, como o dos escalonadores, para o schedcmp poder
+ * correr uma simulação com previsão por thread.
+ */
+
+// Modelos de previsão suportados
+typedef enum {
+    PREDICT_OFF = 0,            // usa o time_ms declarado (SJF "oráculo")
+    PREDICT_EWMA,               // média exponencial: tau' = alpha*t + (1-alpha)*tau
+    PREDICT_HIST                // histograma log2 dos bursts recentes (mediana)
+} predict_model_en;
+
+// Configuração do preditor
+typedef struct {
+    predict_model_en model;
+    double alpha;               // peso do último burst (EWMA), em ]0, 1]
+    uint32_t initial_ms;        // previsão para um pid sem histórico
+} predict_config_t;
+
+// Contadores de erro (previsão contra o tempo de CPU usado)
+typedef struct {
+    uint64_t samples;           // bursts terminados com previsão
+    uint64_t abs_error_ms;      // soma de |previsto - usado|
+    uint64_t actual_ms;         // soma do tempo usado
+    uint64_t under;             // bursts que duraram mais do que o previsto
+} predict_stats_t;
+
+/**
+ * @brief Converte o nome de um modelo (OFF, EWMA, HIST)
+ *
+ * @return 0 em caso de sucesso, -1 se o nome não for reconhecido
+ */
+int predict_model_from_name(const char *name, predict_model_en *out);
+
+const char *predict_model_name(predict_model_en model);
+
+/**
+ * @brief Configura o preditor da thread atual (apaga o histórico)
+ *
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+int predict_init(const predict_config_t *cfg);
+
+/**
+ * @brief Liberta a tabela da thread atual
+ */
+void predict_shutdown(void);
+
+/**
+ * @brief Indica se há um modelo ativo (diferente de PREDICT_OFF)
+ */
+int predict_enabled(void);
+
+/**
+ * @brief Estimativa para o próximo burst de CPU de um processo
+ *
+ * @param pid O processo
+ * @return A duração prevista em ms (initial_ms se não houver histórico)
+ */
+uint32_t predict_burst(int32_t pid);
+
+/**
+ * @brief Regista a duração real de um burst que terminou
+ *
+ * Atualiza o histórico do pid e os contadores de erro. Não faz nada se o
+ * preditor estiver desligado.
+ *
+ * @param pid O processo
+ * @param predicted_ms A estimativa usada para escalonar o burst
+ * @param actual_ms O tempo de CPU que o burst usou
+ */
+void predict_observe(int32_t pid, uint32_t predicted_ms, uint32_t actual_ms);
+
+const predict_stats_t *predict_get_stats(void);
+
+void predict_print_stats(FILE *out);
+
+/**
+ * @brief Escreve a configuração, os contadores e o histórico de cada pid
+ */
+void predict_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui o estado atual pelo de um checkpoint
+ *
+ * A configuração do checkpoint prevalece sobre a da linha de comandos.
+ *
+ * @return 0 em caso de sucesso, -1 se o checkpoint estiver corrompido
+ */
+int predict_restore(ckpt_t *c);
+
+#endif // PREDICT_H
@@ -0,0 +1,331 @@
+#include "proc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PROC_CHUNK   256        // entradas por bloco
+#define MIN_CAPACITY 64
+#define MIN_FDS      64
+
+// Bloco de entradas: nunca é realocado, só libertado no fim
+typedef struct proc_chunk_st {
+    struct proc_chunk_st *next;
+    uint32_t used;
+    proc_t entries[PROC_CHUNK];
+} proc_chunk_t;
+
+static proc_t **slots = NULL;           // hash com endereçamento aberto (NULL = livre)
+static uint32_t capacity = 0;           // potência de 2
+static uint32_t count = 0;              // entradas na tabela, vivas e terminadas
+static uint32_t live = 0;
+static proc_chunk_t *chunks = NULL;     // o primeiro é o que está a ser preenchido
+static proc_t *free_entries = NULL;     // entradas recicladas, ligadas por link
+
+// Processos vivos de cada ligação, indexados pelo sockfd e ligados por link
+static proc_t **by_fd = NULL;
+static uint32_t by_fd_len = 0;
+
+// Processos terminados pela ordem em que saíram, ligados por link
+static proc_t *exited_head = NULL;
+static proc_t *exited_tail = NULL;
+static uint32_t exited = 0;
+
+// Processos reciclados: ficam só os totais e os que tiveram mais CPU
+static uint32_t retired = 0;
+static uint64_t retired_cpu_ms = 0;
+static uint64_t retired_io_ms = 0;
+static proc_t retired_top[PROC_TOP_KEPT];
+static uint32_t retired_top_len = 0;
+
+// Hash multiplicativo (Fibonacci): os pids seguidos ficam espalhados
+static uint32_t slot_of(int32_t pid, uint32_t cap) {
+    return ((uint32_t)pid * 2654435769u) & (cap - 1);
+}
+
+static int grow(void) {
+    uint32_t cap = capacity ? capacity * 2 : MIN_CAPACITY;
+    proc_t **s = calloc(cap, sizeof(proc_t *));
+    if (!s) return -1;
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (!slots[i]) continue;
+        uint32_t j = slot_of(slots[i]->pid, cap);
+        while (s[j]) j = (j + 1) & (cap - 1);
+        s[j] = slots[i];
+    }
+    free(slots);
+    slots = s;
+    capacity = cap;
+    return 0;
+}
+
+static proc_t *alloc_entry(void) {
+    proc_t *e = free_entries;
+    if (e) {
+        free_entries = e->link;
+    } else {
+        if (!chunks || chunks->used == PROC_CHUNK) {
+            proc_chunk_t *c = malloc(sizeof(proc_chunk_t));
+            if (!c) return NULL;
+            c->next = chunks;
+            c->used = 0;
+            chunks = c;
+        }
+        e = &chunks->entries[chunks->used++];
+    }
+    memset(e, 0, sizeof(*e));
+    return e;
+}
+
+// Acrescenta uma entrada nova para o pid (pode já haver outras, de processos que saíram)
+static proc_t *insert(int32_t pid) {
+    // Fator de carga até 1/2: as sequências de procura ficam curtas
+    if ((count + 1) * 2 > capacity && grow() < 0) return NULL;
+    proc_t *e = alloc_entry();
+    if (!e) return NULL;
+    e->pid = pid;
+    uint32_t i = slot_of(pid, capacity);
+    while (slots[i]) i = (i + 1) & (capacity - 1);
+    slots[i] = e;
+    count++;
+    return e;
+}
+
+// Tira a entrada do hash, puxando para trás as que estavam depois dela na
+// sequência de procura (sem lápides, as procuras continuam curtas)
+static void remove_slot(const proc_t *e) {
+    uint32_t mask = capacity - 1;
+    uint32_t hole = slot_of(e->pid, capacity);
+    while (slots[hole] != e) hole = (hole + 1) & mask;
+    for (uint32_t i = (hole + 1) & mask; slots[i]; i = (i + 1) & mask) {
+        uint32_t home = slot_of(slots[i]->pid, capacity);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole] = NULL;
+    count--;
+}
+
+// Garante a cabeça de lista do sockfd antes de criar a entrada
+static int reserve_fd(uint32_t sockfd) {
+    if (sockfd == CKPT_ORPHAN_FD || sockfd < by_fd_len) return 0;
+    uint32_t len = by_fd_len ? by_fd_len : MIN_FDS;
+    while (len <= sockfd) len *= 2;
+    proc_t **heads = realloc(by_fd, len * sizeof(proc_t *));
+    if (!heads) return -1;
+    memset(heads + by_fd_len, 0, (len - by_fd_len) * sizeof(proc_t *));
+    by_fd = heads;
+    by_fd_len = len;
+    return 0;
+}
+
+static void track_live(proc_t *e) {
+    live++;
+    // Os órfãos de um restore não têm ligação que se desligue
+    if (e->sockfd == CKPT_ORPHAN_FD) return;
+    e->link = by_fd[e->sockfd];
+    by_fd[e->sockfd] = e;
+}
+
+static void push_exited(proc_t *e) {
+    e->link = NULL;
+    if (exited_tail) exited_tail->link = e;
+    else exited_head = e;
+    exited_tail = e;
+    exited++;
+}
+
+// Mais CPU primeiro; em caso de empate, o pid mais baixo
+static int cpu_before(const proc_t *a, const proc_t *b) {
+    if (a->cpu_ms != b->cpu_ms) return a->cpu_ms > b->cpu_ms;
+    return a->pid < b->pid;
+}
+
+// Recicla o processo que saiu há mais tempo: conta nos totais e, se estiver
+// entre os que tiveram mais CPU, é copiado para o relatório
+static void retire_oldest(void) {
+    proc_t *e = exited_head;
+    exited_head = e->link;
+    if (!exited_head) exited_tail = NULL;
+    exited--;
+
+    retired++;
+    retired_cpu_ms += e->cpu_ms;
+    retired_io_ms += e->io_ms;
+    if (retired_top_len < PROC_TOP_KEPT) {
+        retired_top[retired_top_len++] = *e;
+    } else {
+        uint32_t last = 0;
+        for (uint32_t i = 1; i < PROC_TOP_KEPT; i++) {
+            if (cpu_before(&retired_top[last], &retired_top[i])) last = i;
+        }
+        if (cpu_before(e, &retired_top[last])) retired_top[last] = *e;
+    }
+
+    remove_slot(e);
+    e->link = free_entries;
+    free_entries = e;
+}
+
+int proc_init(void) {
+    proc_shutdown();
+    return grow();
+}
+
+void proc_shutdown(void) {
+    while (chunks) {
+        proc_chunk_t *next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+    free(slots);
+    free(by_fd);
+    slots = NULL;
+    by_fd = NULL;
+    free_entries = NULL;
+    exited_head = exited_tail = NULL;
+    capacity = count = live = by_fd_len = exited = 0;
+    retired = retired_top_len = 0;
+    retired_cpu_ms = retired_io_ms = 0;
+}
+
+proc_t *proc_find(int32_t pid, uint32_t sockfd) {
+    if (!slots) return NULL;
+    for (uint32_t i = slot_of(pid, capacity); slots[i]; i = (i + 1) & (capacity - 1)) {
+        const proc_t *e = slots[i];
+        if (e->pid == pid && e->sockfd == sockfd && !e->exited) return slots[i];
+    }
+    return NULL;
+}
+
+proc_t *proc_of(pcb_t *p, uint32_t now_ms) {
+    proc_t *e = p->cold->proc;
+    if (!e) {
+        // O mesmo pid noutra ligação, ou depois de o cliente sair, é outro
+        // processo: cada PCB aponta sempre para uma entrada da sua ligação
+        e = proc_find(p->pid, p->cold->sockfd);
+        if (!e) {
+            if (reserve_fd(p->cold->sockfd) < 0) return NULL;
+            e = insert(p->pid);
+            if (!e) return NULL;
+            e->first_seen_ms = now_ms;
+            e->sockfd = p->cold->sockfd;
+            track_live(e);
+        }
+        p->cold->proc = e;
+    }
+    e->last_seen_ms = now_ms;
+    return e;
+}
+
+uint32_t proc_client_closed(uint32_t sockfd) {
+    if (sockfd >= by_fd_len) return 0;
+    uint32_t n = 0;
+    proc_t *e = by_fd[sockfd];
+    by_fd[sockfd] = NULL;
+    while (e) {
+        proc_t *next = e->link;
+        e->exited = 1;
+        push_exited(e);
+        e = next;
+        n++;
+    }
+    live -= n;
+    // Os PCBs do cliente já não existem: ninguém aponta para as entradas recicladas
+    while (exited > PROC_MAX_EXITED) retire_oldest();
+    return n;
+}
+
+uint32_t proc_count(void) {
+    return count + retired;
+}
+
+uint32_t proc_live(void) {
+    return live;
+}
+
+static int by_cpu_desc(const void *a, const void *b) {
+    const proc_t *pa = *(proc_t *const *)a, *pb = *(proc_t *const *)b;
+    return cpu_before(pb, pa) - cpu_before(pa, pb);
+}
+
+void proc_print_stats(FILE *out, uint32_t top) {
+    if (count + retired == 0) return;
+    proc_t **all = malloc((size_t)(count + retired_top_len) * sizeof(proc_t *));
+    if (!all) return;
+
+    uint32_t n = 0;
+    uint64_t cpu_ms = retired_cpu_ms, io_ms = retired_io_ms;
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (!slots[i]) continue;
+        all[n++] = slots[i];
+        cpu_ms += slots[i]->cpu_ms;
+        io_ms += slots[i]->io_ms;
+    }
+    for (uint32_t i = 0; i < retired_top_len; i++) all[n++] = &retired_top[i];
+    qsort(all, n, sizeof(proc_t *), by_cpu_desc);
+
+    fprintf(out, "Processes: %u seen, %u live, %llu ms of CPU and %llu ms of I/O in total\n",
+            count + retired, live, (unsigned long long)cpu_ms, (unsigned long long)io_ms);
+    if (retired > 0) {
+        fprintf(out, "  (%u exited processes recycled; only the top %u of them by CPU are kept)\n",
+                retired, retired_top_len);
+    }
+    if (top > n) top = n;
+    fprintf(out, "  %11s %7s %10s %10s %10s %6s %6s %12s\n",
+            "pid", "bursts", "cpu ms", "io ms", "dispatches", "level", "max", "lifetime ms");
+    for (uint32_t i = 0; i < top; i++) {
+        const proc_t *e = all[i];
+        fprintf(out, "  %11d %7u %10llu %10llu %10u %6u %6u %12u%s\n",
+                e->pid, e->bursts, (unsigned long long)e->cpu_ms, (unsigned long long)e->io_ms,
+                e->dispatches, e->last_level, e->max_level, e->last_seen_ms - e->first_seen_ms,
+                e->exited ? "" : " (live)");
+    }
+    free(all);
+}
+
+void proc_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &count, sizeof(count));
+    // Os vivos primeiro, depois os terminados pela ordem em que saíram
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (slots[i] && !slots[i]->exited) ckpt_put(c, slots[i], sizeof(proc_t));
+    }
+    for (const proc_t *e = exited_head; e; e = e->link) ckpt_put(c, e, sizeof(proc_t));
+
+    ckpt_put(c, &retired, sizeof(retired));
+    ckpt_put(c, &retired_cpu_ms, sizeof(retired_cpu_ms));
+    ckpt_put(c, &retired_io_ms, sizeof(retired_io_ms));
+    ckpt_put(c, &retired_top_len, sizeof(retired_top_len));
+    ckpt_put(c, retired_top, retired_top_len * sizeof(proc_t));
+}
+
+int proc_restore(ckpt_t *c) {
+    uint32_t n;
+    ckpt_get(c, &n, sizeof(n));
+    if (c->error || proc_init() < 0) return -1;
+
+    for (uint32_t i = 0; i < n && !c->error; i++) {
+        proc_t rec;
+        ckpt_get(c, &rec, sizeof(rec));
+        if (c->error) return -1;
+        if (!rec.exited) {
+            rec.sockfd = (c->fd_map && rec.sockfd < c->fd_map_len) ? c->fd_map[rec.sockfd] : CKPT_ORPHAN_FD;
+            if (reserve_fd(rec.sockfd) < 0) return -1;
+        }
+        proc_t *e = insert(rec.pid);
+        if (!e) return -1;
+        *e = rec;
+        if (e->exited) push_exited(e);
+        else track_live(e);
+    }
+
+    ckpt_get(c, &retired, sizeof(retired));
+    ckpt_get(c, &retired_cpu_ms, sizeof(retired_cpu_ms));
+    ckpt_get(c, &retired_io_ms, sizeof(retired_io_ms));
+    ckpt_get(c, &retired_top_len, sizeof(retired_top_len));
+    if (c->error || retired_top_len > PROC_TOP_KEPT) return -1;
+    ckpt_get(c, retired_top, retired_top_len * sizeof(proc_t));
+    while (exited > PROC_MAX_EXITED) retire_oldest();
+    return c->error ? -1 : 0;
+}
@@ -0,0 +1,123 @@
+#ifndef PROC_H
+#define PROC_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "queue.h"
+#include "ckpt.h"
+
+/*
+ * Tabela de processos: o estado de cada pid que dura entre bursts. Os PCBs
+ * continuam a ser um por pedido (RUN ou BLOCK), mas apontam para a entrada
+ * do seu processo (pcb->cold->proc), onde se acumulam o tempo de CPU e de
+ * I/O, os despachos e o histórico do nível MLFQ, sem ajuda do cliente.
+ *
+ * A tabela é um hash com endereçamento aberto indexado pelo pid; as
+ * entradas vivem em blocos que nunca se movem, pelo que os ponteiros
+ * guardados nos PCBs continuam válidos quando a tabela cresce. Um pid
+ * reutilizado noutra ligação, ou depois de o cliente sair, é outro processo
+ * e tem a sua entrada.
+ *
+ * Os processos vivos de cada ligação formam uma lista (link), pelo que
+ * desligar um cliente só percorre os seus. Os terminados ficam numa fila
+ * pela ordem em que saíram; acima de PROC_MAX_EXITED o mais antigo é
+ * reciclado e só sobram os totais e, para o relatório, os PROC_TOP_KEPT
+ * com mais CPU. A tabela fica limitada aos vivos mais PROC_MAX_EXITED.
+ */
+
+#define PROC_MAX_EXITED 4096    // processos terminados guardados por inteiro
+#define PROC_TOP_KEPT   16      // reciclados guardados para o relatório
+
+struct proc_st {
+    int32_t pid;
+    uint32_t sockfd;                // ligação do cliente (CKPT_ORPHAN_FD depois de um restore)
+    uint8_t exited;                 // o cliente desligou-se
+    uint8_t last_level;             // nível MLFQ do último despacho
+    uint8_t max_level;              // nível MLFQ mais baixo a que chegou
+    uint8_t reserved;
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+    uint32_t last_ran_ms;           // último tick no CPU (aquecimento da cache, swcost.h)
+    uint32_t swcost_owed_us;        // custo das trocas ainda não cobrado (menos de um tick)
+    uint32_t bursts;                // pedidos RUN
+    uint32_t io_requests;           // pedidos BLOCK
+    uint32_t dispatches;            // vezes que ganhou o CPU (inclui regressos após preempção)
+    uint64_t cpu_ms;                // ticks passados no CPU
+    uint64_t io_ms;                 // tempo bloqueado, desde o BLOCK até ao DONE
+    struct proc_st *link;           // lista da ligação, fila dos terminados ou entradas livres
+};
+
+/**
+ * @brief Cria a tabela vazia
+ *
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+int proc_init(void);
+
+/**
+ * @brief Liberta a tabela e todas as entradas
+ */
+void proc_shutdown(void);
+
+/**
+ * @brief Entrada do processo de um PCB, criada se ainda não existir
+ *
+ * Liga o PCB à entrada (pcb->cold->proc). Um pid que ainda não tem entrada
+ * viva na ligação do PCB começa uma nova. Os PCBs restaurados de um
+ * checkpoint são ligados na primeira chamada.
+ *
+ * @param p O PCB
+ * @param now_ms Tempo atual da simulação
+ * @return A entrada, ou NULL sem memória
+ */
+proc_t *proc_of(pcb_t *p, uint32_t now_ms);
+
+/**
+ * @brief Procura um pid sem criar a entrada
+ *
+ * @return A entrada viva do pid nessa ligação, ou NULL
+ */
+proc_t *proc_find(int32_t pid, uint32_t sockfd);
+
+/**
+ * @brief Marca como terminados os processos de um cliente que se desligou
+ *
+ * Só percorre os processos dessa ligação. Tem de ser chamada depois de
+ * libertar todos os PCBs do cliente, porque as entradas terminadas mais
+ * antigas são recicladas.
+ *
+ * @return O número de processos marcados
+ */
+uint32_t proc_client_closed(uint32_t sockfd);
+
+/**
+ * @brief Processos vistos desde o início, incluindo os reciclados
+ */
+uint32_t proc_count(void);
+
+uint32_t proc_live(void);
+
+/**
+ * @brief Escreve os totais e os processos com mais tempo de CPU
+ *
+ * @param top Número máximo de processos listados
+ */
+void proc_print_stats(FILE *out, uint32_t top);
+
+/**
+ * @brief Escreve as entradas da tabela (vivas, depois os terminados pela
+ * ordem em que saíram) e os totais dos reciclados
+ */
+void proc_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui a tabela pela de um checkpoint
+ *
+ * Os sockfd são traduzidos pelo fd_map do checkpoint, como os dos PCBs.
+ *
+ * @return 0 em caso de sucesso, -1 se o checkpoint estiver corrompido
+ */
+int proc_restore(ckpt_t *c);
+
+#endif // PROC_H
@@ -3,25 +3,62 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// PCBs are carved from slabs that are never freed, so a pcb pointer stays
+// valid; free pcbs are chained through their queue element. Each thread has
+// its own pool (schedcmp runs one simulation per thread).
+#define PCB_SLAB 1024
+
+static _Thread_local queue_elem_t *free_pcbs = NULL;
+
+static int grow_pool(void) {
+    pcb_t *hot = aligned_alloc(_Alignof(pcb_t), PCB_SLAB * sizeof(pcb_t));
+    pcb_cold_t *cold = malloc(PCB_SLAB * sizeof(pcb_cold_t));
+    if (!hot || !cold) {
+        free(hot);
+        free(cold);
+        return -1;
+    }
+    // Chained backwards, so the pool hands out the slab in address order
+    for (int i = PCB_SLAB - 1; i >= 0; i--) {
+        hot[i].cold = &cold[i];
+        hot[i].node.pcb = &hot[i];
+        hot[i].node.next = free_pcbs;
+        free_pcbs = &hot[i].node;
+    }
+    return 0;
+}
+
 pcb_t *new_pcb(pid_t pid, uint32_t sockfd, uint32_t time_ms) {
-    pcb_t * new_task = malloc(sizeof(pcb_t));
-    if (!new_task) return NULL;
+    if (!free_pcbs && grow_pool() < 0) return NULL;
+    pcb_t *new_task = free_pcbs->pcb;
+    free_pcbs = free_pcbs->next;
 
+    new_task->node.next = NULL;
     new_task->pid = pid;
-    new_task->status = TASK_COMMAND;
     new_task->slice_start_ms = 0;
-    new_task->priority_level = 0;   // <-- NOVO: começa no nível mais alto do MLFQ
-    new_task->sockfd = sockfd;
+    new_task->priority_level = 0;   // começa no nível mais alto do MLFQ
     new_task->time_ms = time_ms;
+    new_task->estimate_ms = time_ms;
     new_task->ellapsed_time_ms = 0;
+
+    pcb_cold_t *cold = new_task->cold;
+    cold->status = TASK_COMMAND;
+    cold->sockfd = sockfd;
+    cold->last_update_time_ms = 0;
+    cold->pages.count = 0;
+    cold->group = 0;
+    cold->proc = NULL;
     return new_task;
 }
 
-int enqueue_pcb(queue_t* q, pcb_t* task) {
-    queue_elem_t* elem = malloc(sizeof(queue_elem_t));
-    if (!elem) return 0;
+void free_pcb(pcb_t *task) {
+    if (!task) return;
+    task->node.next = free_pcbs;
+    free_pcbs = &task->node;
+}
 
-    elem->pcb = task;
+int enqueue_pcb(queue_t* q, pcb_t* task) {
+    queue_elem_t* elem = &task->node;
     elem->next = NULL;
 
     if (q->tail) {
@@ -30,6 +67,7 @@ int enqueue_pcb(queue_t* q, pcb_t* task) {
         q->head = elem;
     }
     q->tail = elem;
+    q->count++;
     return 1;
 }
 
@@ -42,8 +80,9 @@ pcb_t* dequeue_pcb(queue_t* q) {
     q->head = node->next;
     if (!q->head)
         q->tail = NULL;
+    q->count--;
 
-    free(node);
+    node->next = NULL;
     return task;
 }
 
@@ -61,6 +100,8 @@ queue_elem_t *remove_queue_elem(queue_t* q, queue_elem_t* elem) {
             if (it == q->tail) {
                 q->tail = prev;
             }
+            q->count--;
+            it->next = NULL;
             return it;
         }
         prev = it;
@@ -68,4 +109,24 @@ queue_elem_t *remove_queue_elem(queue_t* q, queue_elem_t* elem) {
     }
     printf("Queue element not found in queue\n");
     return NULL;
-}
\ No newline at end of file
+}
+
+uint32_t remove_pcbs_by_sockfd(queue_t* q, uint32_t sockfd) {
+    uint32_t removed = 0;
+    queue_elem_t** link = &q->head;
+    queue_elem_t* prev = NULL;
+    while (*link) {
+        queue_elem_t* it = *link;
+        if (it->pcb->cold->sockfd == sockfd) {
+            *link = it->next;
+            if (it == q->tail) q->tail = prev;
+            q->count--;
+            free_pcb(it->pcb);
+            removed++;
+            continue;
+        }
+        prev = it;
+        link = &it->next;
+    }
+    return removed;
+}
@@ -2,6 +2,8 @@
 #define QUEUE_H
 #include <stdint.h>
 
+#include "msg.h"
+
 typedef enum  {
     TASK_COMMAND = 0,   // Task has connected and is waiting for instructions
     TASK_BLOCKED,       // Task is blocked (waiting/IO wait)
@@ -10,36 +12,56 @@ typedef enum  {
     TASK_TERMINATED,    // Task has been terminated and will be removed
 } task_status_en;
 
-// Define the Process Control Block (PCB) structure
-typedef struct pcb_st{
-    int32_t pid;                   // Process ID
-    task_status_en status;         // Current status of the task defined by the pcb
-    uint32_t time_ms;              // Time requested by application in milliseconds
-    uint32_t ellapsed_time_ms;     // Time ellapsed since start in milliseconds
-    uint32_t slice_start_ms;       // Time when the current time slice started
-    uint32_t sockfd;               // Socket file descriptor for communication with the application
-    uint32_t last_update_time_ms;  // Last time the PCB was updataed
-    uint8_t  priority_level;     // <-- NOVO: nível de prioridade para MLFQ (0..NUM_QUEUES-1)
-} pcb_t;
-
-// Define singly linked list elements
+// Define singly linked list elements. Every pcb carries its own element
+// (a pcb is in at most one queue at a time), so queues never allocate.
+typedef struct pcb_st pcb_t;
 typedef struct queue_elem_st queue_elem_t;
+typedef struct proc_st proc_t;     // Long-lived per-process state (proc.h)
 typedef struct queue_elem_st {
     pcb_t *pcb;
     queue_elem_t *next;
 } queue_elem_t;
 
+// Cold PCB data: only touched when a request arrives, when a reply is sent
+// or when the client disconnects
+typedef struct {
+    uint32_t sockfd;               // Socket file descriptor for communication with the application
+    task_status_en status;         // Current status of the task defined by the pcb
+    uint32_t last_update_time_ms;  // Last time the PCB was updataed
+    page_info_t pages;             // Páginas referenciadas pelo burst
+    uint32_t group;                // Group (tenant) sent by the client, for fair share (group.h)
+    proc_t *proc;                  // Process this burst belongs to (NULL until proc_of links it)
+} pcb_cold_t;
+
+// Define the Process Control Block (PCB) structure. Only the fields the
+// policies read every tick live here, packed in one cache line together
+// with the queue element; the rest is in a cold side table (pcb->cold).
+// PCBs come from per-thread pools (new_pcb / free_pcb), so the pcbs of a
+// queue sit next to each other in memory.
+struct pcb_st {
+    _Alignas(64) queue_elem_t node; // Element used by the queue that holds this pcb
+    uint32_t time_ms;              // Time requested by application in milliseconds
+    uint32_t ellapsed_time_ms;     // Time ellapsed since start in milliseconds
+    uint32_t slice_start_ms;       // Time when the current time slice started
+    uint32_t estimate_ms;          // Burst length SJF/SRTF order by: time_ms, or a prediction (predict.h)
+    int32_t pid;                   // Process ID
+    uint8_t  priority_level;       // Nível de prioridade para MLFQ (0..NUM_QUEUES-1)
+    pcb_cold_t *cold;              // Connection and accounting data
+};
+
 // Define the queue structure
 // We define the head and the tail to make it easier to enqueue and dequeue
 typedef struct queue_st  {
     queue_elem_t* head;
     queue_elem_t* tail;
+    uint32_t count;     // Number of elements, so the depth can be read in O(1)
 } queue_t;
 
 /**
  * @brief Create a new pcb (process control block)
  *
- * This function allocates memory for a new pcb and initializes its fields.
+ * This function takes a pcb (and its cold data) from the pool of the calling
+ * thread and initializes its fields.
  *
  * @param pid The process ID of the task
  * @param sockfd The socket file descriptor for communication with the application
@@ -48,6 +70,13 @@ typedef struct queue_st  {
  */
 pcb_t *new_pcb(int32_t pid, uint32_t sockfd, uint32_t time_ms);
 
+/**
+ * @brief Return a pcb to the pool (NULL is ignored)
+ *
+ * The pcb must not be in any queue.
+ */
+void free_pcb(pcb_t *task);
+
 /**
  * @brief Enqueue a pcb into the queue
  *
@@ -55,7 +84,7 @@ pcb_t *new_pcb(int32_t pid, uint32_t sockfd, uint32_t time_ms);
  *
  * @param q The queue to which the pcb will be added
  * @param task The pcb to be added to the queue
- * @return The number of pcb enqueued (0 on failure)
+ * @return The number of pcb enqueued (always 1)
  */
 int enqueue_pcb(queue_t* q, pcb_t* task);
 
@@ -73,7 +102,7 @@ pcb_t* dequeue_pcb(queue_t* q);
  * @brief Remove a specific element from the queue
  *
  * This function removes a specific element from the queue.
- * Neither the element, nor the pcb inside the element, are freed.
+ * The element belongs to its pcb, so only the pcb is freed (free_pcb).
  *
  * @param q The queue from which the element will be removed
  * @param elem The element to be removed from the queue
@@ -81,5 +110,16 @@ pcb_t* dequeue_pcb(queue_t* q);
  */
 queue_elem_t *remove_queue_elem(queue_t* q, queue_elem_t* elem);
 
+/**
+ * @brief Remove and free every pcb that belongs to a socket
+ *
+ * Used when a client disconnects, since its pending requests can no longer
+ * be answered.
+ *
+ * @param q The queue to clean
+ * @param sockfd The socket of the client that disconnected
+ * @return The number of pcbs removed
+ */
+uint32_t remove_pcbs_by_sockfd(queue_t* q, uint32_t sockfd);
 
 #endif //QUEUE_H
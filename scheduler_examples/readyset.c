@@ -0,0 +1,228 @@
+#include "readyset.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define READY_SET_X86 1
+#endif
+
+#define KEY_ALIGN 32            // one AVX2 vector
+
+typedef uint32_t (*min_scan_fn)(const uint32_t *keys, uint32_t n);
+
+// Every scan returns the index of the first smallest key among keys[0..n),
+// n being a multiple of 8, or n when every key is READY_SET_EMPTY.
+
+static uint32_t min_scan_scalar(const uint32_t *keys, uint32_t n) {
+    uint32_t best = n;
+    uint32_t best_key = READY_SET_EMPTY;
+    for (uint32_t i = 0; i < n; i++) {
+        if (keys[i] < best_key) {
+            best_key = keys[i];
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef READY_SET_X86
+// First pass: smallest key; second pass: first lane equal to it
+__attribute__((target("sse4.1")))
+static uint32_t min_scan_sse41(const uint32_t *keys, uint32_t n) {
+    __m128i vmin = _mm_set1_epi32(-1);
+    for (uint32_t i = 0; i < n; i += 4) {
+        vmin = _mm_min_epu32(vmin, _mm_load_si128((const __m128i *)(keys + i)));
+    }
+    vmin = _mm_min_epu32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+    vmin = _mm_min_epu32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t min = (uint32_t)_mm_cvtsi128_si32(vmin);
+    if (min == READY_SET_EMPTY) return n;
+
+    for (uint32_t i = 0; i < n; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)(keys + i)), vmin);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask) return i + (uint32_t)__builtin_ctz((unsigned)mask);
+    }
+    return n;
+}
+
+__attribute__((target("avx2")))
+static uint32_t min_scan_avx2(const uint32_t *keys, uint32_t n) {
+    __m256i vmin = _mm256_set1_epi32(-1);
+    for (uint32_t i = 0; i < n; i += 8) {
+        vmin = _mm256_min_epu32(vmin, _mm256_load_si256((const __m256i *)(keys + i)));
+    }
+    __m128i m = _mm_min_epu32(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t min = (uint32_t)_mm_cvtsi128_si32(m);
+    if (min == READY_SET_EMPTY) return n;
+
+    __m256i target = _mm256_set1_epi32((int)min);
+    for (uint32_t i = 0; i < n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)(keys + i)), target);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask) return i + (uint32_t)__builtin_ctz((unsigned)mask);
+    }
+    return n;
+}
+#endif
+
+static min_scan_fn g_scan = NULL;      // chosen on first use
+
+ready_set_isa_en ready_set_best_isa(void) {
+#ifdef READY_SET_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return READY_SET_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return READY_SET_SSE41;
+#endif
+    return READY_SET_SCALAR;
+}
+
+int ready_set_use_isa(ready_set_isa_en isa) {
+    if (isa > ready_set_best_isa()) return -1;
+    switch (isa) {
+#ifdef READY_SET_X86
+        case READY_SET_AVX2:
+            g_scan = min_scan_avx2;
+            break;
+        case READY_SET_SSE41:
+            g_scan = min_scan_sse41;
+            break;
+#endif
+        default:
+            g_scan = min_scan_scalar;
+            break;
+    }
+    return 0;
+}
+
+const char *ready_set_isa_name(ready_set_isa_en isa) {
+    switch (isa) {
+        case READY_SET_AVX2:  return "AVX2";
+        case READY_SET_SSE41: return "SSE4.1";
+        default:              return "scalar";
+    }
+}
+
+static uint32_t round_up8(uint32_t n) {
+    return (n + 7u) & ~7u;
+}
+
+// Move the arrays to a new capacity, dropping the tombstones (order is kept)
+static int resize(ready_set_t *rs, uint32_t cap) {
+    cap = round_up8(cap < 8 ? 8 : cap);
+    uint32_t *keys = aligned_alloc(KEY_ALIGN, (size_t)cap * sizeof(uint32_t));
+    pcb_t **pcbs = malloc((size_t)cap * sizeof(pcb_t *));
+    if (!keys || !pcbs) {
+        free(keys);
+        free(pcbs);
+        return -1;
+    }
+
+    uint32_t len = 0;
+    for (uint32_t i = 0; i < rs->len; i++) {
+        if (!rs->pcbs[i]) continue;
+        keys[len] = rs->keys[i];
+        pcbs[len] = rs->pcbs[i];
+        len++;
+    }
+    memset(keys + len, 0xff, (size_t)(cap - len) * sizeof(uint32_t));
+
+    free(rs->keys);
+    free(rs->pcbs);
+    rs->keys = keys;
+    rs->pcbs = pcbs;
+    rs->len = len;
+    rs->cap = cap;
+    return 0;
+}
+
+// Compact in place once more than half of the used slots are tombstones
+static void maybe_compact(ready_set_t *rs) {
+    if (rs->len < 64 || rs->len - rs->live <= rs->live) return;
+    uint32_t len = 0;
+    for (uint32_t i = 0; i < rs->len; i++) {
+        if (!rs->pcbs[i]) continue;
+        rs->keys[len] = rs->keys[i];
+        rs->pcbs[len] = rs->pcbs[i];
+        len++;
+    }
+    memset(rs->keys + len, 0xff, (size_t)(rs->len - len) * sizeof(uint32_t));
+    rs->len = len;
+}
+
+static pcb_t *take(ready_set_t *rs, uint32_t i) {
+    pcb_t *p = rs->pcbs[i];
+    rs->keys[i] = READY_SET_EMPTY;
+    rs->pcbs[i] = NULL;
+    rs->live--;
+    if (rs->live == 0) {
+        // Empty again: restart from slot 0 (the keys are all EMPTY already)
+        rs->len = 0;
+    } else {
+        maybe_compact(rs);
+    }
+    return p;
+}
+
+int ready_set_init(ready_set_t *rs, uint32_t cap) {
+    memset(rs, 0, sizeof(*rs));
+    if (!g_scan) ready_set_use_isa(ready_set_best_isa());
+    return resize(rs, cap);
+}
+
+void ready_set_free(ready_set_t *rs) {
+    for (uint32_t i = 0; i < rs->len; i++) free_pcb(rs->pcbs[i]);
+    free(rs->keys);
+    free(rs->pcbs);
+    memset(rs, 0, sizeof(*rs));
+}
+
+int ready_set_add(ready_set_t *rs, pcb_t *p, uint32_t key) {
+    if (rs->len == rs->cap) {
+        // Full of tombstones: compacting is enough; otherwise double
+        uint32_t cap = rs->live * 2 <= rs->cap ? rs->cap : rs->cap * 2;
+        if (resize(rs, cap) < 0) return 0;
+    }
+    rs->keys[rs->len] = key < READY_SET_EMPTY ? key : READY_SET_EMPTY - 1;
+    rs->pcbs[rs->len] = p;
+    rs->len++;
+    rs->live++;
+    return 1;
+}
+
+pcb_t *ready_set_pop_min(ready_set_t *rs) {
+    if (rs->live == 0) return NULL;
+    uint32_t n = round_up8(rs->len);
+    uint32_t i = g_scan(rs->keys, n);
+    return i < rs->len ? take(rs, i) : NULL;
+}
+
+pcb_t *ready_set_pop_oldest(ready_set_t *rs) {
+    for (uint32_t i = 0; i < rs->len; i++) {
+        if (rs->pcbs[i]) return take(rs, i);
+    }
+    return NULL;
+}
+
+uint32_t ready_set_remove_sockfd(ready_set_t *rs, uint32_t sockfd) {
+    uint32_t removed = 0;
+    for (uint32_t i = 0; i < rs->len; i++) {
+        if (rs->pcbs[i] && rs->pcbs[i]->cold->sockfd == sockfd) {
+            free_pcb(rs->pcbs[i]);
+            rs->pcbs[i] = NULL;
+            rs->keys[i] = READY_SET_EMPTY;
+            rs->live--;
+            removed++;
+        }
+    }
+    if (rs->live == 0) {
+        rs->len = 0;
+    } else {
+        maybe_compact(rs);
+    }
+    return removed;
+}
@@ -0,0 +1,87 @@
+#ifndef READYSET_H
+#define READYSET_H
+
+#include <stdint.h>
+
+#include "queue.h"
+
+/*
+ * Structure-of-arrays ready set for policies that pick by key (SJF picks the
+ * shortest time_ms). The keys live in one contiguous, 32-byte aligned array,
+ * so the pick is a vectorized min-scan (AVX2 or SSE4.1 when the CPU has them,
+ * scalar otherwise) instead of a pointer chase through queue_elem_t -> pcb_t.
+ *
+ * Entries keep their insertion order and ties go to the oldest entry, like a
+ * scan of a queue_t with a strict '<'. Removed entries become tombstones (key
+ * READY_SET_EMPTY) and are compacted away once they outnumber the live ones.
+ */
+
+#define READY_SET_EMPTY UINT32_MAX     // tombstone / padding key; real keys are clamped below it
+
+typedef enum {
+    READY_SET_SCALAR = 0,
+    READY_SET_SSE41,
+    READY_SET_AVX2,
+} ready_set_isa_en;
+
+typedef struct {
+    uint32_t *keys;     // cap entries, READY_SET_EMPTY past len
+    pcb_t **pcbs;       // NULL for tombstones
+    uint32_t len;       // used slots (live + tombstones)
+    uint32_t live;
+    uint32_t cap;       // multiple of 8
+} ready_set_t;
+
+/**
+ * @brief Initialize an empty ready set
+ *
+ * @return 0 on success, -1 if the arrays could not be allocated
+ */
+int ready_set_init(ready_set_t *rs, uint32_t cap);
+
+/**
+ * @brief Free the arrays (and any pcb still in the set)
+ */
+void ready_set_free(ready_set_t *rs);
+
+/**
+ * @brief Append a pcb with the given key
+ *
+ * @return 1 on success, 0 if the set could not grow
+ */
+int ready_set_add(ready_set_t *rs, pcb_t *p, uint32_t key);
+
+/**
+ * @brief Remove and return the pcb with the smallest key (oldest on ties)
+ *
+ * @return The pcb, or NULL if the set is empty
+ */
+pcb_t *ready_set_pop_min(ready_set_t *rs);
+
+/**
+ * @brief Remove and return the oldest pcb (insertion order)
+ */
+pcb_t *ready_set_pop_oldest(ready_set_t *rs);
+
+/**
+ * @brief Remove and free every pcb that belongs to a socket
+ *
+ * @return The number of pcbs removed
+ */
+uint32_t ready_set_remove_sockfd(ready_set_t *rs, uint32_t sockfd);
+
+/**
+ * @brief Best min-scan the CPU supports
+ */
+ready_set_isa_en ready_set_best_isa(void);
+
+/**
+ * @brief Select the min-scan used by every ready set (the best one by default)
+ *
+ * @return 0 on success, -1 if the CPU does not support it
+ */
+int ready_set_use_isa(ready_set_isa_en isa);
+
+const char *ready_set_isa_name(ready_set_isa_en isa);
+
+#endif //READYSET_H
@@ -1,15 +1,111 @@
 #include "queue.h"
 #include "msg.h"
+#include "trace.h"
+#include "stats.h"
+#include "conn.h"
+#include "hist.h"
+#include "ckpt.h"
 #include <stdlib.h>
-#include <stdio.h>    // para perror
-#include <unistd.h>   // para write()
+#include <stdio.h>
 
-#define TIME_SLICE 500 // quantum fixo de 500 ms para cada processo
+#define TIME_SLICE 500 // quantum de 500 ms para cada processo, por omissão
+#define BURST_COVER 2  // modo adaptativo: o quantum não passa de 2x o burst típico
+
+static _Thread_local uint32_t time_slice_ms = TIME_SLICE;
+
+// Modo adaptativo (target_ms > 0): o quantum é recalculado a cada despacho
+static _Thread_local uint32_t target_ms = 0;        // latência alvo: todos os prontos correm nesta janela
+static _Thread_local uint32_t min_slice_ms = 0;     // granularidade mínima
+static _Thread_local uint32_t burst_avg_ms = 0;     // média exponencial dos bursts terminados (0 = sem amostras)
+static _Thread_local uint32_t current_slice_ms = TIME_SLICE;
+
+// Resultados do modo adaptativo
+static _Thread_local hist_t slice_hist;             // quantum dado em cada despacho (ms)
+static _Thread_local hist_t response_hist;          // RUN → primeira vez no CPU (ms)
+
+/**
+ * Altera o quantum (variantes do schedcmp; uma simulação por thread).
+ */
+void rr_set_time_slice(uint32_t ms) {
+    time_slice_ms = ms;
+    current_slice_ms = ms;
+}
+
+/**
+ * Ativa o quantum adaptativo: a cada despacho passa a ser a latência alvo
+ * a dividir pelo número de processos prontos (incluindo o que vai correr),
+ * limitado a BURST_COVER vezes a média dos bursts recentes e nunca abaixo
+ * da granularidade mínima. Muitos clientes interativos recebem quanta
+ * curtos (resposta rápida); poucos processos CPU-bound recebem quanta
+ * longos (menos trocas de contexto).
+ */
+void rr_set_adaptive(uint32_t target, uint32_t min_slice) {
+    target_ms = target;
+    min_slice_ms = min_slice < TICKS_MS ? TICKS_MS : min_slice;
+    burst_avg_ms = 0;
+    hist_reset(&slice_hist);
+    hist_reset(&response_hist);
+}
+
+// Quantum para o próximo despacho, em múltiplos de TICKS_MS
+static uint32_t next_slice(const queue_t *rq) {
+    if (target_ms == 0) return time_slice_ms;
+    uint32_t slice = target_ms / (rq->count + 1);
+    if (burst_avg_ms > 0 && slice > BURST_COVER * burst_avg_ms) slice = BURST_COVER * burst_avg_ms;
+    if (slice < min_slice_ms) slice = min_slice_ms;
+    slice -= slice % TICKS_MS;
+    return slice;
+}
+
+/**
+ * Imprime o compromisso obtido pelo modo adaptativo: quantum médio e
+ * extremos, tempo de resposta, trocas de contexto e preempções.
+ */
+void rr_print_stats(FILE *out) {
+    if (target_ms == 0 || slice_hist.total == 0) return;
+    fprintf(out, "Adaptive RR (target %u ms, min slice %u ms): quantum avg %.1f ms (min %llu, max %llu) "
+                 "over %llu dispatches\n",
+            target_ms, min_slice_ms, (double)slice_hist.sum / (double)slice_hist.total,
+            (unsigned long long)slice_hist.min, (unsigned long long)slice_hist.max,
+            (unsigned long long)slice_hist.total);
+    fprintf(out, "  response avg %.1f ms, p95 %llu ms; %llu context switches, %llu preemptions "
+                 "(%.2f per burst)\n",
+            response_hist.total ? (double)response_hist.sum / (double)response_hist.total : 0.0,
+            (unsigned long long)hist_percentile(&response_hist, 95.0),
+            (unsigned long long)g_stats.context_switches, (unsigned long long)g_stats.preemptions,
+            g_stats.bursts_done ? (double)g_stats.preemptions / (double)g_stats.bursts_done : 0.0);
+}
+
+/**
+ * Escreve / restaura o estado do modo adaptativo (checkpoint e hot
+ * upgrade): sem a média dos bursts o quantum perdia o limite de
+ * BURST_COVER vezes o burst típico até haver novas amostras. As
+ * definições do checkpoint prevalecem sobre as da linha de comandos.
+ */
+void rr_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &target_ms, sizeof(target_ms));
+    ckpt_put(c, &min_slice_ms, sizeof(min_slice_ms));
+    ckpt_put(c, &burst_avg_ms, sizeof(burst_avg_ms));
+    ckpt_put(c, &current_slice_ms, sizeof(current_slice_ms));
+    ckpt_put(c, &slice_hist, sizeof(slice_hist));
+    ckpt_put(c, &response_hist, sizeof(response_hist));
+}
+
+int rr_restore(ckpt_t *c) {
+    ckpt_get(c, &target_ms, sizeof(target_ms));
+    ckpt_get(c, &min_slice_ms, sizeof(min_slice_ms));
+    ckpt_get(c, &burst_avg_ms, sizeof(burst_avg_ms));
+    ckpt_get(c, &current_slice_ms, sizeof(current_slice_ms));
+    ckpt_get(c, &slice_hist, sizeof(slice_hist));
+    ckpt_get(c, &response_hist, sizeof(response_hist));
+    return c->error ? -1 : 0;
+}
 
 /**
  * Algoritmo Round-Robin (RR)
  *
- * Este escalonador atribui a cada processo um tempo máximo de execução (TIME_SLICE).
+ * Este escalonador atribui a cada processo um tempo máximo de execução (TIME_SLICE,
+ * ou o quantum calculado por next_slice no modo adaptativo).
  * Quando o tempo se esgota, o processo perde o CPU e volta ao fim da fila,
  * garantindo que todos os processos tenham acesso regular à CPU.
  *
@@ -34,23 +130,32 @@ void rr_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
                 .request = PROCESS_REQUEST_DONE,
                 .time_ms = current_time_ms
             };
-            if (write((*cpu_task)->sockfd, &msg, sizeof msg) != sizeof msg) {
-                perror("write");
+            TRACE(TRACE_DONE, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.bursts_done++;
+            if (target_ms > 0) {
+                // Média exponencial com peso 1/8 para o burst mais recente
+                uint32_t burst = (*cpu_task)->ellapsed_time_ms;
+                burst_avg_ms = burst_avg_ms ? (7 * burst_avg_ms + burst + 4) / 8 : burst;
             }
+            conn_notify((*cpu_task)->cold->sockfd, &msg);
+            TRACE(TRACE_MSG_OUT, (*cpu_task)->pid, current_time_ms, PROCESS_REQUEST_DONE);
 
             // Liberta a memória do PCB e marca o CPU como livre
-            free(*cpu_task);
+            free_pcb(*cpu_task);
             *cpu_task = NULL;
         }
         // 1.b) Caso ainda não tenha terminado, verifica se o slice expirou
-        else if ((current_time_ms - (*cpu_task)->slice_start_ms) >= TIME_SLICE) {
+        else if ((current_time_ms - (*cpu_task)->slice_start_ms) >= current_slice_ms) {
             // Se não há mais processos prontos, o mesmo processo continua
             if (rq->head == NULL) {
                 // Reinicia o contador de slice para o mesmo processo
                 (*cpu_task)->slice_start_ms = current_time_ms;
+                current_slice_ms = next_slice(rq);
             } else {
                 // Há outros processos na fila → preempção
                 // Move o processo atual para o fim da fila e liberta o CPU
+                TRACE(TRACE_PREEMPT, (*cpu_task)->pid, current_time_ms, 0);
+                g_stats.preemptions++;
                 enqueue_pcb(rq, *cpu_task);
                 *cpu_task = NULL;
                 // O slice_start_ms será atualizado quando o processo voltar ao CPU
@@ -64,6 +169,13 @@ void rr_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
         if (*cpu_task) {
             // Regista o início do novo slice para o processo agora escolhido
             (*cpu_task)->slice_start_ms = current_time_ms;
+            current_slice_ms = next_slice(rq);
+            if (target_ms > 0) {
+                hist_record(&slice_hist, current_slice_ms);
+                if ((*cpu_task)->ellapsed_time_ms == 0) {
+                    hist_record(&response_hist, current_time_ms - (*cpu_task)->cold->last_update_time_ms);
+                }
+            }
         }
     }
 }
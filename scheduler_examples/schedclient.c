@@ -0,0 +1,424 @@
+#include "schedclient.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------
+// Interface bloqueante
+// ---------------------------------------------------------
+int sc_connect(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int sc_send(int fd, const msg_t *msg) {
+    const uint8_t *p = (const uint8_t *)msg;
+    size_t left = sizeof(msg_t);
+    while (left > 0) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("write");
+            return -1;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    return 0;
+}
+
+int sc_recv(int fd, msg_t *msg) {
+    uint8_t *p = (uint8_t *)msg;
+    size_t left = sizeof(msg_t);
+    while (left > 0) {
+        ssize_t n = read(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            return -1;
+        }
+        if (n == 0) {
+            fprintf(stderr, "Scheduler closed the connection\n");
+            return -1;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    return 0;
+}
+
+// Espera por uma resposta do tipo indicado (ou por um REJECT, se rejected
+// não for NULL: *rejected fica a 1 e time_ms recebe a espera sugerida)
+static int expect_reply(int fd, process_request_t expected, uint32_t *time_ms, int *rejected) {
+    msg_t msg;
+    if (sc_recv(fd, &msg) < 0) return -1;
+    if (rejected) *rejected = msg.request == PROCESS_REQUEST_REJECT;
+    if (msg.request != expected && !(rejected && *rejected)) {
+        printf("Received invalid request. Expected %s, received %s\n", PROCESS_REQUEST_STRINGS[expected],
+               msg.request <= PROCESS_REQUEST_REJECT ? PROCESS_REQUEST_STRINGS[msg.request] : "?");
+        return -1;
+    }
+    if (time_ms) *time_ms = msg.time_ms;
+    return 0;
+}
+
+int sc_request(int fd, pid_t pid, uint32_t group, process_request_t request, uint32_t time_ms,
+               const page_info_t *pages, uint32_t *ack_ms, uint32_t *done_ms) {
+    msg_t msg = {
+        .pid = pid,
+        .request = request,
+        .time_ms = time_ms,
+        .group = group
+    };
+    if (pages) msg.pages = *pages;
+
+    // Enquanto o controlo de admissão recusar o pedido, espera o que o
+    // scheduler indicar e volta a enviá-lo
+    int rejected;
+    do {
+        uint32_t reply_ms;
+        if (sc_send(fd, &msg) < 0) return -1;
+        if (expect_reply(fd, PROCESS_REQUEST_ACK, &reply_ms, &rejected) < 0) return -1;
+        if (rejected) {
+            usleep(reply_ms * 1000u);
+        } else if (ack_ms) {
+            *ack_ms = reply_ms;
+        }
+    } while (rejected);
+    return expect_reply(fd, PROCESS_REQUEST_DONE, done_ms, NULL);
+}
+
+// ---------------------------------------------------------
+// Interface event loop
+// ---------------------------------------------------------
+#define SC_RX_MSGS 64
+
+typedef struct {
+    int fd;
+    uint8_t rx[SC_RX_MSGS * sizeof(msg_t)];
+    uint32_t rx_len;
+    uint8_t *tx;                // bytes por enviar
+    size_t tx_len;
+    size_t tx_sent;
+    size_t tx_cap;
+} sc_conn_t;
+
+struct sc_app_st {
+    pid_t pid;
+    uint32_t group;
+    sc_loop_t *loop;
+    sc_conn_t *conn;
+    sc_callback_t callback;
+    void *user;
+    int finished;
+    msg_t last;                 // último pedido, para o repetir depois de um REJECT
+    uint64_t retry_at_ms;       // quando o repetir (relógio monotónico)
+    struct sc_app_st *next_retry;
+};
+
+struct sc_loop_st {
+    sc_conn_t *conns;
+    uint32_t conn_count;
+    uint32_t next_conn;             // próxima ligação a atribuir (round robin)
+
+    sc_app_t **apps;                // tabela pid -> aplicação (endereçamento aberto)
+    uint32_t app_mask;
+    uint32_t app_count;
+    uint32_t running;               // aplicações ainda não terminadas
+
+    sc_app_t *retries;              // aplicações à espera de repetir um pedido recusado
+    uint64_t rejections;            // REJECT recebidos
+};
+
+static uint32_t pid_hash(pid_t pid) {
+    return (uint32_t)pid * 2654435761u;
+}
+
+static sc_app_t **app_slot(sc_loop_t *loop, pid_t pid) {
+    uint32_t i = pid_hash(pid) & loop->app_mask;
+    while (loop->apps[i] && loop->apps[i]->pid != pid) i = (i + 1) & loop->app_mask;
+    return &loop->apps[i];
+}
+
+// Duplica a tabela de aplicações quando fica mais de metade cheia
+static int grow_apps(sc_loop_t *loop) {
+    sc_app_t **old = loop->apps;
+    uint32_t old_size = loop->app_mask + 1;
+    uint32_t size = old_size * 2;
+
+    loop->apps = calloc(size, sizeof(sc_app_t *));
+    if (!loop->apps) {
+        loop->apps = old;
+        return -1;
+    }
+    loop->app_mask = size - 1;
+    for (uint32_t i = 0; i < old_size; i++) {
+        if (old[i]) *app_slot(loop, old[i]->pid) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+sc_loop_t *sc_loop_create(const char *path, uint32_t connections) {
+    if (connections == 0) connections = 1;
+
+    sc_loop_t *loop = calloc(1, sizeof(sc_loop_t));
+    if (!loop) return NULL;
+    loop->conns = calloc(connections, sizeof(sc_conn_t));
+    loop->app_mask = 63;
+    loop->apps = calloc(loop->app_mask + 1, sizeof(sc_app_t *));
+    if (!loop->conns || !loop->apps) {
+        sc_loop_destroy(loop);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < connections; i++) {
+        int fd = sc_connect(path);
+        if (fd < 0) {
+            sc_loop_destroy(loop);
+            return NULL;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        loop->conns[i].fd = fd;
+        loop->conn_count++;
+    }
+    return loop;
+}
+
+void sc_loop_destroy(sc_loop_t *loop) {
+    if (!loop) return;
+    for (uint32_t i = 0; i < loop->conn_count; i++) {
+        close(loop->conns[i].fd);
+        free(loop->conns[i].tx);
+    }
+    if (loop->apps) {
+        for (uint32_t i = 0; i <= loop->app_mask; i++) free(loop->apps[i]);
+    }
+    free(loop->apps);
+    free(loop->conns);
+    free(loop);
+}
+
+sc_app_t *sc_app_add(sc_loop_t *loop, pid_t pid, sc_callback_t callback, void *user) {
+    if ((loop->app_count + 1) * 2 > loop->app_mask + 1 && grow_apps(loop) < 0) return NULL;
+
+    sc_app_t **slot = app_slot(loop, pid);
+    if (*slot) return NULL;
+
+    sc_app_t *app = malloc(sizeof(sc_app_t));
+    if (!app) return NULL;
+    app->pid = pid;
+    app->group = 0;
+    app->loop = loop;
+    app->conn = &loop->conns[loop->next_conn];
+    app->callback = callback;
+    app->user = user;
+    app->finished = 0;
+    app->next_retry = NULL;
+    loop->next_conn = (loop->next_conn + 1) % loop->conn_count;
+
+    *slot = app;
+    loop->app_count++;
+    loop->running++;
+    return app;
+}
+
+void sc_app_set_group(sc_app_t *app, uint32_t group) {
+    app->group = group;
+}
+
+// Coloca uma mensagem na fila de envio de uma ligação
+static int queue_msg(sc_conn_t *c, const msg_t *msg) {
+    if (c->tx_len + sizeof(msg_t) > c->tx_cap) {
+        size_t cap = c->tx_cap ? c->tx_cap * 2 : 16 * sizeof(msg_t);
+        while (cap < c->tx_len + sizeof(msg_t)) cap *= 2;
+        uint8_t *bigger = realloc(c->tx, cap);
+        if (!bigger) return -1;
+        c->tx = bigger;
+        c->tx_cap = cap;
+    }
+    memcpy(c->tx + c->tx_len, msg, sizeof(msg_t));
+    c->tx_len += sizeof(msg_t);
+    return 0;
+}
+
+int sc_app_request(sc_app_t *app, process_request_t request, uint32_t time_ms, const page_info_t *pages) {
+    msg_t msg = {
+        .pid = app->pid,
+        .request = request,
+        .time_ms = time_ms,
+        .group = app->group
+    };
+    if (pages) msg.pages = *pages;
+    app->last = msg;
+    return queue_msg(app->conn, &msg);
+}
+
+void sc_app_finish(sc_app_t *app) {
+    if (app->finished) return;
+    app->finished = 1;
+    app->loop->running--;
+}
+
+pid_t sc_app_pid(const sc_app_t *app) {
+    return app->pid;
+}
+
+uint64_t sc_loop_rejections(const sc_loop_t *loop) {
+    return loop->rejections;
+}
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+// Volta a enviar os pedidos recusados cuja espera já passou; timeout
+// recebe o tempo até ao próximo (-1 se não houver nenhum), para o poll
+static int send_retries(sc_loop_t *loop, int *timeout) {
+    uint64_t now = monotonic_ms();
+    *timeout = -1;
+    sc_app_t **link = &loop->retries;
+    while (*link) {
+        sc_app_t *app = *link;
+        if (app->retry_at_ms <= now) {
+            *link = app->next_retry;
+            app->next_retry = NULL;
+            if (queue_msg(app->conn, &app->last) < 0) return -1;
+            continue;
+        }
+        uint64_t wait = app->retry_at_ms - now;
+        if (*timeout < 0 || wait < (uint64_t)*timeout) *timeout = (int)wait;
+        link = &app->next_retry;
+    }
+    return 0;
+}
+
+// Envia o que estiver pendente sem bloquear
+static int flush_conn(sc_conn_t *c) {
+    while (c->tx_sent < c->tx_len) {
+        ssize_t n = write(c->fd, c->tx + c->tx_sent, c->tx_len - c->tx_sent);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            perror("write");
+            return -1;
+        }
+        c->tx_sent += (size_t)n;
+    }
+    c->tx_len = c->tx_sent = 0;
+    return 0;
+}
+
+// Entrega uma resposta à aplicação a que se destina
+static void dispatch_reply(sc_loop_t *loop, const msg_t *msg) {
+    sc_app_t *app = *app_slot(loop, msg->pid);
+    if (!app || app->finished) {
+        fprintf(stderr, "Reply %s for unknown pid %d\n",
+                msg->request <= PROCESS_REQUEST_REJECT ? PROCESS_REQUEST_STRINGS[msg->request] : "?", (int)msg->pid);
+        return;
+    }
+    if (msg->request == PROCESS_REQUEST_REJECT) {
+        // Recusado pelo controlo de admissão: repete o pedido mais tarde,
+        // sem a aplicação dar por isso
+        loop->rejections++;
+        app->retry_at_ms = monotonic_ms() + msg->time_ms;
+        app->next_retry = loop->retries;
+        loop->retries = app;
+        return;
+    }
+    app->callback(app, msg, app->user);
+}
+
+// Lê e entrega todas as respostas completas disponíveis numa ligação
+static int read_conn(sc_loop_t *loop, sc_conn_t *c) {
+    while (1) {
+        ssize_t n = read(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            perror("read");
+            return -1;
+        }
+        if (n == 0) {
+            fprintf(stderr, "Scheduler closed the connection\n");
+            return -1;
+        }
+        c->rx_len += (uint32_t)n;
+
+        uint32_t off = 0;
+        while (c->rx_len - off >= sizeof(msg_t)) {
+            msg_t msg;
+            memcpy(&msg, c->rx + off, sizeof(msg_t));
+            off += sizeof(msg_t);
+            dispatch_reply(loop, &msg);
+        }
+        memmove(c->rx, c->rx + off, c->rx_len - off);
+        c->rx_len -= off;
+    }
+}
+
+int sc_loop_run(sc_loop_t *loop) {
+    struct pollfd *fds = malloc(loop->conn_count * sizeof(struct pollfd));
+    if (!fds) return -1;
+
+    int result = 0;
+    while (loop->running > 0) {
+        int timeout;
+        if (send_retries(loop, &timeout) < 0) {
+            result = -1;
+            break;
+        }
+        for (uint32_t i = 0; i < loop->conn_count; i++) {
+            sc_conn_t *c = &loop->conns[i];
+            if (flush_conn(c) < 0) {
+                result = -1;
+                goto out;
+            }
+            fds[i].fd = c->fd;
+            fds[i].events = POLLIN | (c->tx_len > c->tx_sent ? POLLOUT : 0);
+            fds[i].revents = 0;
+        }
+
+        if (poll(fds, loop->conn_count, timeout) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            result = -1;
+            break;
+        }
+
+        for (uint32_t i = 0; i < loop->conn_count; i++) {
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && read_conn(loop, &loop->conns[i]) < 0) {
+                result = -1;
+                goto out;
+            }
+        }
+    }
+
+out:
+    free(fds);
+    return result;
+}
@@ -0,0 +1,133 @@
+#ifndef SCHEDCLIENT_H
+#define SCHEDCLIENT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "msg.h"
+
+/*
+ * Biblioteca cliente do scheduler (libschedclient).
+ *
+ * Tem duas interfaces:
+ *  - bloqueante: uma ligação por aplicação, cada pedido espera pelo ACK e
+ *    pelo DONE (é a usada pelo app e pelo app-io);
+ *  - event loop: um processo simula muitas aplicações virtuais, repartidas
+ *    por uma ou mais ligações. As respostas são entregues por callback,
+ *    identificadas pelo pid do msg_t.
+ *
+ * Nas duas, um pedido recusado pelo controlo de admissão do scheduler
+ * (REJECT) é repetido pela biblioteca depois da espera indicada no
+ * time_ms da resposta; a aplicação só vê o ACK e o DONE.
+ */
+
+// ---------------------------------------------------------
+// Interface bloqueante
+// ---------------------------------------------------------
+
+/**
+ * @brief Liga-se ao socket do scheduler
+ *
+ * @return fd da ligação, ou -1 em caso de erro
+ */
+int sc_connect(const char *path);
+
+/**
+ * @brief Envia uma mensagem completa (repete em escritas parciais)
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int sc_send(int fd, const msg_t *msg);
+
+/**
+ * @brief Recebe uma mensagem completa (repete em leituras parciais)
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro ou fim da ligação
+ */
+int sc_recv(int fd, msg_t *msg);
+
+/**
+ * @brief Envia um pedido RUN ou BLOCK e espera pelo ACK e pelo DONE
+ *
+ * Se o pedido for recusado (REJECT), dorme o tempo indicado e volta a
+ * enviá-lo.
+ *
+ * @param group grupo da aplicação (msg_group_from_name, 0 = nenhum)
+ * @param pages páginas referenciadas pelo burst (NULL = nenhuma)
+ * @param ack_ms se não for NULL, recebe o tempo de simulação do ACK
+ * @param done_ms se não for NULL, recebe o tempo de simulação do DONE
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int sc_request(int fd, pid_t pid, uint32_t group, process_request_t request, uint32_t time_ms,
+               const page_info_t *pages, uint32_t *ack_ms, uint32_t *done_ms);
+
+// ---------------------------------------------------------
+// Interface event loop
+// ---------------------------------------------------------
+typedef struct sc_loop_st sc_loop_t;
+typedef struct sc_app_st sc_app_t;
+
+/**
+ * @brief Chamada quando chega uma resposta (ACK ou DONE) para uma aplicação
+ *
+ * Os REJECT não chegam à aplicação: o pedido é repetido pelo sc_loop_run.
+ *
+ * Pode fazer novos pedidos (sc_app_request) ou terminar a aplicação
+ * (sc_app_finish).
+ */
+typedef void (*sc_callback_t)(sc_app_t *app, const msg_t *reply, void *user);
+
+/**
+ * @brief Abre um event loop com o número de ligações indicado
+ *
+ * @return o loop, ou NULL em caso de erro
+ */
+sc_loop_t *sc_loop_create(const char *path, uint32_t connections);
+
+/**
+ * @brief Fecha as ligações e liberta o loop e todas as aplicações
+ */
+void sc_loop_destroy(sc_loop_t *loop);
+
+/**
+ * @brief Regista uma aplicação virtual (as ligações são atribuídas em round robin)
+ *
+ * @return a aplicação, ou NULL se o pid já existir ou não houver memória
+ */
+sc_app_t *sc_app_add(sc_loop_t *loop, pid_t pid, sc_callback_t callback, void *user);
+
+/**
+ * @brief Define o grupo enviado nos pedidos da aplicação (por omissão 0, nenhum)
+ */
+void sc_app_set_group(sc_app_t *app, uint32_t group);
+
+/**
+ * @brief Coloca um pedido na fila de envio da ligação da aplicação
+ *
+ * O envio é feito pelo sc_loop_run, sem bloquear. Cada aplicação deve ter
+ * um só pedido à espera de resposta: é esse que é repetido após um REJECT.
+ *
+ * @return 0 em caso de sucesso, -1 se não houver memória
+ */
+int sc_app_request(sc_app_t *app, process_request_t request, uint32_t time_ms, const page_info_t *pages);
+
+/**
+ * @brief Marca a aplicação como terminada (deixa de contar para o sc_loop_run)
+ */
+void sc_app_finish(sc_app_t *app);
+
+pid_t sc_app_pid(const sc_app_t *app);
+
+/**
+ * @brief Pedidos recusados pelo scheduler (e repetidos) desde que o loop abriu
+ */
+uint64_t sc_loop_rejections(const sc_loop_t *loop);
+
+/**
+ * @brief Troca mensagens com o scheduler até todas as aplicações terminarem
+ *
+ * @return 0 quando todas terminaram, -1 se uma ligação falhar
+ */
+int sc_loop_run(sc_loop_t *loop);
+
+#endif //SCHEDCLIENT_H
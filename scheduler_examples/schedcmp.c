@@ -0,0 +1,768 @@
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "msg.h"
+#include "queue.h"
+#include "burst_queue.h"
+#include "conn.h"
+#include "stats.h"
+#include "hist.h"
+#include "fifo.h"
+#include "predict.h"
+#include "swcost.h"
+#include "group.h"
+
+/*
+ * Compara várias políticas de escalonamento sobre a mesma carga.
+ *
+ * Cada política (e cada variante, p.ex. RR com outro quantum) corre numa
+ * thread própria, com os mesmos escalonadores do scheduler (fifo.c, sjf.c,
+ * srtf.c, rr.c, mlfq.c) mas com o tempo simulado: não há sockets nem usleep, e as
+ * aplicações virtuais respondem a cada DONE no tick seguinte, tal como o
+ * app-multi ligado ao scheduler. O estado dos escalonadores e os contadores
+ * (g_stats) são _Thread_local, pelo que as simulações não partilham nada
+ * além da carga, que é só lida.
+ *
+ * As aplicações pertencem ao grupo do nome do seu ficheiro (A-5.csv → "A"),
+ * como no app-multi; FAIR:RR (ou FAIR:FIFO, FAIR:SJF, FAIR:RR:N) reparte o
+ * CPU entre os grupos antes de o repartir entre as aplicações (group.h).
+ *
+ * Run like: ./schedcmp --apps=40 --policies=FIFO,SJF,RR,MLFQ,RR:100 A-5.csv B-5.csv
+ */
+
+// Protótipos dos escalonadores (definidos em sjf.c, srtf.c, rr.c e mlfq.c)
+void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+void srtf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+void rr_scheduler (uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+void rr_set_time_slice(uint32_t ms);
+void rr_set_adaptive(uint32_t target_ms, uint32_t min_slice_ms);
+void mlfq_init(void);
+void mlfq_set_time_slice(uint32_t ms);
+void enqueue_mlfq(pcb_t *pcb);
+void mlfq_scheduler(uint32_t current_time_ms, queue_t *rq /*unused*/, pcb_t **cpu_task);
+
+#define MAX_RUNS 16
+
+typedef void (*policy_fn)(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task);
+
+typedef struct {
+    const char *name;
+    policy_fn run;
+    void (*set_time_slice)(uint32_t ms);    // NULL se a política não tiver quantum
+    int predicts;                           // ordena por estimate_ms (aceita SJF:EWMA, ...)
+    void (*set_adaptive)(uint32_t target_ms, uint32_t min_slice_ms);   // NULL se não houver RR:AUTO
+} policy_t;
+
+static const policy_t POLICIES[] = {
+    {"FIFO", fifo_scheduler, NULL, 0, NULL},
+    {"SJF",  sjf_scheduler,  NULL, 1, NULL},
+    {"RR",   rr_scheduler,   rr_set_time_slice, 0, rr_set_adaptive},
+    {"MLFQ", mlfq_scheduler, mlfq_set_time_slice, 0, NULL},
+    {"SRTF", srtf_scheduler, NULL, 1, NULL},
+};
+
+typedef struct {
+    burst_t *bursts;
+    uint32_t count;
+    uint32_t group;                 // msg_group_from_name do ficheiro
+    uint32_t group_idx;             // índice em g_groups
+} workload_t;
+
+// Aplicação virtual: segue os bursts de um ficheiro, como no app-multi
+typedef struct {
+    const workload_t *work;
+    uint32_t next;                  // índice do burst em curso
+    process_request_t pending;      // pedido à espera de DONE
+    uint32_t submit_ms;             // tick em que o RUN chegou ao escalonador
+    int dispatched;                 // o RUN em curso já teve o CPU
+    int has_run;                    // já esteve no CPU alguma vez (cache)
+    uint32_t last_ran_ms;           // último tick no CPU
+    uint32_t swcost_owed_us;        // custo das trocas ainda não cobrado
+} vapp_t;
+
+typedef struct {
+    // Configuração
+    const policy_t *policy;
+    uint32_t time_slice_ms;         // 0 = o da política
+    predict_model_en model;         // PREDICT_OFF = time_ms declarado (oráculo)
+    int adaptive;                   // quantum adaptativo (RR:AUTO)
+    int fair;                       // a política corre dentro de cada grupo (FAIR:...)
+    char name[32];
+
+    // Resultados
+    hist_t turnaround;              // ms, por burst de CPU (RUN → DONE)
+    hist_t response;                // ms, RUN → primeira vez no CPU
+    hist_t waiting;                 // ms, turnaround menos o tempo de CPU
+    sched_stats_t stats;
+    predict_stats_t predict;
+    swcost_stats_t swcost;
+    uint64_t ticks;
+    uint64_t busy_ticks;
+    uint32_t end_ms;
+    // Parte de cada grupo (índice em g_groups) nos ticks em que mais de um
+    // grupo tinha bursts por acabar, e a que os pesos lhe davam
+    uint32_t *group_pending;        // bursts de CPU por acabar
+    uint64_t *group_cpu_ms;
+    double *group_owed_ms;
+
+    // Estado da simulação
+    vapp_t *apps;
+    uint32_t *inbox;                // aplicações com um pedido para o próximo tick
+    uint32_t inbox_count;
+    uint32_t *next_inbox;
+    uint32_t next_inbox_count;
+    uint32_t running;               // aplicações que ainda não terminaram
+    pthread_t thread;
+} run_t;
+
+// Parâmetros comuns a todas as simulações (só lidos pelas threads)
+static const workload_t *g_work;
+static uint32_t g_nfiles;
+static uint32_t g_apps;
+static uint32_t g_stagger_ms;
+static double g_predict_alpha = 0.5;
+static uint32_t g_predict_initial_ms = 100;
+static uint32_t g_rr_target_ms = 500;
+static uint32_t g_rr_min_slice_ms = 20;
+static swcost_config_t g_swcost = {.dispatch_us = 0, .warmup_us = 0, .warmup_decay_ms = 100};
+static uint32_t *g_groups;          // grupos distintos dos ficheiros, por ordem
+static uint32_t *g_group_weights;   // peso de cada grupo (--group-weights)
+static uint32_t g_ngroups;
+static const char *g_group_weight_list;
+static uint32_t g_group_slice_ms = 100;
+
+// Simulação desta thread, para o conn_notify
+static _Thread_local run_t *tls_run;
+
+// ---------------------------------------------------------
+// Aplicações virtuais
+// ---------------------------------------------------------
+
+/**
+ * Os escalonadores entregam os DONE com conn_notify: aqui o "socket" é a
+ * aplicação virtual, que envia o pedido seguinte no próximo tick.
+ */
+void conn_notify(uint32_t sockfd, const msg_t *msg) {
+    (void)sockfd;
+    run_t *r = tls_run;
+    uint32_t idx = (uint32_t)msg->pid;
+    if (!r || idx >= g_apps) return;
+    vapp_t *v = &r->apps[idx];
+    const burst_t *b = &v->work->bursts[v->next];
+
+    if (v->pending == PROCESS_REQUEST_RUN) {
+        uint32_t turnaround = msg->time_ms - v->submit_ms;
+        uint32_t cpu = b->burst_time_ms;
+        hist_record(&r->turnaround, turnaround);
+        hist_record(&r->waiting, turnaround > cpu ? turnaround - cpu : 0);
+        r->group_pending[v->work->group_idx]--;
+        if (b->block_time_ms > 0) {
+            v->pending = PROCESS_REQUEST_BLOCK;
+            r->next_inbox[r->next_inbox_count++] = idx;
+            return;
+        }
+    }
+    if (++v->next >= v->work->count) {
+        r->running--;
+        if (msg->time_ms > r->end_ms) r->end_ms = msg->time_ms;
+        return;
+    }
+    v->pending = PROCESS_REQUEST_RUN;
+    r->next_inbox[r->next_inbox_count++] = idx;
+}
+
+// Entrega o pedido de uma aplicação ao escalonador (como o handle_request)
+static void submit_request(run_t *r, uint32_t idx, queue_t *ready_q, queue_t *blocked_q, uint32_t now_ms) {
+    vapp_t *v = &r->apps[idx];
+    const burst_t *b = &v->work->bursts[v->next];
+    g_stats.acks_sent++;
+
+    if (v->pending == PROCESS_REQUEST_RUN) {
+        pcb_t *p = new_pcb((int32_t)idx, 0, b->burst_time_ms);
+        if (!p) return;
+        if (predict_enabled()) p->estimate_ms = predict_burst(p->pid);
+        p->cold->status = TASK_RUNNING;
+        p->cold->last_update_time_ms = now_ms;
+        p->cold->pages = b->pages;
+        p->cold->group = v->work->group;
+        v->submit_ms = now_ms;
+        v->dispatched = 0;
+        r->group_pending[v->work->group_idx]++;
+        if (r->policy->run == mlfq_scheduler) {
+            enqueue_mlfq(p);
+        } else {
+            enqueue_pcb(ready_q, p);
+        }
+        g_stats.requests_run++;
+    } else {
+        pcb_t *p = new_pcb((int32_t)idx, 0, b->block_time_ms);
+        if (!p) return;
+        p->cold->status = TASK_BLOCKED;
+        p->ellapsed_time_ms = 0;
+        p->cold->last_update_time_ms = now_ms;
+        p->cold->group = v->work->group;
+        enqueue_pcb(blocked_q, p);
+        g_stats.requests_block++;
+    }
+}
+
+// I/O em paralelo, como o scheduler sem --io-devices
+static void check_blocked_queue(queue_t *blocked_q, uint32_t now_ms) {
+    queue_elem_t *it = blocked_q->head;
+    while (it) {
+        pcb_t *p = it->pcb;
+        p->ellapsed_time_ms += TICKS_MS;
+        if (p->ellapsed_time_ms < p->time_ms) {
+            it = it->next;
+            continue;
+        }
+
+        msg_t done = {.pid = p->pid, .request = PROCESS_REQUEST_DONE, .time_ms = now_ms};
+        g_stats.blocks_done++;
+        conn_notify(p->cold->sockfd, &done);
+
+        queue_elem_t *to_remove = it;
+        it = it->next;
+        queue_elem_t *removed = remove_queue_elem(blocked_q, to_remove);
+        if (removed) {
+            free_pcb(removed->pcb);
+        }
+    }
+}
+
+// Um tick disputado por mais de um grupo conta para a parte de cada grupo
+static void account_group_share(run_t *r, const pcb_t *cpu_task) {
+    uint32_t active = 0;
+    uint64_t weight = 0;
+    for (uint32_t k = 0; k < g_ngroups; k++) {
+        if (r->group_pending[k] == 0) continue;
+        active++;
+        weight += g_group_weights[k];
+    }
+    if (active < 2 || !cpu_task) return;
+    r->group_cpu_ms[r->apps[cpu_task->pid].work->group_idx] += TICKS_MS;
+    for (uint32_t k = 0; k < g_ngroups; k++) {
+        if (r->group_pending[k] > 0) r->group_owed_ms[k] += (double)TICKS_MS * g_group_weights[k] / (double)weight;
+    }
+}
+
+// ---------------------------------------------------------
+// Uma simulação (uma thread)
+// ---------------------------------------------------------
+
+static void *run_simulation(void *arg) {
+    run_t *r = arg;
+    tls_run = r;
+    memset(&g_stats, 0, sizeof(g_stats));
+    if (r->policy->run == mlfq_scheduler) mlfq_init();
+    if (r->time_slice_ms > 0) r->policy->set_time_slice(r->time_slice_ms);
+    if (r->adaptive) r->policy->set_adaptive(g_rr_target_ms, g_rr_min_slice_ms);
+    swcost_init(&g_swcost);
+    predict_config_t predict_cfg = {
+        .model = r->model,
+        .alpha = g_predict_alpha,
+        .initial_ms = g_predict_initial_ms
+    };
+    if (predict_init(&predict_cfg) < 0) {
+        fprintf(stderr, "%s: failed to allocate the burst history table\n", r->name);
+        exit(EXIT_FAILURE);
+    }
+    policy_fn run = r->policy->run;
+    if (r->fair) {
+        group_config_t group_cfg = {
+            .policy = r->policy->run,
+            .policy_name = r->policy->name,
+            .slice_ms = g_group_slice_ms
+        };
+        if (group_init(&group_cfg) < 0 ||
+            (g_group_weight_list && group_set_weights(g_group_weight_list) < 0)) {
+            fprintf(stderr, "%s: failed to allocate the group table\n", r->name);
+            exit(EXIT_FAILURE);
+        }
+        run = group_scheduler;
+    }
+
+    queue_t ready_queue   = {.head = NULL, .tail = NULL};
+    queue_t blocked_queue = {.head = NULL, .tail = NULL};
+    pcb_t *cpu_task = NULL;
+
+    for (uint32_t i = 0; i < g_apps; i++) {
+        r->apps[i].work = &g_work[i % g_nfiles];
+        r->apps[i].pending = PROCESS_REQUEST_RUN;
+    }
+    r->running = g_apps;
+
+    // As aplicações chegam por ordem, a cada --stagger-ms
+    uint32_t next_arrival = 0;
+    uint32_t now_ms = 0;
+    while (r->running > 0) {
+        // 1) Pedidos novos: chegadas e respostas aos DONE do tick anterior
+        uint32_t *tmp = r->inbox;
+        r->inbox = r->next_inbox;
+        r->inbox_count = r->next_inbox_count;
+        r->next_inbox = tmp;
+        r->next_inbox_count = 0;
+        while (next_arrival < g_apps && next_arrival * g_stagger_ms <= now_ms) {
+            submit_request(r, next_arrival++, &ready_queue, &blocked_queue, now_ms);
+        }
+        for (uint32_t i = 0; i < r->inbox_count; i++) {
+            submit_request(r, r->inbox[i], &ready_queue, &blocked_queue, now_ms);
+        }
+
+        // 2) I/O
+        check_blocked_queue(&blocked_queue, now_ms);
+
+        // 3) Escalonador
+        pcb_t *prev_task = cpu_task;
+        run(now_ms, &ready_queue, &cpu_task);
+        if (cpu_task && cpu_task != prev_task) {
+            g_stats.context_switches++;
+            vapp_t *v = &r->apps[cpu_task->pid];
+            if (!v->dispatched) {
+                v->dispatched = 1;
+                hist_record(&r->response, now_ms - v->submit_ms);
+            }
+            uint32_t switch_ms = swcost_dispatch(now_ms - v->last_ran_ms, !v->has_run, &v->swcost_owed_us);
+            cpu_task->time_ms += switch_ms;
+            cpu_task->estimate_ms += switch_ms;
+        }
+        if (cpu_task) {
+            r->apps[cpu_task->pid].has_run = 1;
+            r->apps[cpu_task->pid].last_ran_ms = now_ms;
+            r->busy_ticks++;
+        }
+        account_group_share(r, cpu_task);
+        r->ticks++;
+
+        now_ms += TICKS_MS;
+    }
+
+    // Todas as aplicações terminaram: as filas já estão vazias
+    free_pcb(cpu_task);
+    while (ready_queue.head) free_pcb(dequeue_pcb(&ready_queue));
+    while (blocked_queue.head) free_pcb(dequeue_pcb(&blocked_queue));
+    r->stats = g_stats;
+    r->predict = *predict_get_stats();
+    r->swcost = *swcost_get_stats();
+    predict_shutdown();
+    group_shutdown();
+    return NULL;
+}
+
+// ---------------------------------------------------------
+// Linha de comandos e resultados
+// ---------------------------------------------------------
+
+static int parse_u32(const char *opt, const char *value, uint32_t *out) {
+    char *endptr;
+    errno = 0;
+    unsigned long v = strtoul(value, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || v > UINT32_MAX) {
+        fprintf(stderr, "Invalid value for --%s: %s\n", opt, value);
+        return -1;
+    }
+    *out = (uint32_t)v;
+    return 0;
+}
+
+// "FIFO,SJF,RR:100,..." → uma simulação por elemento
+static int parse_policies(char *list, run_t *runs, uint32_t *nruns) {
+    *nruns = 0;
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        if (*nruns >= MAX_RUNS) {
+            fprintf(stderr, "At most %d policies can be compared\n", MAX_RUNS);
+            return -1;
+        }
+        run_t *r = &runs[(*nruns)++];
+        char *slice = strchr(tok, ':');
+        if (slice) *slice++ = '\0';
+        if (slice && strcasecmp(tok, "FAIR") == 0) {
+            // FAIR:RR:100 → RR:100 dentro de cada grupo
+            r->fair = 1;
+            tok = slice;
+            slice = strchr(tok, ':');
+            if (slice) *slice++ = '\0';
+        }
+
+        for (size_t i = 0; i < sizeof(POLICIES) / sizeof(POLICIES[0]); i++) {
+            if (strcasecmp(tok, POLICIES[i].name) == 0) r->policy = &POLICIES[i];
+        }
+        if (!r->policy) {
+            fprintf(stderr, "Invalid scheduler '%s'. Use FIFO, SJF, RR, MLFQ or SRTF.\n", tok);
+            return -1;
+        }
+        if (r->fair && r->policy->run != fifo_scheduler && r->policy->run != sjf_scheduler &&
+            r->policy->run != rr_scheduler) {
+            fprintf(stderr, "FAIR runs FIFO, SJF or RR inside each group\n");
+            return -1;
+        }
+        if (slice && r->policy->predicts && predict_model_from_name(slice, &r->model) == 0) {
+            snprintf(r->name, sizeof(r->name), "%s%s:%s", r->fair ? "FAIR:" : "", r->policy->name,
+                     predict_model_name(r->model));
+        } else if (slice && r->policy->set_adaptive && strcasecmp(slice, "AUTO") == 0) {
+            // O quantum adaptativo é um só para o módulo: misturava os grupos
+            if (r->fair) {
+                fprintf(stderr, "FAIR:%s:AUTO is not supported: the adaptive quantum would be shared by all groups\n",
+                        r->policy->name);
+                return -1;
+            }
+            r->adaptive = 1;
+            snprintf(r->name, sizeof(r->name), "%s%s:AUTO", r->fair ? "FAIR:" : "", r->policy->name);
+        } else if (slice) {
+            if (!r->policy->set_time_slice) {
+                fprintf(stderr, "%s has no time slice%s\n", r->policy->name,
+                        r->policy->predicts ? "; use EWMA or HIST to predict bursts" : "");
+                return -1;
+            }
+            if (parse_u32("policies", slice, &r->time_slice_ms) < 0) return -1;
+            if (r->time_slice_ms == 0 || r->time_slice_ms % TICKS_MS != 0) {
+                fprintf(stderr, "The time slice must be a multiple of %d ms\n", TICKS_MS);
+                return -1;
+            }
+            snprintf(r->name, sizeof(r->name), "%s%s:%u", r->fair ? "FAIR:" : "", r->policy->name, r->time_slice_ms);
+        } else {
+            snprintf(r->name, sizeof(r->name), "%s%s", r->fair ? "FAIR:" : "", r->policy->name);
+        }
+    }
+    if (*nruns == 0) {
+        fprintf(stderr, "No policy to compare\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Lê um ficheiro de bursts para um array (CSV ou binário)
+static int load_workload(const char *path, workload_t *w) {
+    burst_queue_t q = {.head = NULL, .tail = NULL};
+    int n = read_queue_from_file(&q, path);
+    if (n <= 0) {
+        fprintf(stderr, "Failed to read burst file %s\n", path);
+        return -1;
+    }
+
+    w->bursts = malloc((size_t)n * sizeof(burst_t));
+    if (!w->bursts) return -1;
+    w->count = 0;
+    w->group = msg_group_from_name(path);
+    burst_t *b;
+    while ((b = dequeue_burst(&q)) != NULL) {
+        w->bursts[w->count++] = *b;
+        free(b);
+    }
+    return 0;
+}
+
+static double hist_mean(const hist_t *h) {
+    return h->total ? (double)h->sum / (double)h->total : 0.0;
+}
+
+static void print_table(const run_t *runs, uint32_t nruns) {
+    printf("%-10s %8s %21s %21s %21s\n", "", "", "turnaround (ms)", "response (ms)", "waiting (ms)");
+    printf("%-10s %8s %10s %10s %10s %10s %10s %10s %9s %6s %10s\n",
+           "policy", "bursts", "avg", "p95", "avg", "p95", "avg", "p95",
+           "switches", "cpu%", "end (ms)");
+    for (uint32_t i = 0; i < nruns; i++) {
+        const run_t *r = &runs[i];
+        printf("%-10s %8llu %10.1f %10llu %10.1f %10llu %10.1f %10llu %9llu %6.1f %10u\n",
+               r->name, (unsigned long long)r->stats.bursts_done,
+               hist_mean(&r->turnaround), (unsigned long long)hist_percentile(&r->turnaround, 95.0),
+               hist_mean(&r->response), (unsigned long long)hist_percentile(&r->response, 95.0),
+               hist_mean(&r->waiting), (unsigned long long)hist_percentile(&r->waiting, 95.0),
+               (unsigned long long)r->stats.context_switches,
+               r->ticks ? 100.0 * (double)r->busy_ticks / (double)r->ticks : 0.0,
+               r->end_ms);
+    }
+}
+
+// Erro das previsões e custo face ao mesmo escalonador com o time_ms declarado
+static void print_prediction(const run_t *runs, uint32_t nruns) {
+    int any = 0;
+    for (uint32_t i = 0; i < nruns; i++) any |= runs[i].model != PREDICT_OFF;
+    if (!any) return;
+
+    printf("\nBurst prediction (alpha %.2f, first guess %u ms), against the declared length:\n",
+           g_predict_alpha, g_predict_initial_ms);
+    printf("%-10s %8s %10s %8s %8s %12s %10s\n",
+           "policy", "bursts", "MAE (ms)", "error%", "under%", "turnaround", "vs oracle");
+    for (uint32_t i = 0; i < nruns; i++) {
+        const run_t *r = &runs[i];
+        if (r->model == PREDICT_OFF) continue;
+        const predict_stats_t *p = &r->predict;
+        printf("%-10s %8llu %10.1f %8.1f %8.1f %12.1f",
+               r->name, (unsigned long long)p->samples,
+               p->samples ? (double)p->abs_error_ms / (double)p->samples : 0.0,
+               p->actual_ms ? 100.0 * (double)p->abs_error_ms / (double)p->actual_ms : 0.0,
+               p->samples ? 100.0 * (double)p->under / (double)p->samples : 0.0,
+               hist_mean(&r->turnaround));
+
+        // O oráculo é a mesma política sem previsão, se também estiver na lista
+        const run_t *oracle = NULL;
+        for (uint32_t j = 0; j < nruns; j++) {
+            if (runs[j].policy == r->policy && runs[j].fair == r->fair && runs[j].model == PREDICT_OFF) oracle = &runs[j];
+        }
+        double base = oracle ? hist_mean(&oracle->turnaround) : 0.0;
+        if (base > 0.0) {
+            printf(" %+9.1f%%\n", 100.0 * (hist_mean(&r->turnaround) - base) / base);
+        } else {
+            printf(" %10s\n", "-");
+        }
+    }
+}
+
+// Tempo perdido nas trocas de contexto, em percentagem do tempo simulado
+static void print_switch_cost(const run_t *runs, uint32_t nruns) {
+    if (g_swcost.dispatch_us == 0 && g_swcost.warmup_us == 0) return;
+
+    printf("\nContext switch cost (%u us dispatch, %u us warm-up, cold after %u ms):\n",
+           g_swcost.dispatch_us, g_swcost.warmup_us, g_swcost.warmup_decay_ms);
+    printf("%-10s %9s %12s %12s %8s\n", "policy", "switches", "dispatch ms", "warm-up ms", "lost%");
+    for (uint32_t i = 0; i < nruns; i++) {
+        const run_t *r = &runs[i];
+        const swcost_stats_t *s = &r->swcost;
+        uint64_t elapsed_ms = r->ticks * TICKS_MS;
+        printf("%-10s %9llu %12.1f %12.1f %8.2f\n",
+               r->name, (unsigned long long)s->switches,
+               (double)s->dispatch_us / 1000.0, (double)s->warmup_us / 1000.0,
+               elapsed_ms ? 100.0 * (double)(s->dispatch_us + s->warmup_us) / 1000.0 / (double)elapsed_ms : 0.0);
+    }
+}
+
+// Parte do CPU de cada grupo nos ticks disputados, e a que lhe cabia pelos
+// pesos, para comparar as políticas com FAIR:...
+static void print_group_share(const run_t *runs, uint32_t nruns) {
+    int any = 0;
+    for (uint32_t i = 0; i < nruns; i++) any |= runs[i].fair;
+    if (!any) return;
+
+    printf("\nCPU share per group while more than one group had work (share%%/by weight%%, %u ms group slice):\n",
+           g_group_slice_ms);
+    printf("%-10s %12s", "policy", "contended ms");
+    for (uint32_t k = 0; k < g_ngroups; k++) {
+        char name[MSG_GROUP_CHARS + 1];
+        msg_group_name(g_groups[k], name);
+        printf(" %11s", name);
+    }
+    printf(" %9s\n", "max diff");
+    for (uint32_t i = 0; i < nruns; i++) {
+        const run_t *r = &runs[i];
+        uint64_t total = 0;
+        double owed = 0.0, max_diff = 0.0;
+        for (uint32_t k = 0; k < g_ngroups; k++) {
+            total += r->group_cpu_ms[k];
+            owed += r->group_owed_ms[k];
+        }
+        printf("%-10s %12llu", r->name, (unsigned long long)total);
+        for (uint32_t k = 0; k < g_ngroups; k++) {
+            double share = total ? 100.0 * (double)r->group_cpu_ms[k] / (double)total : 0.0;
+            double fair = owed > 0.0 ? 100.0 * r->group_owed_ms[k] / owed : 0.0;
+            double diff = share > fair ? share - fair : fair - share;
+            if (diff > max_diff) max_diff = diff;
+            printf("  %4.1f/%4.1f", share, fair);
+        }
+        printf(" %9.1f\n", max_diff);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <burst-file>...\n"
+            "  --policies=LIST   comma-separated FIFO, SJF, RR, MLFQ, SRTF; RR:N and MLFQ:N\n"
+            "                    use a time slice of N ms (default FIFO,SJF,RR,MLFQ);\n"
+            "                    SJF:EWMA, SJF:HIST, SRTF:EWMA and SRTF:HIST order by\n"
+            "                    the predicted burst length instead of the declared one;\n"
+            "                    RR:AUTO adapts the quantum to the runnable tasks;\n"
+            "                    FAIR:FIFO, FAIR:SJF and FAIR:RR[:N] split the CPU\n"
+            "                    between groups (A-5.csv -> A) by weight first\n"
+            "  --apps=N          applications, cycled over the burst files (default:\n"
+            "                    one per file)\n"
+            "  --stagger-ms=N    application i arrives at i*N ms (default 0)\n"
+            "  --predict-alpha=A weight of the last burst in EWMA, 0 < A <= 1 (default 0.5)\n"
+            "  --predict-initial-ms=N\n"
+            "                    prediction for an application with no history (default 100)\n"
+            "  --rr-target-ms=N  target latency of RR:AUTO (default 500)\n"
+            "  --rr-min-slice-ms=N\n"
+            "                    smallest quantum of RR:AUTO (default 20)\n"
+            "  --cs-dispatch-us=N simulated cost of every context switch (default 0)\n"
+            "  --cs-warmup-us=N  cache warm-up cost of a task that was cold (default 0)\n"
+            "  --cs-warmup-decay-ms=N\n"
+            "                    time off the CPU after which a task is cold (default 100)\n"
+            "  --group-weights=LIST\n"
+            "                    weights of the FAIR groups as NAME:W,... (default 1)\n"
+            "  --group-slice-ms=N time a FAIR group keeps the CPU before a group\n"
+            "                    behind its share can take it (default 100)\n",
+            prog);
+}
+
+static const struct option LONG_OPTIONS[] = {
+    {"policies",   required_argument, NULL, 'p'},
+    {"apps",       required_argument, NULL, 'a'},
+    {"stagger-ms", required_argument, NULL, 's'},
+    {"predict-alpha", required_argument, NULL, 'l'},
+    {"predict-initial-ms", required_argument, NULL, 'i'},
+    {"rr-target-ms", required_argument, NULL, 't'},
+    {"rr-min-slice-ms", required_argument, NULL, 'm'},
+    {"cs-dispatch-us", required_argument, NULL, 'd'},
+    {"cs-warmup-us", required_argument, NULL, 'w'},
+    {"cs-warmup-decay-ms", required_argument, NULL, 'y'},
+    {"group-weights", required_argument, NULL, 'g'},
+    {"group-slice-ms", required_argument, NULL, 'c'},
+    {"help",       no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+int main(int argc, char *argv[]) {
+    char default_policies[] = "FIFO,SJF,RR,MLFQ";
+    char *policies = default_policies;
+    uint32_t apps = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", LONG_OPTIONS, NULL)) != -1) {
+        switch (opt) {
+            case 'p':
+                policies = optarg;
+                break;
+            case 'a':
+                if (parse_u32("apps", optarg, &apps) < 0) return EXIT_FAILURE;
+                break;
+            case 's':
+                if (parse_u32("stagger-ms", optarg, &g_stagger_ms) < 0) return EXIT_FAILURE;
+                break;
+            case 'l': {
+                char *endptr;
+                g_predict_alpha = strtod(optarg, &endptr);
+                if (*endptr != '\0' || !(g_predict_alpha > 0.0 && g_predict_alpha <= 1.0)) {
+                    fprintf(stderr, "Invalid value for --predict-alpha: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'i':
+                if (parse_u32("predict-initial-ms", optarg, &g_predict_initial_ms) < 0) return EXIT_FAILURE;
+                break;
+            case 't':
+                if (parse_u32("rr-target-ms", optarg, &g_rr_target_ms) < 0) return EXIT_FAILURE;
+                if (g_rr_target_ms == 0) {
+                    fprintf(stderr, "--rr-target-ms must be positive\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'm':
+                if (parse_u32("rr-min-slice-ms", optarg, &g_rr_min_slice_ms) < 0) return EXIT_FAILURE;
+                break;
+            case 'd':
+                if (parse_u32("cs-dispatch-us", optarg, &g_swcost.dispatch_us) < 0) return EXIT_FAILURE;
+                break;
+            case 'w':
+                if (parse_u32("cs-warmup-us", optarg, &g_swcost.warmup_us) < 0) return EXIT_FAILURE;
+                break;
+            case 'y':
+                if (parse_u32("cs-warmup-decay-ms", optarg, &g_swcost.warmup_decay_ms) < 0) return EXIT_FAILURE;
+                break;
+            case 'g':
+                g_group_weight_list = optarg;
+                break;
+            case 'c':
+                if (parse_u32("group-slice-ms", optarg, &g_group_slice_ms) < 0) return EXIT_FAILURE;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static run_t runs[MAX_RUNS];
+    uint32_t nruns;
+    if (parse_policies(policies, runs, &nruns) < 0) return EXIT_FAILURE;
+
+    g_nfiles = (uint32_t)(argc - optind);
+    g_apps = apps ? apps : g_nfiles;
+    workload_t *work = calloc(g_nfiles, sizeof(workload_t));
+    if (!work) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < g_nfiles; i++) {
+        if (load_workload(argv[optind + (int)i], &work[i]) < 0) return EXIT_FAILURE;
+    }
+    g_work = work;
+
+    // Grupos distintos das aplicações e os seus pesos (validados aqui, antes
+    // das threads, com a tabela de grupos desta thread)
+    uint32_t used_files = g_apps < g_nfiles ? g_apps : g_nfiles;
+    g_groups = malloc(g_nfiles * sizeof(uint32_t));
+    g_group_weights = malloc(g_nfiles * sizeof(uint32_t));
+    if (!g_groups || !g_group_weights) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < g_nfiles; i++) {
+        uint32_t k = 0;
+        while (k < g_ngroups && g_groups[k] != work[i].group) k++;
+        if (k == g_ngroups && i < used_files) g_groups[g_ngroups++] = work[i].group;
+        work[i].group_idx = k;
+    }
+    group_config_t check_cfg = {.policy = fifo_scheduler, .policy_name = "FIFO", .slice_ms = g_group_slice_ms};
+    if (group_init(&check_cfg) < 0 ||
+        (g_group_weight_list && group_set_weights(g_group_weight_list) < 0)) {
+        fprintf(stderr, "Invalid value for --group-weights: %s (use NAME:W,... with 1 <= W <= %d)\n",
+                g_group_weight_list, GROUP_WEIGHT_MAX);
+        return EXIT_FAILURE;
+    }
+    for (uint32_t k = 0; k < g_ngroups; k++) {
+        g_group_weights[k] = GROUP_WEIGHT_DEFAULT;
+        for (uint32_t i = 0; i < group_num(); i++) {
+            if (group_stats_at(i)->id == g_groups[k]) g_group_weights[k] = group_stats_at(i)->weight;
+        }
+    }
+    group_shutdown();
+
+    // Uma thread por política, todas sobre a mesma carga
+    for (uint32_t i = 0; i < nruns; i++) {
+        run_t *r = &runs[i];
+        r->apps = calloc(g_apps, sizeof(vapp_t));
+        r->inbox = malloc(g_apps * sizeof(uint32_t));
+        r->next_inbox = malloc(g_apps * sizeof(uint32_t));
+        r->group_pending = calloc(g_nfiles, sizeof(uint32_t));
+        r->group_cpu_ms = calloc(g_nfiles, sizeof(uint64_t));
+        r->group_owed_ms = calloc(g_nfiles, sizeof(double));
+        if (!r->apps || !r->inbox || !r->next_inbox || !r->group_pending || !r->group_cpu_ms || !r->group_owed_ms) {
+            perror("malloc");
+            return EXIT_FAILURE;
+        }
+        int err = pthread_create(&r->thread, NULL, run_simulation, r);
+        if (err != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(err));
+            return EXIT_FAILURE;
+        }
+    }
+    for (uint32_t i = 0; i < nruns; i++) pthread_join(runs[i].thread, NULL);
+
+    printf("%u applications over %u burst files, arriving every %u ms\n\n", g_apps, g_nfiles, g_stagger_ms);
+    print_table(runs, nruns);
+    print_prediction(runs, nruns);
+    print_switch_cost(runs, nruns);
+    print_group_share(runs, nruns);
+
+    for (uint32_t i = 0; i < nruns; i++) {
+        free(runs[i].apps);
+        free(runs[i].inbox);
+        free(runs[i].next_inbox);
+        free(runs[i].group_pending);
+        free(runs[i].group_cpu_ms);
+        free(runs[i].group_owed_ms);
+    }
+    for (uint32_t i = 0; i < g_nfiles; i++) free(work[i].bursts);
+    free(work);
+    free(g_groups);
+    free(g_group_weights);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "msg.h"
+
+/*
+ * Mostra o snapshot de estatísticas de um scheduler em execução.
+ *
+ * Run like: ./schedstat [interval_ms]
+ *   sem argumentos faz uma única consulta; com intervalo repete até Ctrl+C.
+ */
+static int query_stats(void) {
+    int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, STATS_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+
+    if (connect(sockfd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        close(sockfd);
+        return -1;
+    }
+
+    // O scheduler envia o snapshot e fecha a ligação
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(sockfd, buf, sizeof(buf))) > 0) {
+        fwrite(buf, 1, (size_t)n, stdout);
+    }
+    fflush(stdout);
+    close(sockfd);
+    return n < 0 ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        printf("Usage: %s [interval_ms]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    long interval_ms = argc == 2 ? strtol(argv[1], NULL, 10) : 0;
+
+    do {
+        if (query_stats() < 0) return EXIT_FAILURE;
+        if (interval_ms > 0) usleep((useconds_t)interval_ms * 1000);
+    } while (interval_ms > 0);
+
+    return EXIT_SUCCESS;
+}
@@ -1,16 +1,73 @@
 #include "queue.h"
 #include "msg.h"
+#include "trace.h"
+#include "stats.h"
+#include "conn.h"
+#include "readyset.h"
+#include "predict.h"
+#include "ckpt.h"
 #include <stdlib.h>
-#include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
 
+// Conjunto de prontos em SoA (--ready-set=soa); NULL = procura na ready queue
+static _Thread_local ready_set_t *ready_set = NULL;
+
+/**
+ * Ativa o conjunto de prontos em SoA (readyset.h): os pedidos novos passam,
+ * a cada tick, da ready queue para o conjunto, e a escolha é uma procura
+ * vetorizada pelo menor estimate_ms em vez de um percurso da lista.
+ */
+int sjf_use_ready_set(void) {
+    static _Thread_local ready_set_t storage;
+    if (ready_set) return 0;
+    if (ready_set_init(&storage, 1024) < 0) return -1;
+    ready_set = &storage;
+    return 0;
+}
+
+/**
+ * Processos no conjunto de prontos (os que ainda estão na ready queue
+ * contam à parte).
+ */
+uint32_t sjf_ready_set_count(void) {
+    return ready_set ? ready_set->live : 0;
+}
+
+/**
+ * Cancela os processos de um cliente que se desligou.
+ */
+uint32_t sjf_cancel_sockfd(uint32_t sockfd) {
+    return ready_set ? ready_set_remove_sockfd(ready_set, sockfd) : 0;
+}
+
+/**
+ * Escreve a ready queue no checkpoint (que só conhece a ready queue): os
+ * processos do conjunto pela ordem de chegada e, a seguir, os que ainda
+ * estão na fila. Nada é retirado do conjunto; no restauro voltam todos
+ * para ele no primeiro tick.
+ */
+void sjf_checkpoint_ready(ckpt_t *c, const queue_t *rq) {
+    if (!ready_set || ready_set->live == 0) {
+        ckpt_put_queue(c, rq);
+        return;
+    }
+    uint32_t count = ready_set->live + rq->count;
+    ckpt_put(c, &count, sizeof(count));
+    for (uint32_t i = 0; i < ready_set->len; i++) {
+        if (ready_set->pcbs[i]) ckpt_put_pcb(c, ready_set->pcbs[i]);
+    }
+    for (const queue_elem_t *it = rq->head; it; it = it->next) ckpt_put_pcb(c, it->pcb);
+}
+
 /**
  * Algoritmo SJF (Shortest Job First)
  *
  * Este escalonador escolhe sempre o processo com o menor tempo de execução
- * (time_ms) entre os que estão prontos na fila. Assim que um processo começa
- * a executar, ele permanece no CPU até terminar (sem preempção).
+ * entre os que estão prontos na fila (estimate_ms: o time_ms declarado ou,
+ * com --predict, a duração prevista a partir dos bursts anteriores do mesmo
+ * pid). Assim que um processo começa a executar, ele permanece no CPU até
+ * terminar (sem preempção).
  *
  * Vantagem: minimiza o tempo médio de espera.
  * Limitação: pode causar starvation se processos curtos continuarem a chegar.
@@ -28,32 +85,50 @@ void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
                 .request = PROCESS_REQUEST_DONE,
                 .time_ms = current_time_ms
             };
-            if (write((*cpu_task)->sockfd, &msg, sizeof msg) != sizeof msg) {
-                perror("write");
-            }
+            TRACE(TRACE_DONE, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.bursts_done++;
+            predict_observe((*cpu_task)->pid, (*cpu_task)->estimate_ms, (*cpu_task)->ellapsed_time_ms);
+            conn_notify((*cpu_task)->cold->sockfd, &msg);
+            TRACE(TRACE_MSG_OUT, (*cpu_task)->pid, current_time_ms, PROCESS_REQUEST_DONE);
 
             // Liberta o PCB e marca o CPU como livre
-            free(*cpu_task);
+            free_pcb(*cpu_task);
             *cpu_task = NULL;
         }
     }
 
+    // 1.a) Com o conjunto em SoA, a ready queue só guarda as chegadas do tick
+    if (ready_set) {
+        pcb_t *p;
+        while ((p = dequeue_pcb(rq)) != NULL) {
+            if (!ready_set_add(ready_set, p, p->estimate_ms)) {
+                enqueue_pcb(rq, p);     // sem memória: fica na fila até ao próximo tick
+                break;
+            }
+        }
+    }
+
     // 2) Pequeno atraso inicial para evitar escolher logo o primeiro processo
     //    Isto permite que mais processos entrem na fila antes da primeira escolha,
     //    garantindo um comportamento mais justo (sobretudo em run_apps2.sh).
-    static int first_dispatch_done = 0;
+    //    Com --fair-share a espera é uma só, partilhada por todos os grupos.
+    static _Thread_local int first_dispatch_done = 0;
     if (!first_dispatch_done && current_time_ms < 200) {
         return; // espera cerca de 200ms antes de despachar o primeiro
     }
 
     // 3) Se o CPU está livre e existem processos prontos na fila
-    if (*cpu_task == NULL && rq->head != NULL) {
-        // Procura o processo com o menor tempo total (SJF clássico)
+    if (*cpu_task == NULL && ready_set && ready_set->live > 0) {
+        *cpu_task = ready_set_pop_min(ready_set);
+        first_dispatch_done = 1;
+    } else if (*cpu_task == NULL && rq->head != NULL) {
+        // Procura o processo com o menor tempo total (SJF clássico; com
+        // previsão, o menor tempo previsto)
         queue_elem_t *it = rq->head;
         queue_elem_t *min_elem = it;
 
         while (it != NULL) {
-            if (it->pcb->time_ms < min_elem->pcb->time_ms) {
+            if (it->pcb->estimate_ms < min_elem->pcb->estimate_ms) {
                 min_elem = it;
             }
             it = it->next;
@@ -63,7 +138,6 @@ void sjf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
         queue_elem_t *removed = remove_queue_elem(rq, min_elem);
         if (removed) {
             *cpu_task = removed->pcb;
-            free(removed);
             first_dispatch_done = 1; // indica que o primeiro despacho foi feito
         }
     }
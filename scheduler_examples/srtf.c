@@ -0,0 +1,200 @@
+#include "queue.h"
+#include "msg.h"
+#include "trace.h"
+#include "stats.h"
+#include "conn.h"
+#include "predict.h"
+#include "ckpt.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Entrada do heap: tempo que falta, ordem de inserção (desempate) e o PCB
+typedef struct {
+    uint32_t remaining_ms;
+    uint32_t seq;
+    pcb_t *pcb;
+} srtf_entry_t;
+
+// Min-heap binário dos prontos, ordenado pelo tempo que falta
+static _Thread_local srtf_entry_t *heap = NULL;
+static _Thread_local uint32_t heap_len = 0;
+static _Thread_local uint32_t heap_cap = 0;
+static _Thread_local uint32_t next_seq = 0;
+
+// Com previsão, um processo que já passou da estimativa fica com 0 e não é
+// preemptado até terminar
+static uint32_t remaining_of(const pcb_t *p) {
+    return p->ellapsed_time_ms < p->estimate_ms ? p->estimate_ms - p->ellapsed_time_ms : 0;
+}
+
+static int entry_less(const srtf_entry_t *a, const srtf_entry_t *b) {
+    if (a->remaining_ms != b->remaining_ms) return a->remaining_ms < b->remaining_ms;
+    return a->seq < b->seq;
+}
+
+static void sift_up(uint32_t i) {
+    srtf_entry_t e = heap[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!entry_less(&e, &heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = e;
+}
+
+static void sift_down(uint32_t i) {
+    srtf_entry_t e = heap[i];
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= heap_len) break;
+        if (child + 1 < heap_len && entry_less(&heap[child + 1], &heap[child])) child++;
+        if (!entry_less(&heap[child], &e)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = e;
+}
+
+// Insere um processo pronto; devolve 0 se não houver memória
+static int heap_push(pcb_t *p) {
+    if (heap_len == heap_cap) {
+        uint32_t cap = heap_cap ? heap_cap * 2 : 64;
+        srtf_entry_t *h = realloc(heap, (size_t)cap * sizeof(srtf_entry_t));
+        if (!h) return 0;
+        heap = h;
+        heap_cap = cap;
+    }
+    heap[heap_len] = (srtf_entry_t){.remaining_ms = remaining_of(p), .seq = next_seq++, .pcb = p};
+    sift_up(heap_len++);
+    return 1;
+}
+
+static pcb_t *heap_pop(void) {
+    if (heap_len == 0) return NULL;
+    pcb_t *p = heap[0].pcb;
+    heap[0] = heap[--heap_len];
+    if (heap_len > 0) sift_down(0);
+    return p;
+}
+
+/**
+ * Processos à espera no heap (os que ainda estão na ready queue contam à
+ * parte).
+ */
+uint32_t srtf_count(void) {
+    return heap_len;
+}
+
+/**
+ * Cancela os processos de um cliente que se desligou.
+ */
+uint32_t srtf_cancel_sockfd(uint32_t sockfd) {
+    uint32_t kept = 0, removed = 0;
+    for (uint32_t i = 0; i < heap_len; i++) {
+        if (heap[i].pcb->cold->sockfd == sockfd) {
+            free_pcb(heap[i].pcb);
+            removed++;
+        } else {
+            heap[kept++] = heap[i];
+        }
+    }
+    heap_len = kept;
+    // Refaz o heap (Floyd): só acontece quando um cliente se desliga
+    for (uint32_t i = heap_len / 2; i-- > 0; ) sift_down(i);
+    return removed;
+}
+
+static int by_seq(const void *a, const void *b) {
+    uint32_t sa = ((const srtf_entry_t *)a)->seq, sb = ((const srtf_entry_t *)b)->seq;
+    return (sa > sb) - (sa < sb);
+}
+
+/**
+ * Escreve a ready queue no checkpoint (que só conhece a ready queue): os
+ * processos do heap pela ordem em que lá entraram e, a seguir, os que
+ * ainda estão na fila. O heap não é alterado: a ordenação é feita numa
+ * cópia. O tempo já executado fica no PCB, pelo que no restauro voltam ao
+ * heap com a mesma chave.
+ */
+void srtf_checkpoint_ready(ckpt_t *c, const queue_t *rq) {
+    if (heap_len == 0) {
+        ckpt_put_queue(c, rq);
+        return;
+    }
+    srtf_entry_t *sorted = malloc(heap_len * sizeof(srtf_entry_t));
+    if (!sorted) {
+        c->error = 1;
+        return;
+    }
+    memcpy(sorted, heap, heap_len * sizeof(srtf_entry_t));
+    qsort(sorted, heap_len, sizeof(srtf_entry_t), by_seq);
+
+    uint32_t count = heap_len + rq->count;
+    ckpt_put(c, &count, sizeof(count));
+    for (uint32_t i = 0; i < heap_len; i++) ckpt_put_pcb(c, sorted[i].pcb);
+    for (const queue_elem_t *it = rq->head; it; it = it->next) ckpt_put_pcb(c, it->pcb);
+    free(sorted);
+}
+
+/**
+ * Algoritmo SRTF (Shortest Remaining Time First)
+ *
+ * Versão preemptiva do SJF: os prontos ficam num min-heap ordenado pelo
+ * tempo que lhes falta (estimate_ms - ellapsed_time_ms), com os empates
+ * resolvidos pela ordem de chegada. A ready queue só guarda as chegadas do
+ * tick, que passam para o heap em O(log n) cada.
+ *
+ * Quando chega um burst mais curto do que o que falta ao processo no CPU,
+ * este é preemptado e volta ao heap com o tempo que lhe falta. Não há a
+ * espera inicial do SJF: a preempção corrige uma má primeira escolha.
+ *
+ * Vantagem: minimiza o tempo médio de espera mesmo com chegadas ao longo
+ * do tempo. Limitação: os processos longos podem sofrer starvation.
+ */
+void srtf_scheduler(uint32_t current_time_ms, queue_t *rq, pcb_t **cpu_task) {
+    // 1) Atualiza o processo que está no CPU (caso exista)
+    if (*cpu_task) {
+        (*cpu_task)->ellapsed_time_ms += TICKS_MS;
+
+        if ((*cpu_task)->ellapsed_time_ms >= (*cpu_task)->time_ms) {
+            msg_t msg = {
+                .pid = (*cpu_task)->pid,
+                .request = PROCESS_REQUEST_DONE,
+                .time_ms = current_time_ms
+            };
+            TRACE(TRACE_DONE, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.bursts_done++;
+            predict_observe((*cpu_task)->pid, (*cpu_task)->estimate_ms, (*cpu_task)->ellapsed_time_ms);
+            conn_notify((*cpu_task)->cold->sockfd, &msg);
+            TRACE(TRACE_MSG_OUT, (*cpu_task)->pid, current_time_ms, PROCESS_REQUEST_DONE);
+
+            free_pcb(*cpu_task);
+            *cpu_task = NULL;
+        }
+    }
+
+    // 2) As chegadas do tick passam da ready queue para o heap
+    pcb_t *p;
+    while ((p = dequeue_pcb(rq)) != NULL) {
+        if (!heap_push(p)) {
+            enqueue_pcb(rq, p);     // sem memória: fica na fila até ao próximo tick
+            break;
+        }
+    }
+
+    // 3) Preempção: um pronto precisa de menos tempo do que o que falta ao atual
+    //    (só uma chegada o pode fazer; os restantes já perderam para ele)
+    if (*cpu_task && heap_len > 0 && heap[0].remaining_ms < remaining_of(*cpu_task)) {
+        if (heap_push(*cpu_task)) {
+            TRACE(TRACE_PREEMPT, (*cpu_task)->pid, current_time_ms, 0);
+            g_stats.preemptions++;
+            *cpu_task = NULL;
+        }
+    }
+
+    // 4) CPU livre: escolhe o que tem menos tempo por executar
+    if (*cpu_task == NULL) {
+        *cpu_task = heap_pop();
+    }
+}
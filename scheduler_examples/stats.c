@@ -0,0 +1,20 @@
+#include "stats.h"
+
+_Thread_local sched_stats_t g_stats;
+
+void stats_print(FILE *out, uint32_t now_ms) {
+    double seconds = now_ms / 1000.0;
+    fprintf(out, "Counters: %llu RUN, %llu BLOCK, %llu bursts done (%.2f/s), %llu I/O done, "
+                 "%llu context switches, %llu preemptions\n",
+            (unsigned long long)g_stats.requests_run, (unsigned long long)g_stats.requests_block,
+            (unsigned long long)g_stats.bursts_done,
+            seconds > 0 ? (double)g_stats.bursts_done / seconds : 0.0,
+            (unsigned long long)g_stats.blocks_done, (unsigned long long)g_stats.context_switches,
+            (unsigned long long)g_stats.preemptions);
+    fprintf(out, "Clients: %llu accepted, %llu closed, %u still connected, %llu pending tasks cancelled\n",
+            (unsigned long long)g_stats.clients_accepted, (unsigned long long)g_stats.clients_closed,
+            g_stats.clients_connected, (unsigned long long)g_stats.tasks_cancelled);
+    fprintf(out, "Outbound: %llu stalls (EPOLLOUT), %llu dropped, %llu read pauses, peak backlog %u messages\n",
+            (unsigned long long)g_stats.tx_stalls, (unsigned long long)g_stats.tx_dropped,
+            (unsigned long long)g_stats.backpressure_pauses, g_stats.tx_peak_backlog);
+}
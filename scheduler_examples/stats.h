@@ -0,0 +1,34 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Contadores do simulador, atualizados pelo ciclo principal e pelos escalonadores.
+// São por thread para que o schedcmp possa correr várias políticas em paralelo.
+typedef struct {
+    uint64_t requests_run;          // pedidos RUN recebidos
+    uint64_t requests_block;        // pedidos BLOCK recebidos
+    uint64_t acks_sent;             // ACKs enviados
+    uint64_t bursts_done;           // bursts de CPU terminados (DONE)
+    uint64_t blocks_done;           // operações de I/O terminadas (DONE)
+    uint64_t preemptions;           // processos retirados do CPU antes de terminarem
+    uint64_t context_switches;      // vezes que um processo diferente ganhou o CPU
+    uint64_t clients_accepted;      // ligações aceites
+    uint64_t clients_closed;        // ligações terminadas
+    uint64_t tasks_cancelled;       // PCBs descartados por o cliente se ter desligado
+    uint32_t clients_connected;     // ligações ativas neste momento
+    uint64_t tx_stalls;             // envios que ficaram à espera de EPOLLOUT
+    uint64_t tx_dropped;            // mensagens descartadas (ring cheio ou cliente desligado)
+    uint64_t backpressure_pauses;   // vezes que a leitura de um cliente foi suspensa
+    uint32_t tx_peak_backlog;       // maior número de mensagens por enviar numa ligação
+} sched_stats_t;
+
+extern _Thread_local sched_stats_t g_stats;
+
+/**
+ * @brief Imprime os contadores (usado no fim da simulação)
+ */
+void stats_print(FILE *out, uint32_t now_ms);
+
+#endif //STATS_H
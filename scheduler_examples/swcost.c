@@ -0,0 +1,77 @@
+#include "swcost.h"
+
+#include <string.h>
+
+#include "msg.h"
+
+static _Thread_local swcost_config_t config;
+static _Thread_local swcost_stats_t stats;
+static _Thread_local uint32_t shared_owed_us;  // custo por cobrar dos processos sem estado próprio
+
+void swcost_init(const swcost_config_t *cfg) {
+    config = *cfg;
+    memset(&stats, 0, sizeof(stats));
+    shared_owed_us = 0;
+}
+
+int swcost_enabled(void) {
+    return config.dispatch_us > 0 || config.warmup_us > 0;
+}
+
+uint32_t swcost_dispatch(uint32_t gap_ms, int never_ran, uint32_t *owed_us) {
+    if (!swcost_enabled()) return 0;
+    if (!owed_us) owed_us = &shared_owed_us;
+
+    // A cache arrefece linearmente com a ausência, até warmup_decay_ms
+    uint64_t warmup = config.warmup_us;
+    if (!never_ran && gap_ms < config.warmup_decay_ms) {
+        warmup = (uint64_t)config.warmup_us * gap_ms / config.warmup_decay_ms;
+    }
+
+    stats.switches++;
+    stats.dispatch_us += config.dispatch_us;
+    stats.warmup_us += warmup;
+    uint64_t owed = *owed_us + config.dispatch_us + warmup;
+
+    uint32_t ticks = (uint32_t)(owed / (TICKS_MS * 1000u));
+    *owed_us = (uint32_t)(owed - (uint64_t)ticks * TICKS_MS * 1000u);
+    stats.charged_ms += (uint64_t)ticks * TICKS_MS;
+    return ticks * TICKS_MS;
+}
+
+const swcost_stats_t *swcost_get_stats(void) {
+    return &stats;
+}
+
+void swcost_print_stats(FILE *out, uint32_t elapsed_ms) {
+    if (!swcost_enabled()) return;
+    double lost_ms = (double)(stats.dispatch_us + stats.warmup_us) / 1000.0;
+    fprintf(out, "Context switch cost (%u us dispatch, %u us warm-up, cold after %u ms): %llu switches, "
+                 "%.1f ms dispatch + %.1f ms warm-up, %.2f%% of CPU time lost\n",
+            config.dispatch_us, config.warmup_us, config.warmup_decay_ms,
+            (unsigned long long)stats.switches,
+            (double)stats.dispatch_us / 1000.0, (double)stats.warmup_us / 1000.0,
+            elapsed_ms ? 100.0 * lost_ms / (double)elapsed_ms : 0.0);
+}
+
+// O custo por cobrar de cada processo vai com a tabela de processos; aqui
+// só fica o dos processos sem estado próprio
+void swcost_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &config, sizeof(config));
+    ckpt_put(c, &stats, sizeof(stats));
+    ckpt_put(c, &shared_owed_us, sizeof(shared_owed_us));
+}
+
+int swcost_restore(ckpt_t *c) {
+    swcost_config_t cfg;
+    swcost_stats_t st;
+    uint32_t owed;
+    ckpt_get(c, &cfg, sizeof(cfg));
+    ckpt_get(c, &st, sizeof(st));
+    ckpt_get(c, &owed, sizeof(owed));
+    if (c->error) return -1;
+    swcost_init(&cfg);
+    stats = st;
+    shared_owed_us = owed;
+    return 0;
+}
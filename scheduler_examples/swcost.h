@@ -0,0 +1,82 @@
+#ifndef SWCOST_H
+#define SWCOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ckpt.h"
+
+/*
+ * Custo simulado das trocas de contexto. Sem ele, trocar o cpu_task é
+ * gratuito e os quanta pequenos do RR/MLFQ parecem melhores do que são.
+ *
+ * Cada despacho custa um overhead fixo mais o aquecimento da cache: um
+ * processo que correu há pouco ainda tem a cache quente e paga pouco; um
+ * que não corre há warmup_decay_ms ou mais (ou que nunca correu) paga o
+ * aquecimento todo. O custo é cobrado ao processo que o causou, em ticks
+ * inteiros (TICKS_MS): a parte que ainda não chega a um tick fica guardada
+ * no próprio processo e soma-se às suas trocas seguintes. Cada processo
+ * paga o seu custo, com um erro inferior a um tick.
+ *
+ * O estado é _Thread_local, para o schedcmp ter um modelo por política.
+ */
+
+typedef struct {
+    uint32_t dispatch_us;       // overhead fixo de cada despacho
+    uint32_t warmup_us;         // aquecimento da cache de um processo frio
+    uint32_t warmup_decay_ms;   // ausência a partir da qual a cache está fria
+} swcost_config_t;
+
+typedef struct {
+    uint64_t switches;          // despachos com custo
+    uint64_t dispatch_us;       // soma dos overheads fixos
+    uint64_t warmup_us;         // soma dos aquecimentos
+    uint64_t charged_ms;        // tempo simulado já cobrado aos processos
+} swcost_stats_t;
+
+/**
+ * @brief Configura o modelo da thread atual (apaga os contadores)
+ */
+void swcost_init(const swcost_config_t *cfg);
+
+/**
+ * @brief Indica se algum dos custos é diferente de zero
+ */
+int swcost_enabled(void);
+
+/**
+ * @brief Regista um despacho e devolve o tempo a cobrar ao processo que entra
+ *
+ * @param gap_ms Tempo desde a última vez que o processo esteve no CPU
+ * @param never_ran 1 se o processo nunca correu (cache fria)
+ * @param owed_us Custo do processo ainda não cobrado (menos de um tick),
+ *                atualizado; NULL para um processo sem estado próprio
+ * @return Tempo a acrescentar ao burst, em ms (0 ou múltiplos de TICKS_MS)
+ */
+uint32_t swcost_dispatch(uint32_t gap_ms, int never_ran, uint32_t *owed_us);
+
+const swcost_stats_t *swcost_get_stats(void);
+
+/**
+ * @brief Escreve o custo total e a percentagem de CPU perdida
+ *
+ * @param elapsed_ms Tempo simulado decorrido
+ */
+void swcost_print_stats(FILE *out, uint32_t elapsed_ms);
+
+/**
+ * @brief Escreve a configuração, os contadores e o custo ainda não cobrado
+ * dos processos sem estado próprio
+ */
+void swcost_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui o estado atual pelo de um checkpoint
+ *
+ * A configuração do checkpoint prevalece sobre a da linha de comandos.
+ *
+ * @return 0 em caso de sucesso, -1 se o checkpoint estiver corrompido
+ */
+int swcost_restore(ckpt_t *c);
+
+#endif // SWCOST_H
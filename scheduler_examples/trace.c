@@ -0,0 +1,109 @@
+#include "trace.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRACE_RING_RECORDS (1u << 16)   // 64k eventos (1 MiB) por thread
+#define TRACE_DRAIN_US     1000         // período do drainer
+
+atomic_int trace_enabled = 0;
+_Thread_local trace_ring_t *trace_tls_ring = NULL;
+
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring_t *rings = NULL;      // todos os rings registados
+
+static FILE *trace_file = NULL;
+static pthread_t drainer;
+static atomic_int drainer_stop = 0;
+
+trace_ring_t *trace_register_thread(void) {
+    trace_ring_t *ring = calloc(1, sizeof(trace_ring_t) + TRACE_RING_RECORDS * sizeof(trace_record_t));
+    if (!ring) return NULL;
+    ring->mask = TRACE_RING_RECORDS - 1;
+
+    pthread_mutex_lock(&rings_lock);
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+
+    trace_tls_ring = ring;
+    return ring;
+}
+
+// Copia para o ficheiro os eventos pendentes de todos os rings
+static void drain_all(void) {
+    pthread_mutex_lock(&rings_lock);
+    for (trace_ring_t *ring = rings; ring; ring = ring->next) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        while (tail != head) {
+            // Escreve o bloco contíguo até ao fim do buffer (ou até head)
+            uint32_t idx = tail & ring->mask;
+            uint32_t n = head - tail;
+            if (n > ring->mask + 1 - idx) n = ring->mask + 1 - idx;
+            fwrite(&ring->records[idx], sizeof(trace_record_t), n, trace_file);
+            tail += n;
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+    pthread_mutex_unlock(&rings_lock);
+}
+
+static void *drainer_main(void *arg) {
+    (void)arg;
+    const struct timespec period = {.tv_sec = 0, .tv_nsec = TRACE_DRAIN_US * 1000L};
+    while (!atomic_load(&drainer_stop)) {
+        drain_all();
+        nanosleep(&period, NULL);
+    }
+    return NULL;
+}
+
+int trace_start(const char *path) {
+    trace_file = fopen(path, "wb");
+    if (!trace_file) {
+        perror("fopen(trace)");
+        return -1;
+    }
+    trace_header_t header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .record_size = sizeof(trace_record_t)
+    };
+    fwrite(&header, sizeof(header), 1, trace_file);
+
+    atomic_store(&drainer_stop, 0);
+    if (pthread_create(&drainer, NULL, drainer_main, NULL) != 0) {
+        perror("pthread_create(trace)");
+        fclose(trace_file);
+        trace_file = NULL;
+        return -1;
+    }
+    atomic_store(&trace_enabled, 1);
+    return 0;
+}
+
+void trace_stop(void) {
+    if (!trace_file) return;
+    atomic_store(&trace_enabled, 0);
+    atomic_store(&drainer_stop, 1);
+    pthread_join(drainer, NULL);
+    drain_all();
+
+    uint64_t dropped = 0;
+    pthread_mutex_lock(&rings_lock);
+    while (rings) {
+        trace_ring_t *ring = rings;
+        rings = ring->next;
+        dropped += ring->dropped;
+        free(ring);
+    }
+    pthread_mutex_unlock(&rings_lock);
+    trace_tls_ring = NULL;
+
+    if (dropped) fprintf(stderr, "trace: %llu events dropped (ring full)\n", (unsigned long long)dropped);
+    fclose(trace_file);
+    trace_file = NULL;
+}
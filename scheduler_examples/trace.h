@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*
+ * Trace binário de eventos do escalonador.
+ *
+ * Cada thread escreve num ring buffer próprio (single producer / single
+ * consumer, sem locks); uma thread de fundo (drainer) copia periodicamente
+ * os eventos para um ficheiro. O ficheiro pode ser convertido para o formato
+ * JSON do Chrome/Perfetto com a ferramenta trace2json.
+ */
+
+#define TRACE_MAGIC   0x5254534fu   // "OSTR"
+#define TRACE_VERSION 1
+
+typedef enum {
+    TRACE_DISPATCH = 0,   // processo ganhou o CPU
+    TRACE_PREEMPT,        // processo perdeu o CPU sem terminar o burst
+    TRACE_BLOCK,          // processo iniciou I/O
+    TRACE_WAKE,           // I/O terminou
+    TRACE_DONE,           // burst de CPU terminou
+    TRACE_MSG_IN,         // mensagem recebida de uma aplicação (arg = pedido)
+    TRACE_MSG_OUT,        // mensagem enviada a uma aplicação (arg = pedido)
+    TRACE_EVENT_COUNT
+} trace_event_en;
+
+// Cabeçalho do ficheiro de trace
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+} trace_header_t;
+
+// Um evento (16 bytes, escrito tal como está no ficheiro)
+typedef struct {
+    uint32_t time_ms;     // tempo de simulação
+    int32_t pid;
+    uint8_t type;         // trace_event_en
+    uint8_t reserved[3];  // o simulador tem um só CPU: não há CPU a registar
+    uint32_t arg;
+} trace_record_t;
+
+typedef struct trace_ring_st {
+    _Atomic uint32_t head;          // próxima posição a escrever (produtor)
+    _Atomic uint32_t tail;          // próxima posição a ler (drainer)
+    uint32_t mask;
+    uint64_t dropped;               // eventos perdidos por o ring estar cheio
+    struct trace_ring_st *next;     // lista de rings registados
+    trace_record_t records[];
+} trace_ring_t;
+
+extern atomic_int trace_enabled;
+extern _Thread_local trace_ring_t *trace_tls_ring;
+
+/**
+ * @brief Abre o ficheiro de trace e arranca a thread que o escreve
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int trace_start(const char *path);
+
+/**
+ * @brief Escreve os eventos pendentes, termina o drainer e fecha o ficheiro
+ *
+ * Os rings são libertados, pelo que só deve ser chamada depois de as
+ * restantes threads que produzem eventos terminarem.
+ */
+void trace_stop(void);
+
+/**
+ * @brief Cria e regista o ring buffer da thread atual (chamado no primeiro evento)
+ */
+trace_ring_t *trace_register_thread(void);
+
+static inline void trace_emit(trace_event_en type, int32_t pid, uint32_t time_ms, uint32_t arg) {
+    trace_ring_t *ring = trace_tls_ring;
+    if (!ring && !(ring = trace_register_thread())) return;
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask) {
+        ring->dropped++;
+        return;
+    }
+    trace_record_t *r = &ring->records[head & ring->mask];
+    r->time_ms = time_ms;
+    r->pid = pid;
+    r->type = (uint8_t)type;
+    r->reserved[0] = r->reserved[1] = r->reserved[2] = 0;
+    r->arg = arg;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// Regista um evento se o trace estiver ativo (custo de um load quando não está)
+#define TRACE(type, pid, time_ms, arg) \
+    do { \
+        if (atomic_load_explicit(&trace_enabled, memory_order_relaxed)) \
+            trace_emit((type), (pid), (time_ms), (arg)); \
+    } while (0)
+
+#endif //TRACE_H
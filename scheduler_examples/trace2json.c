@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "msg.h"
+#include "trace.h"
+
+/*
+ * Converte um trace binário do ossim (--trace=FICHEIRO) para o formato JSON
+ * do Chrome (chrome://tracing ou https://ui.perfetto.dev).
+ *
+ *  - "CPU": um bloco por período de execução (Gantt; o simulador tem um só CPU)
+ *  - "I/O": uma linha por processo com os períodos bloqueados
+ *  - "Messages": eventos instantâneos para as mensagens trocadas
+ *
+ * Run like: ./trace2json <trace.bin> [out.json]
+ */
+
+#define PID_CPU      0
+#define PID_IO       1
+#define PID_MESSAGES 2
+
+static const char *EVENT_NAMES[TRACE_EVENT_COUNT] = {
+    "dispatch", "preempt", "block", "wake", "done", "msg_in", "msg_out"
+};
+
+typedef struct {
+    int32_t pid;        // processo em execução (-1 = livre)
+    uint32_t start_ms;
+} cpu_slot_t;
+
+typedef struct {
+    int32_t pid;
+    uint32_t start_ms;
+} io_slot_t;
+
+static int first_event = 1;
+
+static void emit_separator(FILE *out) {
+    if (!first_event) fputs(",\n", out);
+    first_event = 0;
+}
+
+static void emit_slice(FILE *out, int track, uint32_t tid, int32_t pid,
+                       uint32_t start_ms, uint32_t end_ms, const char *end_reason) {
+    emit_separator(out);
+    fprintf(out, "{\"name\":\"pid %d\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+                 "\"ts\":%llu,\"dur\":%llu,\"args\":{\"end\":\"%s\"}}",
+            pid, track == PID_CPU ? "cpu" : "io", track, tid,
+            (unsigned long long)start_ms * 1000ull, (unsigned long long)(end_ms - start_ms) * 1000ull,
+            end_reason);
+}
+
+static void emit_metadata(FILE *out, int pid, const char *name) {
+    emit_separator(out);
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}", pid, name);
+}
+
+static const char *request_name(uint32_t request) {
+    return request <= PROCESS_REQUEST_REJECT ? PROCESS_REQUEST_STRINGS[request] : "?";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3) {
+        printf("Usage: %s <trace.bin> [out.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        perror("fopen");
+        return EXIT_FAILURE;
+    }
+    trace_header_t header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || header.magic != TRACE_MAGIC ||
+        header.version != TRACE_VERSION || header.record_size != sizeof(trace_record_t)) {
+        fprintf(stderr, "%s is not an ossim trace file\n", argv[1]);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (argc == 3 && !(out = fopen(argv[2], "w"))) {
+        perror("fopen");
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    cpu_slot_t cpu = {.pid = -1, .start_ms = 0};
+
+    io_slot_t *io = NULL;           // processos bloqueados neste momento
+    size_t io_count = 0, io_cap = 0;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    emit_metadata(out, PID_CPU, "CPU");
+    emit_metadata(out, PID_IO, "I/O");
+    emit_metadata(out, PID_MESSAGES, "Messages");
+
+    trace_record_t r;
+    uint32_t last_ms = 0;
+    uint64_t count = 0;
+    while (fread(&r, sizeof(r), 1, in) == 1) {
+        count++;
+        last_ms = r.time_ms;
+
+        switch (r.type) {
+            case TRACE_DISPATCH:
+                if (cpu.pid >= 0) emit_slice(out, PID_CPU, 0, cpu.pid, cpu.start_ms, r.time_ms, "switch");
+                cpu.pid = r.pid;
+                cpu.start_ms = r.time_ms;
+                break;
+            case TRACE_PREEMPT:
+            case TRACE_DONE:
+                if (cpu.pid == r.pid) {
+                    emit_slice(out, PID_CPU, 0, cpu.pid, cpu.start_ms, r.time_ms, EVENT_NAMES[r.type]);
+                    cpu.pid = -1;
+                }
+                break;
+            case TRACE_BLOCK:
+                if (io_count == io_cap) {
+                    io_cap = io_cap ? io_cap * 2 : 64;
+                    io_slot_t *bigger = realloc(io, io_cap * sizeof(io_slot_t));
+                    if (!bigger) {
+                        perror("realloc");
+                        free(io);
+                        return EXIT_FAILURE;
+                    }
+                    io = bigger;
+                }
+                io[io_count].pid = r.pid;
+                io[io_count].start_ms = r.time_ms;
+                io_count++;
+                break;
+            case TRACE_WAKE:
+                for (size_t i = 0; i < io_count; i++) {
+                    if (io[i].pid != r.pid) continue;
+                    emit_slice(out, PID_IO, (uint32_t)r.pid, r.pid, io[i].start_ms, r.time_ms, "wake");
+                    io[i] = io[--io_count];
+                    break;
+                }
+                break;
+            case TRACE_MSG_IN:
+            case TRACE_MSG_OUT:
+                emit_separator(out);
+                fprintf(out, "{\"name\":\"%s %s\",\"cat\":\"msg\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+                             "\"tid\":%d,\"ts\":%llu}",
+                        request_name(r.arg), r.type == TRACE_MSG_IN ? "in" : "out", PID_MESSAGES, r.pid,
+                        (unsigned long long)r.time_ms * 1000ull);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Fecha os períodos que ainda estavam abertos no fim do trace
+    if (cpu.pid >= 0) emit_slice(out, PID_CPU, 0, cpu.pid, cpu.start_ms, last_ms, "end");
+    for (size_t i = 0; i < io_count; i++) {
+        emit_slice(out, PID_IO, (uint32_t)io[i].pid, io[i].pid, io[i].start_ms, last_ms, "end");
+    }
+    fputs("\n]}\n", out);
+
+    fprintf(stderr, "Converted %llu events\n", (unsigned long long)count);
+    free(io);
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#define _GNU_SOURCE     // memfd_create, struct ucred
+#include "upgrade.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// O kernel aceita no máximo SCM_MAX_FD (253) fds por mensagem
+#define FDS_PER_MSG 250
+
+// Cabeçalho de cada mensagem com fds
+typedef struct {
+    uint32_t magic;
+    uint32_t total;             // fds em todas as mensagens
+    uint32_t count;             // fds nesta mensagem
+} upgrade_msg_t;
+
+int upgrade_state_fd(void) {
+    int fd = memfd_create("ossim-upgrade", MFD_CLOEXEC);
+    if (fd < 0) perror("memfd_create");
+    return fd;
+}
+
+int upgrade_connect(const char *path) {
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return -1;
+    }
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect(upgrade)");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int upgrade_send_fds(int sock, const int *fds, uint32_t n) {
+    uint32_t sent = 0;
+    do {
+        uint32_t count = n - sent < FDS_PER_MSG ? n - sent : FDS_PER_MSG;
+        upgrade_msg_t body = {.magic = UPGRADE_MAGIC, .total = n, .count = count};
+        struct iovec iov = {.iov_base = &body, .iov_len = sizeof(body)};
+
+        union {
+            char buf[CMSG_SPACE(FDS_PER_MSG * sizeof(int))];
+            struct cmsghdr align;
+        } control;
+        memset(&control, 0, sizeof(control));
+
+        struct msghdr msg = {0};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (count > 0) {
+            msg.msg_control = control.buf;
+            msg.msg_controllen = CMSG_SPACE(count * sizeof(int));
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(count * sizeof(int));
+            memcpy(CMSG_DATA(cmsg), fds + sent, count * sizeof(int));
+        }
+
+        ssize_t r;
+        do {
+            r = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        } while (r < 0 && errno == EINTR);
+        if (r != (ssize_t)sizeof(body)) {
+            perror("sendmsg(upgrade)");
+            return -1;
+        }
+        sent += count;
+    } while (sent < n);
+    return 0;
+}
+
+int *upgrade_recv_fds(int sock, uint32_t *n) {
+    int *fds = NULL;
+    uint32_t total = 0, received = 0;
+    do {
+        upgrade_msg_t body;
+        struct iovec iov = {.iov_base = &body, .iov_len = sizeof(body)};
+        union {
+            char buf[CMSG_SPACE(FDS_PER_MSG * sizeof(int))];
+            struct cmsghdr align;
+        } control;
+
+        struct msghdr msg = {0};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t r;
+        do {
+            r = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL);
+        } while (r < 0 && errno == EINTR);
+        if (r == 0 && !fds) goto fail;      // recusado: o processo em execução fechou a ligação
+        if (r != (ssize_t)sizeof(body) || body.magic != UPGRADE_MAGIC || (msg.msg_flags & MSG_CTRUNC) ||
+            (fds && body.total != total) || body.count > body.total - received) {
+            fprintf(stderr, "Invalid upgrade message from the running scheduler\n");
+            goto fail;
+        }
+        if (!fds) {
+            total = body.total;
+            fds = malloc((total ? total : 1) * sizeof(int));
+            if (!fds) goto fail;
+        }
+
+        uint32_t got = 0;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            uint32_t k = (uint32_t)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            if (k > body.count - got) k = body.count - got;
+            memcpy(fds + received + got, CMSG_DATA(cmsg), k * sizeof(int));
+            got += k;
+        }
+        received += got;
+        if (got != body.count) {
+            fprintf(stderr, "Upgrade message carried %u of %u descriptors\n", got, body.count);
+            goto fail;
+        }
+    } while (received < total);
+
+    *n = total;
+    return fds;
+
+fail:
+    for (uint32_t i = 0; i < received; i++) close(fds[i]);
+    free(fds);
+    return NULL;
+}
+
+pid_t upgrade_peer_pid(int sock) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) return -1;
+    return cred.pid;
+}
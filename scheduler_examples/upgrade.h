@@ -0,0 +1,63 @@
+#ifndef UPGRADE_H
+#define UPGRADE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Hot upgrade: passagem dos sockets e do estado para um novo processo.
+ *
+ * O scheduler escuta em UPGRADE_SOCKET_PATH. Um novo scheduler arrancado
+ * com --takeover liga-se a esse socket; no fim do tick o processo antigo
+ * escreve o estado completo (formato do checkpoint, ckpt.h) num memfd e
+ * envia, com SCM_RIGHTS, o memfd, os sockets de escuta e os sockets de
+ * todas as ligações. Quando o novo processo confirma que os registou, o
+ * antigo termina sem fechar nem desligar nada: os clientes continuam
+ * ligados aos mesmos sockets e o relógio continua no mesmo tick.
+ */
+
+#define UPGRADE_MAGIC 0x5055534fu   // "OSUP"
+
+// Ordem dos primeiros fds enviados; seguem-se os das ligações
+enum {
+    UPGRADE_FD_STATE = 0,       // memfd com o estado
+    UPGRADE_FD_LISTEN,          // SOCKET_PATH
+    UPGRADE_FD_STATS,           // STATS_SOCKET_PATH
+    UPGRADE_FD_CONTROL,         // UPGRADE_SOCKET_PATH
+    UPGRADE_FD_CONNS            // primeira ligação
+};
+
+/**
+ * @brief Cria o ficheiro anónimo (memfd) onde é escrito o estado
+ *
+ * @return O fd, ou -1 em caso de erro
+ */
+int upgrade_state_fd(void);
+
+/**
+ * @brief Liga-se ao processo em execução (bloqueante)
+ *
+ * @return O socket, ou -1 se não houver nenhum scheduler a escutar
+ */
+int upgrade_connect(const char *path);
+
+/**
+ * @brief Envia n fds (em várias mensagens se forem muitos)
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int upgrade_send_fds(int sock, const int *fds, uint32_t n);
+
+/**
+ * @brief Recebe os fds enviados por upgrade_send_fds
+ *
+ * @return Vetor alocado com os fds (libertar com free), ou NULL em caso de erro
+ */
+int *upgrade_recv_fds(int sock, uint32_t *n);
+
+/**
+ * @brief PID do processo do outro lado do socket (SO_PEERCRED)
+ */
+pid_t upgrade_peer_pid(int sock);
+
+#endif //UPGRADE_H
@@ -0,0 +1,188 @@
+#include "uring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+static int sys_setup(uint32_t entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_register(int fd, uint32_t opcode, void *arg, uint32_t nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+int uring_setup(uring_t *r, uint32_t sq_entries, uint32_t cq_entries) {
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+
+    // COOP_TASKRUN: as CQEs são publicadas na próxima entrada no kernel
+    // (o sleep de cada tick), sem interromper o processo com IPIs
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    p.cq_entries = cq_entries;
+    int fd = sys_setup(sq_entries, &p);
+    if (fd < 0 && errno == EINVAL) {
+        memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = cq_entries;
+        fd = sys_setup(sq_entries, &p);
+    }
+    if (fd < 0) return -errno;
+    r->fd = fd;
+    r->features = p.features;
+
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    r->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if ((p.features & IORING_FEAT_SINGLE_MMAP) && r->cq_ring_size > r->sq_ring_size) {
+        r->sq_ring_size = r->cq_ring_size;
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED) goto fail;
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ring = r->sq_ring;
+    } else {
+        r->cq_ring = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED) goto fail;
+    }
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) goto fail;
+
+    uint8_t *sq = r->sq_ring;
+    r->sq_head = (uint32_t *)(sq + p.sq_off.head);
+    r->sq_tail = (uint32_t *)(sq + p.sq_off.tail);
+    r->sq_flags = (uint32_t *)(sq + p.sq_off.flags);
+    r->sq_array = (uint32_t *)(sq + p.sq_off.array);
+    r->sq_mask = *(uint32_t *)(sq + p.sq_off.ring_mask);
+    r->sq_entries = p.sq_entries;
+    r->sqe_tail = *r->sq_tail;
+
+    uint8_t *cq = r->cq_ring;
+    r->cq_head = (uint32_t *)(cq + p.cq_off.head);
+    r->cq_tail = (uint32_t *)(cq + p.cq_off.tail);
+    r->cq_mask = *(uint32_t *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    // O índice i da SQ aponta sempre para a SQE i
+    for (uint32_t i = 0; i < p.sq_entries; i++) r->sq_array[i] = i;
+    return 0;
+
+fail:
+    {
+        int err = -errno;
+        uring_destroy(r);
+        return err;
+    }
+}
+
+void uring_destroy(uring_t *r) {
+    if (r->sqes && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring && r->cq_ring != MAP_FAILED && r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+    if (r->sq_ring && r->sq_ring != MAP_FAILED) munmap(r->sq_ring, r->sq_ring_size);
+    if (r->fd >= 0) close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+struct io_uring_sqe *uring_get_sqe(uring_t *r) {
+    uint32_t head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (r->sqe_tail - head >= r->sq_entries) {
+        if (uring_submit(r) < 0) return NULL;
+        head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        if (r->sqe_tail - head >= r->sq_entries) return NULL;
+    }
+    struct io_uring_sqe *sqe = &r->sqes[r->sqe_tail & r->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sqe_tail++;
+    return sqe;
+}
+
+static int enter(uring_t *r, uint32_t min_complete) {
+    // Publica as SQEs preparadas
+    uint32_t to_submit = r->sqe_tail - *r->sq_tail;
+    __atomic_store_n(r->sq_tail, r->sqe_tail, __ATOMIC_RELEASE);
+
+    int overflow = (__atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) != 0;
+    if (to_submit == 0 && min_complete == 0 && !overflow) return 0;
+
+    uint32_t flags = (min_complete > 0 || overflow) ? IORING_ENTER_GETEVENTS : 0;
+    int n;
+    do {
+        n = sys_enter(r->fd, to_submit, min_complete, flags);
+    } while (n < 0 && errno == EINTR);
+    r->enters++;
+    return n < 0 ? -errno : n;
+}
+
+int uring_submit(uring_t *r) {
+    return enter(r, 0);
+}
+
+int uring_submit_and_wait(uring_t *r) {
+    return enter(r, 1);
+}
+
+int uring_bufs_register(uring_t *r, uring_bufs_t *b, uint16_t group, uint32_t count, uint32_t size) {
+    memset(b, 0, sizeof(*b));
+    size_t ring_size = count * sizeof(struct io_uring_buf);
+    void *ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return -errno;
+    uint8_t *base = mmap(NULL, (size_t)count * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        int err = -errno;
+        munmap(ring, ring_size);
+        return err;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring;
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (sys_register(r->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        int err = -errno;
+        munmap(base, (size_t)count * size);
+        munmap(ring, ring_size);
+        return err;
+    }
+
+    b->ring = ring;
+    b->base = base;
+    b->count = count;
+    b->size = size;
+    b->group = group;
+    for (uint32_t i = 0; i < count; i++) uring_bufs_recycle(b, (uint16_t)i);
+    return 0;
+}
+
+void uring_bufs_unregister(uring_t *r, uring_bufs_t *b) {
+    if (!b->ring) return;
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.bgid = b->group;
+    if (r->fd >= 0) sys_register(r->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    munmap(b->base, (size_t)b->count * b->size);
+    munmap(b->ring, b->count * sizeof(struct io_uring_buf));
+    memset(b, 0, sizeof(*b));
+}
+
+void uring_bufs_recycle(uring_bufs_t *b, uint16_t bid) {
+    struct io_uring_buf *buf = &b->ring->bufs[b->tail & (b->count - 1)];
+    buf->addr = (uint64_t)(uintptr_t)uring_buf_addr(b, bid);
+    buf->len = b->size;
+    buf->bid = bid;
+    b->tail++;
+    __atomic_store_n(&b->ring->tail, b->tail, __ATOMIC_RELEASE);
+}
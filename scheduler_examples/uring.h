@@ -0,0 +1,119 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+/*
+ * Acesso mínimo ao io_uring com syscalls diretas (sem liburing).
+ *
+ * As SQEs preparadas com uring_get_sqe só são entregues ao kernel no
+ * uring_submit, pelo que um tick inteiro de pedidos segue num único
+ * io_uring_enter. As CQEs são lidas diretamente do ring partilhado, sem
+ * syscalls.
+ */
+typedef struct {
+    int fd;
+    uint32_t features;
+
+    // Submission queue
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_flags;
+    uint32_t *sq_array;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    struct io_uring_sqe *sqes;
+    uint32_t sqe_tail;          // SQEs preparadas (ainda não publicadas)
+
+    // Completion queue
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    uint64_t enters;            // chamadas a io_uring_enter
+} uring_t;
+
+// Ring de buffers fornecidos ao kernel (recv com IOSQE_BUFFER_SELECT)
+typedef struct {
+    struct io_uring_buf_ring *ring;
+    uint8_t *base;              // memória dos buffers (count * size)
+    uint32_t count;             // potência de 2
+    uint32_t size;
+    uint16_t group;
+    uint16_t tail;
+} uring_bufs_t;
+
+/**
+ * @brief Cria o io_uring
+ *
+ * @return 0 em caso de sucesso, -errno se o kernel não suportar io_uring
+ */
+int uring_setup(uring_t *r, uint32_t sq_entries, uint32_t cq_entries);
+
+void uring_destroy(uring_t *r);
+
+/**
+ * @brief Devolve uma SQE limpa para preencher
+ *
+ * Se a submission queue estiver cheia, submete primeiro as pendentes.
+ *
+ * @return a SQE, ou NULL se não foi possível libertar espaço
+ */
+struct io_uring_sqe *uring_get_sqe(uring_t *r);
+
+/**
+ * @brief Entrega ao kernel as SQEs preparadas (um io_uring_enter)
+ *
+ * Também é chamada sem SQEs quando a completion queue transbordou, para o
+ * kernel copiar as CQEs em espera.
+ *
+ * @return número de SQEs submetidas, ou -errno
+ */
+int uring_submit(uring_t *r);
+
+/**
+ * @brief Submete e espera por pelo menos uma CQE
+ */
+int uring_submit_and_wait(uring_t *r);
+
+/**
+ * @brief Próxima CQE disponível, ou NULL (sem syscalls)
+ */
+static inline struct io_uring_cqe *uring_peek_cqe(uring_t *r) {
+    uint32_t head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) return NULL;
+    return &r->cqes[head & r->cq_mask];
+}
+
+static inline void uring_cqe_seen(uring_t *r) {
+    __atomic_store_n(r->cq_head, *r->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Regista um grupo de buffers fornecidos (IORING_REGISTER_PBUF_RING)
+ *
+ * @return 0 em caso de sucesso, -errno em caso de erro
+ */
+int uring_bufs_register(uring_t *r, uring_bufs_t *b, uint16_t group, uint32_t count, uint32_t size);
+
+void uring_bufs_unregister(uring_t *r, uring_bufs_t *b);
+
+static inline uint8_t *uring_buf_addr(const uring_bufs_t *b, uint16_t bid) {
+    return b->base + (size_t)bid * b->size;
+}
+
+/**
+ * @brief Devolve um buffer ao kernel depois de consumido
+ */
+void uring_bufs_recycle(uring_bufs_t *b, uint16_t bid);
+
+#endif //URING_H
@@ -0,0 +1,437 @@
+#include "vm.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "mem.h"
+
+#define EMPTY_PID INT32_MIN
+#define NO_FRAME  (-1)
+
+/*
+ * Tabela de páginas de um processo: hash com endereçamento aberto
+ * (linear probing) de página virtual -> frame físico.
+ * As remoções usam backward-shift, pelo que não há tombstones.
+ */
+typedef struct {
+    uint32_t page;
+    int32_t frame;              // NO_FRAME = posição livre
+} pte_t;
+
+typedef struct {
+    int32_t pid;                // EMPTY_PID = posição livre
+    uint32_t used;
+    uint32_t cap;               // potência de 2
+    uint32_t owed_ns;           // custo das travessias ainda não cobrado (menos de 1 ms)
+    pte_t *entries;
+} page_table_t;
+
+// Entrada da TLB
+typedef struct {
+    uint8_t valid;
+    int32_t asid;
+    uint32_t page;
+    int32_t frame;
+    uint64_t stamp;             // última utilização (LRU dentro do conjunto)
+} tlb_entry_t;
+
+static vm_config_t config;
+static vm_stats_t stats;
+
+// Tabela pid -> tabela de páginas (também com endereçamento aberto)
+static page_table_t *tables = NULL;
+static uint32_t tables_used = 0;
+static uint32_t tables_cap = 0;
+
+static tlb_entry_t *tlb = NULL;
+static uint64_t tlb_clock = 0;
+static int32_t current_asid = EMPTY_PID;
+
+static const char *TLB_MODE_NAMES[] = {"FLUSH", "ASID"};
+
+int tlb_mode_from_name(const char *name, tlb_mode_en *out) {
+    for (int i = 0; i <= TLB_ASID; i++) {
+        if (!strcasecmp(name, TLB_MODE_NAMES[i])) {
+            *out = (tlb_mode_en)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *tlb_mode_name(tlb_mode_en mode) {
+    return TLB_MODE_NAMES[mode];
+}
+
+static uint32_t hash_u32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// ---------------------------------------------------------
+// Tabelas de páginas
+// ---------------------------------------------------------
+static int pt_alloc(page_table_t *pt, uint32_t cap) {
+    pt->entries = malloc(cap * sizeof(pte_t));
+    if (!pt->entries) return -1;
+    for (uint32_t i = 0; i < cap; i++) pt->entries[i] = (pte_t){.page = 0, .frame = NO_FRAME};
+    pt->cap = cap;
+    pt->used = 0;
+    pt->owed_ns = 0;
+    return 0;
+}
+
+static pte_t *pt_find(const page_table_t *pt, uint32_t page) {
+    uint32_t mask = pt->cap - 1;
+    for (uint32_t i = hash_u32(page) & mask; pt->entries[i].frame != NO_FRAME; i = (i + 1) & mask) {
+        if (pt->entries[i].page == page) return &pt->entries[i];
+    }
+    return NULL;
+}
+
+static void pt_insert(page_table_t *pt, uint32_t page, int32_t frame);
+
+static int pt_grow(page_table_t *pt) {
+    page_table_t bigger;
+    if (pt_alloc(&bigger, pt->cap * 2) < 0) return -1;
+    for (uint32_t i = 0; i < pt->cap; i++) {
+        if (pt->entries[i].frame != NO_FRAME) pt_insert(&bigger, pt->entries[i].page, pt->entries[i].frame);
+    }
+    free(pt->entries);
+    pt->entries = bigger.entries;
+    pt->cap = bigger.cap;
+    return 0;
+}
+
+static void pt_insert(page_table_t *pt, uint32_t page, int32_t frame) {
+    pte_t *pte = pt_find(pt, page);
+    if (pte) {
+        pte->frame = frame;
+        return;
+    }
+    if ((pt->used + 1) * 4 > pt->cap * 3 && pt_grow(pt) < 0) return;
+
+    uint32_t mask = pt->cap - 1;
+    uint32_t i = hash_u32(page) & mask;
+    while (pt->entries[i].frame != NO_FRAME) i = (i + 1) & mask;
+    pt->entries[i].page = page;
+    pt->entries[i].frame = frame;
+    pt->used++;
+}
+
+static void pt_remove(page_table_t *pt, uint32_t page) {
+    pte_t *pte = pt_find(pt, page);
+    if (!pte) return;
+
+    // Backward-shift: puxa para trás as entradas que ficariam inalcançáveis
+    uint32_t mask = pt->cap - 1;
+    uint32_t hole = (uint32_t)(pte - pt->entries);
+    for (uint32_t i = (hole + 1) & mask; pt->entries[i].frame != NO_FRAME; i = (i + 1) & mask) {
+        uint32_t home = hash_u32(pt->entries[i].page) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            pt->entries[hole] = pt->entries[i];
+            hole = i;
+        }
+    }
+    pt->entries[hole].frame = NO_FRAME;
+    pt->used--;
+}
+
+static page_table_t *table_slot(int32_t pid) {
+    uint32_t mask = tables_cap - 1;
+    uint32_t i = hash_u32((uint32_t)pid) & mask;
+    while (tables[i].pid != EMPTY_PID && tables[i].pid != pid) i = (i + 1) & mask;
+    return &tables[i];
+}
+
+static page_table_t *find_table(int32_t pid) {
+    if (!tables) return NULL;
+    page_table_t *pt = table_slot(pid);
+    return pt->pid == pid ? pt : NULL;
+}
+
+static int grow_tables(void) {
+    page_table_t *old = tables;
+    uint32_t old_cap = tables_cap;
+
+    tables_cap = old_cap ? old_cap * 2 : 64;
+    tables = malloc(tables_cap * sizeof(page_table_t));
+    if (!tables) {
+        tables = old;
+        tables_cap = old_cap;
+        return -1;
+    }
+    for (uint32_t i = 0; i < tables_cap; i++) tables[i].pid = EMPTY_PID;
+    for (uint32_t i = 0; i < old_cap; i++) {
+        if (old[i].pid != EMPTY_PID) *table_slot(old[i].pid) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+// Liberta a tabela de páginas de um processo (backward-shift, como pt_remove)
+static void drop_table(page_table_t *pt) {
+    free(pt->entries);
+    uint32_t mask = tables_cap - 1;
+    uint32_t hole = (uint32_t)(pt - tables);
+    for (uint32_t i = (hole + 1) & mask; tables[i].pid != EMPTY_PID; i = (i + 1) & mask) {
+        uint32_t home = hash_u32((uint32_t)tables[i].pid) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            tables[hole] = tables[i];
+            hole = i;
+        }
+    }
+    tables[hole].pid = EMPTY_PID;
+    tables_used--;
+}
+
+static page_table_t *get_table(int32_t pid) {
+    page_table_t *pt = find_table(pid);
+    if (pt) return pt;
+    if ((tables_used + 1) * 4 > tables_cap * 3 && grow_tables() < 0) return NULL;
+
+    pt = table_slot(pid);
+    if (pt_alloc(pt, 16) < 0) return NULL;
+    pt->pid = pid;
+    tables_used++;
+    return pt;
+}
+
+// ---------------------------------------------------------
+// TLB
+// ---------------------------------------------------------
+static tlb_entry_t *tlb_set(uint32_t page) {
+    return &tlb[(hash_u32(page) & (config.tlb_sets - 1)) * config.tlb_ways];
+}
+
+static tlb_entry_t *tlb_lookup(int32_t pid, uint32_t page) {
+    tlb_entry_t *set = tlb_set(page);
+    for (uint32_t w = 0; w < config.tlb_ways; w++) {
+        if (set[w].valid && set[w].asid == pid && set[w].page == page) return &set[w];
+    }
+    return NULL;
+}
+
+static void tlb_fill(int32_t pid, uint32_t page, int32_t frame) {
+    tlb_entry_t *set = tlb_set(page);
+    tlb_entry_t *victim = &set[0];
+    for (uint32_t w = 0; w < config.tlb_ways; w++) {
+        if (!set[w].valid) {
+            victim = &set[w];
+            break;
+        }
+        if (set[w].stamp < victim->stamp) victim = &set[w];
+    }
+    victim->valid = 1;
+    victim->asid = pid;
+    victim->page = page;
+    victim->frame = frame;
+    victim->stamp = ++tlb_clock;
+}
+
+static void tlb_flush(void) {
+    memset(tlb, 0, (size_t)config.tlb_sets * config.tlb_ways * sizeof(tlb_entry_t));
+    stats.flushes++;
+}
+
+// ---------------------------------------------------------
+// API pública
+// ---------------------------------------------------------
+int vm_init(const vm_config_t *cfg) {
+    vm_shutdown();
+    config = *cfg;
+    memset(&stats, 0, sizeof(stats));
+
+    if (config.tlb_sets == 0) return 0;
+    if ((config.tlb_sets & (config.tlb_sets - 1)) != 0 || config.tlb_ways == 0) return -1;
+
+    tlb = calloc((size_t)config.tlb_sets * config.tlb_ways, sizeof(tlb_entry_t));
+    if (!tlb || grow_tables() < 0) {
+        vm_shutdown();
+        return -1;
+    }
+    return 0;
+}
+
+void vm_shutdown(void) {
+    for (uint32_t i = 0; i < tables_cap; i++) {
+        if (tables[i].pid != EMPTY_PID) free(tables[i].entries);
+    }
+    free(tables);
+    free(tlb);
+    tables = NULL;
+    tlb = NULL;
+    tables_used = tables_cap = 0;
+    tlb_clock = 0;
+    current_asid = EMPTY_PID;
+}
+
+void vm_map(int32_t pid, uint32_t page, int32_t frame) {
+    if (!tlb) return;
+    page_table_t *pt = get_table(pid);
+    if (pt) pt_insert(pt, page, frame);
+}
+
+void vm_unmap(int32_t pid, uint32_t page) {
+    if (!tlb) return;
+    page_table_t *pt = find_table(pid);
+    if (pt) {
+        pt_remove(pt, page);
+        // Sem páginas em memória a tabela deixa de ser precisa: assim há no
+        // máximo uma tabela por frame, por muitos pids que já tenham passado
+        if (pt->used == 0) drop_table(pt);
+    }
+
+    tlb_entry_t *e = tlb_lookup(pid, page);
+    if (e) {
+        e->valid = 0;
+        stats.shootdowns++;
+    }
+}
+
+void vm_context_switch(int32_t pid) {
+    if (!tlb) return;
+    stats.context_switches++;
+    if (config.mode == TLB_FLUSH && current_asid != pid) tlb_flush();
+    current_asid = pid;
+}
+
+uint32_t vm_access(int32_t pid, const page_info_t *pages, uint32_t now_ms) {
+    if (!tlb || !pages) return 0;
+
+    uint32_t fault_ms = 0;
+    uint64_t walk_ns = 0;
+    for (uint32_t i = 0; i < pages->count && i < MAX_PAGES; i++) {
+        uint32_t page = pages->ids[i];
+        stats.lookups++;
+        stats.overhead_ns += config.hit_ns;
+
+        tlb_entry_t *e = tlb_lookup(pid, page);
+        if (e) {
+            stats.hits++;
+            e->stamp = ++tlb_clock;
+            continue;
+        }
+
+        // Miss: percorre a tabela de páginas do processo
+        stats.walks++;
+        stats.overhead_ns += config.walk_ns;
+        walk_ns += config.walk_ns;
+        page_table_t *pt = find_table(pid);
+        pte_t *pte = pt ? pt_find(pt, page) : NULL;
+        if (!pte) {
+            // A página foi retirada de memória entretanto: page fault
+            stats.faults++;
+            page_info_t one = {.count = 1, .ids = {page}};
+            fault_ms += mem_reference(pid, &one, now_ms);
+            pt = find_table(pid);
+            pte = pt ? pt_find(pt, page) : NULL;
+            if (!pte) continue;
+        }
+        tlb_fill(pid, page, pte->frame);
+    }
+
+    // As travessias prolongam o burst como os page faults, em ms inteiros;
+    // o resto fica na tabela do processo para a próxima vez
+    page_table_t *pt = find_table(pid);
+    if (pt) {
+        walk_ns += pt->owed_ns;
+        pt->owed_ns = (uint32_t)(walk_ns % 1000000u);
+    }
+    stats.walk_time_ms += walk_ns / 1000000u;
+    return fault_ms + (uint32_t)(walk_ns / 1000000u);
+}
+
+const vm_stats_t *vm_get_stats(void) {
+    return &stats;
+}
+
+void vm_print_stats(FILE *out, const char *policy_name) {
+    if (!tlb) return;
+    double hit_rate = stats.lookups ? 100.0 * (double)stats.hits / (double)stats.lookups : 0.0;
+    double per_switch = stats.context_switches ? (double)stats.overhead_ns / (double)stats.context_switches : 0.0;
+    fprintf(out, "TLB (%s, %ux%u, %s): %llu context switches, %llu lookups, %.2f%% hits, "
+                 "%llu walks, %llu flushes, %llu shootdowns\n",
+            policy_name, config.tlb_sets, config.tlb_ways, tlb_mode_name(config.mode),
+            (unsigned long long)stats.context_switches, (unsigned long long)stats.lookups, hit_rate,
+            (unsigned long long)stats.walks, (unsigned long long)stats.flushes,
+            (unsigned long long)stats.shootdowns);
+    fprintf(out, "Translation overhead (%s): %.3f us total, %.1f ns per context switch, %llu ms charged for walks, "
+                 "%llu faults after eviction\n",
+            policy_name, (double)stats.overhead_ns / 1000.0, per_switch, (unsigned long long)stats.walk_time_ms,
+            (unsigned long long)stats.faults);
+}
+
+void vm_checkpoint(ckpt_t *c) {
+    ckpt_put(c, &config, sizeof(config));
+    ckpt_put(c, &stats, sizeof(stats));
+    if (!tlb) return;
+    ckpt_put(c, tlb, (size_t)config.tlb_sets * config.tlb_ways * sizeof(tlb_entry_t));
+    ckpt_put(c, &tlb_clock, sizeof(tlb_clock));
+    ckpt_put(c, &current_asid, sizeof(current_asid));
+
+    // As tabelas são escritas posição a posição, para o restauro não ter de
+    // recalcular o hash (e ficar com a mesma disposição)
+    ckpt_put(c, &tables_cap, sizeof(tables_cap));
+    ckpt_put(c, &tables_used, sizeof(tables_used));
+    for (uint32_t i = 0; i < tables_cap; i++) {
+        const page_table_t *pt = &tables[i];
+        ckpt_put(c, &pt->pid, sizeof(pt->pid));
+        if (pt->pid == EMPTY_PID) continue;
+        ckpt_put(c, &pt->cap, sizeof(pt->cap));
+        ckpt_put(c, &pt->used, sizeof(pt->used));
+        ckpt_put(c, &pt->owed_ns, sizeof(pt->owed_ns));
+        ckpt_put(c, pt->entries, pt->cap * sizeof(pte_t));
+    }
+}
+
+int vm_restore(ckpt_t *c) {
+    vm_config_t cfg;
+    ckpt_get(c, &cfg, sizeof(cfg));
+    if (c->error || cfg.mode > TLB_ASID || vm_init(&cfg) < 0) return -1;
+
+    ckpt_get(c, &stats, sizeof(stats));
+    if (!tlb) return c->error ? -1 : 0;
+    ckpt_get(c, tlb, (size_t)config.tlb_sets * config.tlb_ways * sizeof(tlb_entry_t));
+    ckpt_get(c, &tlb_clock, sizeof(tlb_clock));
+    ckpt_get(c, &current_asid, sizeof(current_asid));
+
+    uint32_t cap, used;
+    ckpt_get(c, &cap, sizeof(cap));
+    ckpt_get(c, &used, sizeof(used));
+    if (c->error || cap == 0 || (cap & (cap - 1)) != 0 || used > cap) return -1;
+
+    // O vm_init criou a tabela de tabelas vazia; é substituída pela do checkpoint
+    free(tables);
+    tables = malloc(cap * sizeof(page_table_t));
+    if (!tables) {
+        tables_cap = tables_used = 0;
+        return -1;
+    }
+    tables_cap = cap;
+    tables_used = used;
+    for (uint32_t i = 0; i < cap; i++) tables[i].pid = EMPTY_PID;
+
+    for (uint32_t i = 0; i < cap && !c->error; i++) {
+        int32_t pid;
+        ckpt_get(c, &pid, sizeof(pid));
+        if (pid == EMPTY_PID) continue;
+
+        page_table_t *pt = &tables[i];
+        uint32_t pt_cap, pt_used, owed_ns;
+        ckpt_get(c, &pt_cap, sizeof(pt_cap));
+        ckpt_get(c, &pt_used, sizeof(pt_used));
+        ckpt_get(c, &owed_ns, sizeof(owed_ns));
+        if (c->error || pt_cap == 0 || (pt_cap & (pt_cap - 1)) != 0 || pt_alloc(pt, pt_cap) < 0) return -1;
+        pt->pid = pid;
+        pt->used = pt_used;
+        pt->owed_ns = owed_ns;
+        ckpt_get(c, pt->entries, pt_cap * sizeof(pte_t));
+    }
+    return c->error ? -1 : 0;
+}
@@ -0,0 +1,99 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "msg.h"
+#include "ckpt.h"
+
+// Comportamento da TLB numa mudança de contexto
+typedef enum {
+    TLB_FLUSH = 0,      // Invalida todas as entradas
+    TLB_ASID            // Entradas marcadas com o ASID (pid) do processo, nada é invalidado
+} tlb_mode_en;
+
+// Configuração da tradução de endereços
+typedef struct {
+    uint32_t tlb_sets;      // Número de conjuntos (potência de 2, 0 desativa a TLB)
+    uint32_t tlb_ways;      // Associatividade de cada conjunto
+    tlb_mode_en mode;       // FLUSH ou ASID
+    uint32_t hit_ns;        // Custo de uma tradução com hit na TLB
+    uint32_t walk_ns;       // Custo de percorrer a tabela de páginas num miss
+} vm_config_t;
+
+typedef struct {
+    uint64_t lookups;           // Traduções pedidas
+    uint64_t hits;              // Hits na TLB
+    uint64_t walks;             // Misses resolvidos pela tabela de páginas
+    uint64_t faults;            // Páginas que já não estavam em memória
+    uint64_t flushes;           // Invalidações completas da TLB
+    uint64_t shootdowns;        // Entradas invalidadas por a página ter saído de memória
+    uint64_t context_switches;  // Mudanças de contexto observadas
+    uint64_t overhead_ns;       // Custo total estimado das traduções
+    uint64_t walk_time_ms;      // Tempo cobrado aos bursts pelas travessias
+} vm_stats_t;
+
+int tlb_mode_from_name(const char *name, tlb_mode_en *out);
+
+const char *tlb_mode_name(tlb_mode_en mode);
+
+/**
+ * @brief Inicializa as tabelas de páginas e a TLB
+ *
+ * @return 0 em caso de sucesso, -1 se a configuração for inválida ou faltar memória
+ */
+int vm_init(const vm_config_t *cfg);
+
+void vm_shutdown(void);
+
+/**
+ * @brief Regista na tabela de páginas do processo que a página está no frame indicado
+ *
+ * Chamada pelo subsistema de memória sempre que uma página é carregada.
+ */
+void vm_map(int32_t pid, uint32_t page, int32_t frame);
+
+/**
+ * @brief Retira a página da tabela de páginas do processo
+ *
+ * Chamada quando a página é retirada do seu frame; a entrada correspondente
+ * na TLB também é invalidada (shootdown). A tabela de um processo que fica
+ * sem páginas em memória é libertada.
+ */
+void vm_unmap(int32_t pid, uint32_t page);
+
+/**
+ * @brief Indica que o processo pid passou a ocupar o CPU
+ */
+void vm_context_switch(int32_t pid);
+
+/**
+ * @brief Traduz as páginas de um burst através da TLB
+ *
+ * Um miss percorre a tabela de páginas do processo; se a página já não
+ * estiver em memória, é tratada como page fault. O custo das travessias
+ * (walk_ns cada) é cobrado em ms inteiros, ficando o resto para o próximo
+ * acesso do mesmo processo.
+ *
+ * @return O tempo de serviço dos page faults e das travessias (em ms)
+ */
+uint32_t vm_access(int32_t pid, const page_info_t *pages, uint32_t now_ms);
+
+const vm_stats_t *vm_get_stats(void);
+
+void vm_print_stats(FILE *out, const char *policy_name);
+
+/**
+ * @brief Escreve a configuração, os contadores, as tabelas de páginas e a TLB
+ */
+void vm_checkpoint(ckpt_t *c);
+
+/**
+ * @brief Substitui o estado atual pelo de um checkpoint
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro
+ */
+int vm_restore(ckpt_t *c);
+
+#endif //VM_H
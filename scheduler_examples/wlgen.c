@@ -0,0 +1,396 @@
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "msg.h"
+#include "burst_queue.h"
+
+/*
+ * Gerador de cargas sintéticas para o app-io / app-multi.
+ *
+ * Cada burst é tirado de uma classe (escolhida pelo peso), e cada classe tem
+ * as suas distribuições para o tempo de CPU, o tempo de I/O, o nice e o
+ * número de páginas. Os bursts são escritos um a um (nada fica em memória),
+ * e a mesma semente e as mesmas opções produzem sempre os mesmos bytes.
+ *
+ * Run like: ./wlgen --seed=42 --bursts=1000000 \
+ *               --class="weight=3,cpu=exp(20),io=exp(200)" \
+ *               --class="weight=1,cpu=pareto(1.5,100,5000),io=const(0)" > load.csv
+ */
+
+#define MAX_CLASSES 16
+
+typedef enum {
+    DIST_CONST = 0,     // const(v)
+    DIST_UNIFORM,       // uniform(a,b), inteiros em [a, b]
+    DIST_EXP,           // exp(média)
+    DIST_BIMODAL,       // bimodal(média curta, média longa, probabilidade da curta)
+    DIST_PARETO,        // pareto(alfa, mínimo[, máximo])
+} dist_kind_en;
+
+typedef struct {
+    dist_kind_en kind;
+    double a, b, c;
+} dist_t;
+
+typedef struct {
+    double weight;
+    dist_t cpu;
+    dist_t io;
+    dist_t nice;
+    dist_t pages;       // número de páginas por burst
+} burst_class_t;
+
+// ---------------------------------------------------------
+// Gerador pseudo-aleatório (xoshiro256**, semeado com splitmix64).
+// Não depende do rand() da libc, para a saída ser igual em qualquer sistema.
+// ---------------------------------------------------------
+static uint64_t rng_state[4];
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void rng_seed(uint64_t seed) {
+    for (int i = 0; i < 4; i++) rng_state[i] = splitmix64(&seed);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t rng_next(void) {
+    uint64_t *s = rng_state;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Uniforme em (0, 1): nunca devolve 0, para o log/pow não divergirem
+static double rng_unit(void) {
+    return ((double)(rng_next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static double dist_sample(const dist_t *d) {
+    switch (d->kind) {
+        case DIST_CONST:
+            return d->a;
+        case DIST_UNIFORM:
+            return d->a + floor(rng_unit() * (d->b - d->a + 1.0));
+        case DIST_EXP:
+            return -d->a * log(rng_unit());
+        case DIST_BIMODAL: {
+            double mean = rng_unit() < d->c ? d->a : d->b;
+            return -mean * log(rng_unit());
+        }
+        case DIST_PARETO: {
+            double v = d->b / pow(rng_unit(), 1.0 / d->a);
+            return (d->c > 0 && v > d->c) ? d->c : v;
+        }
+    }
+    return 0;
+}
+
+static long sample_clamped(const dist_t *d, long lo, long hi) {
+    double v = floor(dist_sample(d) + 0.5);
+    if (v < (double)lo) return lo;
+    if (v > (double)hi) return hi;
+    return (long)v;
+}
+
+// ---------------------------------------------------------
+// Leitura das opções
+// ---------------------------------------------------------
+
+// "exp(200)", "bimodal(10,2000,0.8)", ... → dist_t
+static int parse_dist(const char *spec, dist_t *d) {
+    static const struct { const char *name; dist_kind_en kind; int min_args, max_args; } KINDS[] = {
+        {"const", DIST_CONST, 1, 1},
+        {"uniform", DIST_UNIFORM, 2, 2},
+        {"exp", DIST_EXP, 1, 1},
+        {"bimodal", DIST_BIMODAL, 3, 3},
+        {"pareto", DIST_PARETO, 2, 3},
+    };
+
+    const char *open = strchr(spec, '(');
+    if (!open) return -1;
+    size_t name_len = (size_t)(open - spec);
+
+    for (size_t k = 0; k < sizeof(KINDS) / sizeof(KINDS[0]); k++) {
+        if (strlen(KINDS[k].name) != name_len || strncmp(spec, KINDS[k].name, name_len) != 0) continue;
+
+        double args[3] = {0, 0, 0};
+        int n = 0;
+        const char *p = open + 1;
+        while (n < 3) {
+            char *end;
+            errno = 0;
+            args[n] = strtod(p, &end);
+            if (end == p || errno != 0) return -1;
+            n++;
+            p = end;
+            if (*p != ',') break;
+            p++;
+        }
+        if (*p != ')' || p[1] != '\0' || n < KINDS[k].min_args || n > KINDS[k].max_args) return -1;
+
+        d->kind = KINDS[k].kind;
+        d->a = args[0];
+        d->b = args[1];
+        d->c = args[2];
+
+        // Parâmetros que tornariam a amostragem indefinida
+        if (d->kind == DIST_UNIFORM && d->b < d->a) return -1;
+        if ((d->kind == DIST_EXP || d->kind == DIST_BIMODAL) && (d->a < 0 || (d->kind == DIST_BIMODAL && d->b < 0))) return -1;
+        if (d->kind == DIST_BIMODAL && (d->c < 0 || d->c > 1)) return -1;
+        if (d->kind == DIST_PARETO && (d->a <= 0 || d->b <= 0)) return -1;
+        return 0;
+    }
+    return -1;
+}
+
+// "weight=3,cpu=exp(20),io=const(0)" → burst_class_t (campos omitidos ficam com o valor por omissão)
+static int parse_class(const char *spec, burst_class_t *cls) {
+    char *copy = strdup(spec);
+    if (!copy) return -1;
+
+    int ok = 1;
+    char *field = copy;
+    while (ok && *field) {
+        // As vírgulas dentro dos parênteses pertencem à distribuição
+        char *end = field;
+        int depth = 0;
+        while (*end && (depth > 0 || *end != ',')) {
+            if (*end == '(') depth++;
+            else if (*end == ')') depth--;
+            end++;
+        }
+        char *next = *end ? end + 1 : end;
+        *end = '\0';
+
+        char *eq = strchr(field, '=');
+        if (!eq) {
+            ok = 0;
+            break;
+        }
+        *eq = '\0';
+        const char *value = eq + 1;
+
+        if (!strcmp(field, "weight")) {
+            char *wend;
+            cls->weight = strtod(value, &wend);
+            ok = *wend == '\0' && cls->weight > 0;
+        } else if (!strcmp(field, "cpu")) {
+            ok = parse_dist(value, &cls->cpu) == 0;
+        } else if (!strcmp(field, "io")) {
+            ok = parse_dist(value, &cls->io) == 0;
+        } else if (!strcmp(field, "nice")) {
+            ok = parse_dist(value, &cls->nice) == 0;
+        } else if (!strcmp(field, "pages")) {
+            ok = parse_dist(value, &cls->pages) == 0;
+        } else {
+            ok = 0;
+        }
+        field = next;
+    }
+    free(copy);
+    return ok ? 0 : -1;
+}
+
+static const burst_class_t DEFAULT_CLASS = {
+    .weight = 1,
+    .cpu = {DIST_EXP, 200, 0, 0},
+    .io = {DIST_EXP, 1000, 0, 0},
+    .nice = {DIST_CONST, 0, 0, 0},
+    .pages = {DIST_CONST, 0, 0, 0},
+};
+
+enum {
+    OPT_SEED = 1000,
+    OPT_BURSTS,
+    OPT_CLASS,
+    OPT_PAGE_SPACE,
+    OPT_FORMAT,
+    OPT_OUTPUT,
+};
+
+static const struct option LONG_OPTIONS[] = {
+    {"seed",       required_argument, NULL, OPT_SEED},
+    {"bursts",     required_argument, NULL, OPT_BURSTS},
+    {"class",      required_argument, NULL, OPT_CLASS},
+    {"page-space", required_argument, NULL, OPT_PAGE_SPACE},
+    {"format",     required_argument, NULL, OPT_FORMAT},
+    {"output",     required_argument, NULL, OPT_OUTPUT},
+    {NULL, 0, NULL, 0}
+};
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] > bursts.csv\n"
+            "  --seed=N            random seed (default 1)\n"
+            "  --bursts=N          number of bursts to generate (default 1000)\n"
+            "  --class=SPEC        burst class, may be repeated (default cpu=exp(200),io=exp(1000)):\n"
+            "                      weight=W,cpu=DIST,io=DIST,nice=DIST,pages=DIST\n"
+            "                      DIST is const(v), uniform(a,b), exp(mean),\n"
+            "                      bimodal(short,long,p_short) or pareto(alpha,min[,max])\n"
+            "  --page-space=N      page ids are drawn from 0..N-1 (default 64)\n"
+            "  --format=csv|bin    output format (default csv; bin is read by app-io)\n"
+            "  --output=FILE       write to FILE instead of stdout\n",
+            prog);
+}
+
+static unsigned long long parse_ull_arg(const char *opt, const char *value, unsigned long long max) {
+    char *endptr;
+    errno = 0;
+    unsigned long long v = strtoull(value, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || v > max) {
+        fprintf(stderr, "Invalid value for --%s: %s\n", opt, value);
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+// ---------------------------------------------------------
+// Geração
+// ---------------------------------------------------------
+static const burst_class_t *pick_class(const burst_class_t *classes, int count, double total_weight) {
+    if (count == 1) return &classes[0];
+    double r = rng_unit() * total_weight;
+    for (int i = 0; i < count - 1; i++) {
+        if (r < classes[i].weight) return &classes[i];
+        r -= classes[i].weight;
+    }
+    return &classes[count - 1];
+}
+
+static void generate_burst(const burst_class_t *cls, uint32_t page_space, burst_t *burst) {
+    // Os bursts de CPU têm pelo menos 1 ms; um I/O de 0 ms não bloqueia
+    burst->burst_time_ms = (uint32_t)sample_clamped(&cls->cpu, 1, INT32_MAX);
+    burst->block_time_ms = (uint32_t)sample_clamped(&cls->io, 0, INT32_MAX);
+    burst->nice = (int)sample_clamped(&cls->nice, -20, 19);
+
+    // Páginas consecutivas a partir de uma base aleatória (localidade)
+    uint32_t count = page_space ? (uint32_t)sample_clamped(&cls->pages, 0, MAX_PAGES) : 0;
+    if (count > page_space) count = page_space;
+    burst->pages.count = count;
+    if (count > 0) {
+        uint32_t base = (uint32_t)(rng_next() % page_space);
+        for (uint32_t i = 0; i < count; i++) burst->pages.ids[i] = (base + i) % page_space;
+    }
+}
+
+static int write_csv_burst(FILE *out, const burst_t *burst) {
+    if (fprintf(out, "%u,%u,%d", burst->burst_time_ms, burst->block_time_ms, burst->nice) < 0) return -1;
+    if (burst->pages.count > 0) {
+        fputs(",[", out);
+        for (uint32_t i = 0; i < burst->pages.count; i++) {
+            fprintf(out, "%s%u", i ? "," : "", burst->pages.ids[i]);
+        }
+        fputc(']', out);
+    }
+    return fputc('\n', out) == EOF ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long long seed = 1;
+    unsigned long long bursts = 1000;
+    uint32_t page_space = 64;
+    int binary = 0;
+    const char *output = NULL;
+    burst_class_t classes[MAX_CLASSES];
+    int class_count = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", LONG_OPTIONS, NULL)) != -1) {
+        switch (opt) {
+            case OPT_SEED:
+                seed = parse_ull_arg("seed", optarg, UINT64_MAX);
+                break;
+            case OPT_BURSTS:
+                bursts = parse_ull_arg("bursts", optarg, UINT64_MAX);
+                break;
+            case OPT_CLASS:
+                if (class_count == MAX_CLASSES) {
+                    fprintf(stderr, "At most %d classes are supported\n", MAX_CLASSES);
+                    return EXIT_FAILURE;
+                }
+                classes[class_count] = DEFAULT_CLASS;
+                if (parse_class(optarg, &classes[class_count]) < 0) {
+                    fprintf(stderr, "Invalid class '%s'\n", optarg);
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                class_count++;
+                break;
+            case OPT_PAGE_SPACE:
+                page_space = (uint32_t)parse_ull_arg("page-space", optarg, UINT32_MAX);
+                break;
+            case OPT_FORMAT:
+                if (!strcmp(optarg, "csv")) {
+                    binary = 0;
+                } else if (!strcmp(optarg, "bin")) {
+                    binary = 1;
+                } else {
+                    fprintf(stderr, "Invalid format '%s'. Use csv or bin.\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPT_OUTPUT:
+                output = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (class_count == 0) classes[class_count++] = DEFAULT_CLASS;
+
+    double total_weight = 0;
+    for (int i = 0; i < class_count; i++) total_weight += classes[i].weight;
+
+    FILE *out = stdout;
+    if (output) {
+        out = fopen(output, binary ? "wb" : "w");
+        if (!out) {
+            perror("fopen");
+            return EXIT_FAILURE;
+        }
+    }
+    // Buffer grande: a saída é escrita em blocos, não burst a burst
+    static char out_buf[1 << 16];
+    setvbuf(out, out_buf, _IOFBF, sizeof(out_buf));
+
+    rng_seed(seed);
+    int err = binary ? write_burst_header(out)
+                     : (fprintf(out, "#BurstTime(ms),BlockTime(ms),nice,pages  wlgen seed=%llu\n", seed) < 0 ? -1 : 0);
+
+    burst_t burst;
+    for (unsigned long long i = 0; i < bursts && err == 0; i++) {
+        generate_burst(pick_class(classes, class_count, total_weight), page_space, &burst);
+        err = binary ? write_burst_record(out, &burst) : write_csv_burst(out, &burst);
+    }
+
+    if (fflush(out) != 0) err = -1;
+    if (err != 0) perror("write");
+    if (output && fclose(out) != 0) {
+        perror("fclose");
+        err = -1;
+    }
+    return err == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}